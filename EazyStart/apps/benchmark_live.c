@@ -0,0 +1,56 @@
+/**
+ * @file benchmark_live.c
+ * @brief 实时查看其他进程发布的benchmark统计数据
+ *
+ * 用法: ezs_benchmark_live <name> [interval_ms]
+ * name为被测进程调用ezs_benchmark_live_publish时给出的名称，如"/my-service"
+ * interval_ms为刷新间隔，默认1000毫秒，为0时只打印一次
+ * 发布者停止发布后打印最后一次快照并退出
+ */
+
+#include "EazyStart/time/benchmark_live.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+// 默认的刷新间隔（毫秒）
+static constexpr unsigned long DEFAULT_INTERVAL_MS = 1000;
+
+int main(const int argc, char *argv[]) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s <name> [interval_ms]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    char *end = nullptr;
+    const unsigned long interval_ms = 3 == argc ? strtoul(argv[2], &end, 10) : DEFAULT_INTERVAL_MS;
+    if (3 == argc && (end == argv[2] || '\0' != *end)) {
+        fprintf(stderr, "Invalid interval '%s'.\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    ezs_benchmark_live_reader *reader = ezs_benchmark_live_attach(argv[1]);
+    if (nullptr == reader) {
+        return EXIT_FAILURE;
+    }
+    for (;;) {
+        if (interval_ms > 0) {
+            // 清屏并回到左上角，使表格原地刷新
+            fputs("\033[H\033[2J", stdout);
+        }
+        ezs_benchmark_live_print(reader);
+        fflush(stdout);
+
+        ezs_benchmark_live_info info = {};
+        ezs_benchmark_live_read(reader, &info, nullptr, 0);
+        if (0 == interval_ms || info.stopped) {
+            break;
+        }
+        const struct timespec interval = {
+            .tv_sec = (time_t) (interval_ms / 1000),
+            .tv_nsec = (long) (interval_ms % 1000) * 1000000L
+        };
+        thrd_sleep(&interval, nullptr);
+    }
+    ezs_benchmark_live_detach(reader);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,332 @@
+/**
+ * @file memory_suite.c
+ * @brief 测量本机的缓存与内存特性，作为解读其他benchmark结果的参照
+ *
+ * 用法: ezs_memory_suite [max_working_set_mib] [cpu]
+ * max_working_set_mib为最大的工作集（MiB），默认256，应明显大于末级缓存
+ * cpu为绑定的核心编号，默认不绑定
+ *
+ * 包含三组测量：
+ * 1. 访问延迟：在随机的单环链表上追逐指针，每次读取都依赖上一次的结果，无法被预取或并行，
+ *    随工作集增大，延迟在超出L1/L2/L3时出现台阶
+ * 2. 带宽：顺序与随机地读写整个缓冲区，随机访问以缓存行为单位
+ * 3. TLB：每个页只访问一个缓存行，分别在4KiB页与透明大页上追逐指针，两者之差即TLB未命中的开销
+ *
+ * 结果写入benchmark报告（程序退出时打印），并导出到当前目录的memory_suite.json与memory_suite.csv
+ */
+
+#if defined(__linux__)
+#define _GNU_SOURCE // NOLINT(*-reserved-identifier)
+#endif
+
+#include "EazyStart/time.h"
+#include "EazyStart/tools/random.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// 缓存行大小
+static constexpr size_t LINE_SIZE = 64;
+// 普通页大小
+static constexpr size_t PAGE_SIZE = 4096;
+// 透明大页大小，大页的内存按此对齐
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+// 每轮指针追逐的读取次数
+static constexpr uint64_t CHASE_STEPS = 1 << 20;
+// 每种配置的最短测量时长（纳秒）与最少轮数
+static constexpr uint64_t MEASURE_TIME_NS = 200 * 1000 * 1000;
+static constexpr int MEASURE_MIN_ROUNDS = 5;
+// 延迟超过上一个工作集的该倍数时视为台阶
+static constexpr double KNEE_RATIO = 1.3;
+// 默认的最大工作集（MiB）
+static constexpr unsigned long DEFAULT_MAX_MIB = 256;
+
+/*---------------------------工具函数---------------------------*/
+
+// 获取当前时间的纳秒数
+static uint64_t now_ns(void) {
+    struct timespec ts = {};
+    if (!ezs_clock_get_performance_counter(&ts, nullptr, 0)) {
+        fprintf(stderr, "Failed to get high-resolution time.\n");
+        exit(EXIT_FAILURE);
+    }
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+// 将字节数格式化为"4KiB"、"64MiB"的形式
+static void format_size(const size_t bytes, char *buf, const size_t size) {
+    if (bytes >= 1024 * 1024 * 1024 && 0 == bytes % (1024 * 1024 * 1024)) {
+        snprintf(buf, size, "%zuGiB", bytes / (1024 * 1024 * 1024));
+    } else if (bytes >= 1024 * 1024 && 0 == bytes % (1024 * 1024)) {
+        snprintf(buf, size, "%zuMiB", bytes / (1024 * 1024));
+    } else {
+        snprintf(buf, size, "%zuKiB", bytes / 1024);
+    }
+}
+
+// 分配size字节、按大页对齐的内存，huge为true时请求透明大页，否则禁止使用大页
+// 内存在返回前全部写入一次，使之后的测量不包含缺页的开销
+static unsigned char *allocate_buffer(const size_t size, const bool huge) {
+    const size_t rounded = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    unsigned char *buffer = aligned_alloc(HUGE_PAGE_SIZE, rounded);
+    if (nullptr == buffer) {
+        fprintf(stderr, "Failed to allocate %zu bytes.\n", rounded);
+        exit(EXIT_FAILURE);
+    }
+#if defined(__linux__)
+    madvise(buffer, rounded, huge ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+#else
+    (void) huge;
+#endif
+    memset(buffer, 0, rounded);
+    return buffer;
+}
+
+// 重复运行round直到累计时长与轮数都达到下限，每轮记录items个元素与bytes个字节的工作量
+// 返回每轮耗时的中位数（纳秒）
+static double measure(const char *name, void (*round)(void *), void *context,
+                      const uint64_t items, const uint64_t bytes) {
+    const ezs_benchmark_id id = ezs_benchmark_register(name);
+    // 预热一轮，使缓存与TLB进入稳定状态
+    round(context);
+    const uint64_t begin = now_ns();
+    for (int rounds = 0; rounds < MEASURE_MIN_ROUNDS || now_ns() - begin < MEASURE_TIME_NS; rounds += 1) {
+        ezs_benchmark_start_id(id);
+        round(context);
+        ezs_benchmark_end_id_with_work(id, items, bytes);
+    }
+    struct timespec median = {};
+    if (!ezs_benchmark_percentile_id(id, 50.0, &median)) {
+        return 0.0;
+    }
+    return (double) median.tv_sec * 1e9 + (double) median.tv_nsec;
+}
+
+/*---------------------------指针追逐---------------------------*/
+
+typedef struct {
+    void *start;
+} ChaseContext;
+
+// 在buffer中的count个节点上建立随机的单环链表，第i个节点位于offset(i)处
+// 使用Sattolo算法生成只有一个环的排列，保证从任一节点出发都会遍历所有节点
+static void build_chain(unsigned char *buffer, const size_t count, size_t (*offset)(size_t)) {
+    size_t *next = malloc(count * sizeof(*next));
+    if (nullptr == next) {
+        fprintf(stderr, "Failed to allocate the pointer chain.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < count; i += 1) {
+        next[i] = i;
+    }
+    for (size_t i = count - 1; i > 0; i -= 1) {
+        const size_t j = (size_t) ezs_random_unsigned_long_long(0, i);
+        const size_t temp = next[i];
+        next[i] = next[j];
+        next[j] = temp;
+    }
+    for (size_t i = 0; i < count; i += 1) {
+        *(void **) (buffer + offset(i)) = buffer + offset(next[i]);
+    }
+    free(next);
+}
+
+// 缓存行粒度的节点：连续排列
+static size_t line_offset(const size_t i) {
+    return i * LINE_SIZE;
+}
+
+// 页粒度的节点：每页一个，页内的位置错开，避免所有节点落在同一个缓存组中
+static size_t page_offset(const size_t i) {
+    return i * PAGE_SIZE + i % (PAGE_SIZE / LINE_SIZE) * LINE_SIZE;
+}
+
+static void chase(void *context) {
+    void *p = ((ChaseContext *) context)->start;
+    for (uint64_t i = 0; i < CHASE_STEPS; i += 1) {
+        p = *(void **) p;
+    }
+    ezs_do_not_optimize(p);
+}
+
+// 在size字节的工作集上测量一次读取的延迟（纳秒）
+static double measure_chase(const char *name, const size_t size, const size_t stride,
+                            size_t (*offset)(size_t), const bool huge) {
+    unsigned char *buffer = allocate_buffer(size, huge);
+    build_chain(buffer, size / stride, offset);
+    ChaseContext context = {.start = buffer};
+    const double latency = measure(name, chase, &context, CHASE_STEPS, 0) / (double) CHASE_STEPS;
+    free(buffer);
+    return latency;
+}
+
+static void run_latency(const size_t max_size) {
+    puts("\n--- Load latency versus working set ---");
+    double previous = 0.0;
+    for (size_t size = 4 * 1024; size <= max_size; size *= 2) {
+        char size_buf[32], name[64];
+        format_size(size, size_buf, sizeof(size_buf));
+        snprintf(name, sizeof(name), "latency/%s", size_buf);
+        const double latency = measure_chase(name, size, LINE_SIZE, line_offset, false);
+        const bool knee = previous > 0.0 && latency > previous * KNEE_RATIO;
+        printf("%10s %10.2f ns/load%s\n", size_buf, latency, knee ? "  <- knee" : "");
+        previous = latency;
+    }
+}
+
+/*---------------------------带宽---------------------------*/
+
+typedef struct {
+    uint64_t *words;
+    size_t word_count;
+    size_t line_mask; // 缓存行数减一，缓存行数为2的幂
+    uint64_t increment; // 随机访问序列的增量，每次运行随机选取
+} BandwidthContext;
+
+static void sequential_read(void *context) {
+    const BandwidthContext *c = context;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < c->word_count; i += 1) {
+        sum += c->words[i];
+    }
+    ezs_do_not_optimize(sum);
+}
+
+static void sequential_write(void *context) {
+    const BandwidthContext *c = context;
+    for (size_t i = 0; i < c->word_count; i += 1) {
+        c->words[i] = i;
+    }
+    ezs_clobber_memory();
+}
+
+// 随机访问的缓存行序列：模2^k的线性同余序列，乘数模4余1且增量为奇数时周期为2^k，即每个缓存行恰好访问一次
+// 这样既不需要额外的下标数组占用带宽，也能让硬件预取器失效
+static size_t next_line(const BandwidthContext *c, const size_t line) {
+    return (size_t) (line * 6364136223846793005ULL + c->increment) & c->line_mask;
+}
+
+static void random_read(void *context) {
+    const BandwidthContext *c = context;
+    constexpr size_t words_per_line = LINE_SIZE / sizeof(uint64_t);
+    uint64_t sum = 0;
+    size_t line = 0;
+    for (size_t i = 0; i <= c->line_mask; i += 1) {
+        const uint64_t *words = c->words + line * words_per_line;
+        for (size_t j = 0; j < words_per_line; j += 1) {
+            sum += words[j];
+        }
+        line = next_line(c, line);
+    }
+    ezs_do_not_optimize(sum);
+}
+
+static void random_write(void *context) {
+    const BandwidthContext *c = context;
+    constexpr size_t words_per_line = LINE_SIZE / sizeof(uint64_t);
+    size_t line = 0;
+    for (size_t i = 0; i <= c->line_mask; i += 1) {
+        uint64_t *words = c->words + line * words_per_line;
+        for (size_t j = 0; j < words_per_line; j += 1) {
+            words[j] = i;
+        }
+        line = next_line(c, line);
+    }
+    ezs_clobber_memory();
+}
+
+static void run_bandwidth(const size_t max_size) {
+    // 随机访问要求缓存行数为2的幂
+    size_t size = LINE_SIZE;
+    while (size * 2 <= max_size) {
+        size *= 2;
+    }
+    char size_buf[32];
+    format_size(size, size_buf, sizeof(size_buf));
+    printf("\n--- Bandwidth over a %s buffer ---\n", size_buf);
+    unsigned char *buffer = allocate_buffer(size, false);
+    BandwidthContext context = {
+        .words = (uint64_t *) buffer,
+        .word_count = size / sizeof(uint64_t),
+        .line_mask = size / LINE_SIZE - 1,
+        .increment = ezs_random_unsigned_long_long(0, UINT64_MAX / 2) * 2 + 1,
+    };
+    const struct {
+        const char *name;
+        void (*round)(void *);
+    } tests[] = {
+        {"bandwidth/seq read", sequential_read},
+        {"bandwidth/seq write", sequential_write},
+        {"bandwidth/rand read", random_read},
+        {"bandwidth/rand write", random_write},
+    };
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i += 1) {
+        const double round_ns = measure(tests[i].name, tests[i].round, &context, size / LINE_SIZE, size);
+        printf("%20s %10.2f GB/s\n", tests[i].name, round_ns > 0.0 ? (double) size / round_ns : 0.0);
+    }
+    free(buffer);
+}
+
+/*---------------------------TLB---------------------------*/
+
+// 检查透明大页是否可用，不可用时大页的结果与4KiB页相同
+static bool huge_pages_available(void) {
+#if defined(__linux__)
+    FILE *file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+    if (nullptr == file) {
+        return false;
+    }
+    char line[128] = "";
+    const bool has_line = nullptr != fgets(line, sizeof(line), file);
+    fclose(file);
+    return has_line && nullptr == strstr(line, "[never]");
+#else
+    return false;
+#endif
+}
+
+static void run_tlb(const size_t max_size) {
+    puts("\n--- TLB: one line per page, 4KiB pages versus huge pages ---");
+    if (!huge_pages_available()) {
+        puts("[EZS] Transparent huge pages are unavailable, both columns measure 4KiB pages");
+    }
+    printf("%10s %14s %14s\n", "Span", "4KiB pages", "huge pages");
+    for (size_t size = 4 * 1024 * 1024; size <= max_size; size *= 4) {
+        char size_buf[32], name[64];
+        format_size(size, size_buf, sizeof(size_buf));
+        snprintf(name, sizeof(name), "tlb/4KiB/%s", size_buf);
+        const double small = measure_chase(name, size, PAGE_SIZE, page_offset, false);
+        snprintf(name, sizeof(name), "tlb/huge/%s", size_buf);
+        const double huge = measure_chase(name, size, PAGE_SIZE, page_offset, true);
+        printf("%10s %11.2f ns %11.2f ns\n", size_buf, small, huge);
+    }
+}
+
+int main(const int argc, char *argv[]) {
+    if (argc > 3) {
+        fprintf(stderr, "Usage: %s [max_working_set_mib] [cpu]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const unsigned long max_mib = argc >= 2 ? strtoul(argv[1], nullptr, 10) : DEFAULT_MAX_MIB;
+    if (0 == max_mib) {
+        fprintf(stderr, "Invalid working set '%s'.\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    const size_t max_size = (size_t) max_mib * 1024 * 1024;
+    ezs_benchmark_setup_environment(argc >= 3 ? atoi(argv[2]) : -1);
+
+    run_latency(max_size);
+    run_bandwidth(max_size);
+    run_tlb(max_size);
+
+    if (!ezs_benchmark_export_json("memory_suite.json") || !ezs_benchmark_export_csv("memory_suite.csv")) {
+        fprintf(stderr, "Failed to export the results.\n");
+    }
+    puts("\nThe full report is printed below and exported to memory_suite.json and memory_suite.csv.");
+    return EXIT_SUCCESS;
+}
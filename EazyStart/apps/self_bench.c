@@ -0,0 +1,421 @@
+/**
+ * @file self_bench.c
+ * @brief EazyStart自身热点函数的基准测试，用于跟踪库在不同版本之间的性能变化
+ *
+ * 用法: EazyStartBench [output.json] [baseline.json] [threshold]
+ * output.json为结果的导出路径，默认EazyStartBench.json
+ * 给出baseline.json时与之对比，任一条目比基线慢了超过threshold（默认0.05，即5%）时以失败退出
+ *
+ * 测量的对象：
+ * 1. ezs_random_*：不同宽度的整数区间、浮点数、闭区间版本与布尔值
+ * 2. ezs_clock_timespec_*的算术与格式化
+ * 3. ezs_benchmark_start/end自身的开销
+ * 4. EZS_PRINT（输出重定向到空设备）与ezs_input_*的解析（输入重定向到临时文件）
+ *
+ * 每个条目的一次计时包含BENCH_BATCH次调用，并记录为BENCH_BATCH个元素的工作量，
+ * 因此报告的吞吐量表格给出每秒调用次数，导出文件中的耗时为一批调用的耗时
+ * 批量固定不变，不同构建导出的文件可以直接对比
+ */
+
+#if defined(__linux__)
+#define _GNU_SOURCE // NOLINT(*-reserved-identifier)
+#endif
+
+#include "EazyStart/io.h"
+#include "EazyStart/time.h"
+#include "EazyStart/tools/random.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <io.h>
+#define NULL_DEVICE "NUL"
+#define DUP _dup
+#define DUP2 _dup2
+#define CLOSE _close
+#define FILENO _fileno
+#else
+#include <unistd.h>
+#define NULL_DEVICE "/dev/null"
+#define DUP dup
+#define DUP2 dup2
+#define CLOSE close
+#define FILENO fileno
+#endif
+
+// 一次计时包含的调用次数
+static constexpr uint64_t BENCH_BATCH = 1000;
+// 每个条目的最短测量时长（纳秒）与最少计时次数
+static constexpr uint64_t BENCH_TIME_NS = 200 * 1000 * 1000;
+static constexpr int BENCH_MIN_ROUNDS = 10;
+// 输入文件的行数，读完后回到文件开头
+static constexpr uint64_t INPUT_LINES = 16 * BENCH_BATCH;
+// 输入测试使用的临时文件
+static const char *const INPUT_PATH = "EazyStartBench.input";
+// 默认的退化阈值
+static constexpr double DEFAULT_THRESHOLD = 0.05;
+
+/*---------------------------工具函数---------------------------*/
+
+// 获取当前时间的纳秒数
+static uint64_t now_ns(void) {
+    struct timespec ts = {};
+    if (!ezs_clock_get_performance_counter(&ts, nullptr, 0)) {
+        fprintf(stderr, "Failed to get high-resolution time.\n");
+        exit(EXIT_FAILURE);
+    }
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+// 以name为名称测量function，每次计时调用BENCH_BATCH次
+static void bench(const char *name, const ezs_benchmark_function function, void *context) {
+    const ezs_benchmark_id id = ezs_benchmark_register(name);
+    // 预热一批
+    for (uint64_t i = 0; i < BENCH_BATCH; i += 1) {
+        function(context);
+    }
+    const uint64_t begin = now_ns();
+    for (int rounds = 0; rounds < BENCH_MIN_ROUNDS || now_ns() - begin < BENCH_TIME_NS; rounds += 1) {
+        ezs_benchmark_start_id(id);
+        for (uint64_t i = 0; i < BENCH_BATCH; i += 1) {
+            function(context);
+        }
+        ezs_benchmark_end_id_with_work(id, BENCH_BATCH, 0);
+    }
+}
+
+/*---------------------------EZS_RANDOM---------------------------*/
+
+static void random_int_small(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_random_int(0, 6));
+}
+
+static void random_int_full(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_random_int(INT_MIN, INT_MAX));
+}
+
+static void random_uchar(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_random_unsigned_char(0, 200));
+}
+
+static void random_u64_small(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_random_unsigned_long_long(0, 1000));
+}
+
+static void random_u64_full(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_random_unsigned_long_long(0, ULLONG_MAX));
+}
+
+// 区间宽度略大于2^63，拒绝采样的拒绝率接近一半，是整数生成的最坏情况
+static void random_u64_worst(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_random_unsigned_long_long(0, (1ULL << 63) + 1));
+}
+
+static void random_float(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_random_float(0.0f, 1.0f));
+}
+
+static void random_double(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_random_double(0.0, 1.0));
+}
+
+static void random_long_double(void *context) {
+    (void) context;
+    const long double value = ezs_random_long_double(0.0L, 1.0L);
+    ezs_do_not_optimize(value);
+}
+
+static void random_int_inclusive(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_random_int_inclusive(1, 6));
+}
+
+static void random_double_inclusive(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_random_double_inclusive(0.0, 1.0));
+}
+
+static void random_bool(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_random_bool());
+}
+
+static void bench_random(void) {
+    bench("random/int [0,6)", random_int_small, nullptr);
+    bench("random/int full", random_int_full, nullptr);
+    bench("random/uchar", random_uchar, nullptr);
+    bench("random/u64 [0,1000)", random_u64_small, nullptr);
+    bench("random/u64 full", random_u64_full, nullptr);
+    bench("random/u64 worst", random_u64_worst, nullptr);
+    bench("random/float", random_float, nullptr);
+    bench("random/double", random_double, nullptr);
+    bench("random/long double", random_long_double, nullptr);
+    bench("random/int incl", random_int_inclusive, nullptr);
+    bench("random/double incl", random_double_inclusive, nullptr);
+    bench("random/bool", random_bool, nullptr);
+}
+
+/*---------------------------EZS_CLOCK---------------------------*/
+
+typedef struct {
+    struct timespec a;
+    struct timespec b;
+} ClockContext;
+
+static void clock_add(void *context) {
+    const ClockContext *c = context;
+    const struct timespec result = ezs_clock_timespec_add(c->a, c->b);
+    ezs_do_not_optimize(result);
+}
+
+static void clock_sub(void *context) {
+    const ClockContext *c = context;
+    const struct timespec result = ezs_clock_timespec_sub(c->a, c->b);
+    ezs_do_not_optimize(result);
+}
+
+static void clock_add_eq(void *context) {
+    ClockContext *c = context;
+    struct timespec result = c->a;
+    ezs_clock_timespec_add_eq(&result, c->b);
+    ezs_do_not_optimize(result);
+}
+
+static void clock_sub_eq(void *context) {
+    ClockContext *c = context;
+    struct timespec result = c->a;
+    ezs_clock_timespec_sub_eq(&result, c->b);
+    ezs_do_not_optimize(result);
+}
+
+static void clock_div(void *context) {
+    const ClockContext *c = context;
+    const struct timespec result = ezs_clock_timespec_div(c->a, 7);
+    ezs_do_not_optimize(result);
+}
+
+static void clock_compare(void *context) {
+    const ClockContext *c = context;
+    ezs_do_not_optimize(ezs_clock_timespec_compare(c->a, c->b));
+}
+
+static void clock_to_seconds(void *context) {
+    const ClockContext *c = context;
+    const long double seconds = ezs_clock_timespec_to_seconds(c->a);
+    ezs_do_not_optimize(seconds);
+}
+
+static void clock_decompose(void *context) {
+    const ClockContext *c = context;
+    uint64_t days = 0, hours = 0, minutes = 0, seconds = 0, milliseconds = 0, microseconds = 0, nanoseconds = 0;
+    ezs_clock_timespec_decompose(c->a, &days, &hours, &minutes, &seconds, &milliseconds, &microseconds, &nanoseconds);
+    ezs_do_not_optimize(days + hours + minutes + seconds + milliseconds + microseconds + nanoseconds);
+}
+
+static void clock_to_string(void *context) {
+    const ClockContext *c = context;
+    char buf[64];
+    ezs_do_not_optimize(ezs_clock_timespec_to_string(c->a, buf, sizeof(buf)));
+    ezs_clobber_memory();
+}
+
+static void bench_clock(void) {
+    // 各个单位都不为零，格式化时需要输出所有单位
+    ClockContext context = {
+        .a = {.tv_sec = 93784, .tv_nsec = 123456789},
+        .b = {.tv_sec = 3661, .tv_nsec = 987654321},
+    };
+    bench("clock/add", clock_add, &context);
+    bench("clock/sub", clock_sub, &context);
+    bench("clock/add_eq", clock_add_eq, &context);
+    bench("clock/sub_eq", clock_sub_eq, &context);
+    bench("clock/div", clock_div, &context);
+    bench("clock/compare", clock_compare, &context);
+    bench("clock/to_seconds", clock_to_seconds, &context);
+    bench("clock/decompose", clock_decompose, &context);
+    bench("clock/to_string", clock_to_string, &context);
+}
+
+/*---------------------------EZS_BENCHMARK---------------------------*/
+
+static void benchmark_by_id(void *context) {
+    const ezs_benchmark_id id = *(const ezs_benchmark_id *) context;
+    ezs_benchmark_start_id(id);
+    ezs_benchmark_end_id(id);
+}
+
+static void benchmark_by_name(void *context) {
+    (void) context;
+    ezs_benchmark_start("bench/inner name");
+    ezs_benchmark_end("bench/inner name");
+}
+
+static void bench_benchmark(void) {
+    ezs_benchmark_id id = ezs_benchmark_register("bench/inner id");
+    bench("bench/start+end id", benchmark_by_id, &id);
+    bench("bench/start+end name", benchmark_by_name, nullptr);
+}
+
+/*---------------------------EZS_PRINT与EZS_INPUT---------------------------*/
+
+// 将stdout重定向到空设备，返回原来的stdout的描述符，失败时返回-1
+static int silence_stdout(void) {
+    fflush(stdout);
+    const int saved = DUP(FILENO(stdout));
+    if (saved < 0 || nullptr == freopen(NULL_DEVICE, "w", stdout)) {
+        fprintf(stderr, "Failed to redirect stdout.\n");
+        exit(EXIT_FAILURE);
+    }
+    return saved;
+}
+
+// 恢复silence_stdout之前的stdout
+static void restore_stdout(const int saved) {
+    fflush(stdout);
+    DUP2(saved, FILENO(stdout));
+    CLOSE(saved);
+    clearerr(stdout);
+}
+
+typedef struct {
+    int integer;
+    double floating;
+    const char *string;
+} PrintContext;
+
+static void print_int(void *context) {
+    const PrintContext *c = context;
+    int value = c->integer;
+    EZS_PRINT(value);
+}
+
+static void print_double(void *context) {
+    const PrintContext *c = context;
+    double value = c->floating;
+    EZS_PRINT(value);
+}
+
+static void print_string(void *context) {
+    const PrintContext *c = context;
+    const char *value = c->string;
+    EZS_PRINT(value);
+}
+
+// 已从输入文件中读取的行数，读完时回到文件开头
+static uint64_t g_input_lines_read = 0;
+
+static void next_input_line(void) {
+    g_input_lines_read += 1;
+    if (INPUT_LINES == g_input_lines_read) {
+        rewind(stdin);
+        g_input_lines_read = 0;
+    }
+}
+
+static void input_int(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_input_int_with_prompt(""));
+    next_input_line();
+}
+
+static void input_double(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_input_double_with_prompt(""));
+    next_input_line();
+}
+
+static void input_bool(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_input_bool_with_prompt(""));
+    next_input_line();
+}
+
+static void input_char(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_input_char_with_prompt(""));
+    next_input_line();
+}
+
+// 写入INPUT_LINES行line，并将stdin重定向到该文件
+static void redirect_stdin(const char *line) {
+    FILE *file = fopen(INPUT_PATH, "w");
+    if (nullptr == file) {
+        fprintf(stderr, "Failed to create the input file '%s'.\n", INPUT_PATH);
+        exit(EXIT_FAILURE);
+    }
+    for (uint64_t i = 0; i < INPUT_LINES; i += 1) {
+        fputs(line, file);
+    }
+    fclose(file);
+    if (nullptr == freopen(INPUT_PATH, "r", stdin)) {
+        fprintf(stderr, "Failed to redirect stdin to '%s'.\n", INPUT_PATH);
+        exit(EXIT_FAILURE);
+    }
+    g_input_lines_read = 0;
+}
+
+static void bench_io(void) {
+    const int saved = silence_stdout();
+    PrintContext context = {.integer = 202401, .floating = 98.5, .string = "EazyStart"};
+    bench("print/int", print_int, &context);
+    bench("print/double", print_double, &context);
+    bench("print/string", print_string, &context);
+
+    const struct {
+        const char *name;
+        const char *line;
+        ezs_benchmark_function function;
+    } inputs[] = {
+        {"input/int", "  -1234567\n", input_int},
+        {"input/double", "3.14159265358979\n", input_double},
+        {"input/bool", "Y\n", input_bool},
+        {"input/char", "x\n", input_char},
+    };
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i += 1) {
+        redirect_stdin(inputs[i].line);
+        bench(inputs[i].name, inputs[i].function, nullptr);
+    }
+    restore_stdout(saved);
+    remove(INPUT_PATH);
+}
+
+int main(const int argc, char *argv[]) {
+    if (argc > 4) {
+        fprintf(stderr, "Usage: %s [output.json] [baseline.json] [threshold]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *output = argc >= 2 ? argv[1] : "EazyStartBench.json";
+    const double threshold = argc >= 4 ? strtod(argv[3], nullptr) : DEFAULT_THRESHOLD;
+    // 固定种子，使各次运行的随机数序列相同
+    ezs_random_init_with_seed(0x455A53);
+
+    bench_random();
+    bench_clock();
+    bench_benchmark();
+    bench_io();
+
+    if (!ezs_benchmark_export_json(output)) {
+        fprintf(stderr, "Failed to export the results to '%s'.\n", output);
+        return EXIT_FAILURE;
+    }
+    printf("[EZS] Results exported to %s\n", output);
+    return argc >= 3 ? ezs_benchmark_compare_baseline(argv[2], threshold) : EXIT_SUCCESS;
+}
+
+/*---------------------------清理局部宏---------------------------*/
+
+#undef NULL_DEVICE
+#undef DUP
+#undef DUP2
+#undef CLOSE
+#undef FILENO
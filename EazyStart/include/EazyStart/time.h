@@ -1,4 +1,13 @@
 #pragma once
 
 #include "time/clock.h"
-#include "time/benchmark.h"
\ No newline at end of file
+#include "time/benchmark.h"
+#include "time/benchmark_run.h"
+#include "time/benchmark_scaling.h"
+#include "time/benchmark_load.h"
+#include "time/benchmark_export.h"
+#include "time/benchmark_compare.h"
+#include "time/benchmark_profile.h"
+#include "time/benchmark_instrument.h"
+#include "time/benchmark_environment.h"
+#include "time/benchmark_live.h"
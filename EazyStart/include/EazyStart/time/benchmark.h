@@ -1,11 +1,59 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
 /*
  * 在默认情况下，EazyStart的benchmark功能会在程序退出时自动打印报告，并释放资源
  * 当你不希望该功能时，可以在编译时定义宏EZS_BENCHMARK_NO_AUTO_EXIT
  * 此时你需要手动调用ezs_benchmark_final_report函数来打印报告并释放资源
 */
 
+/*
+ * 多线程：
+ * 各线程可以同时计时，计时数据记录在每个线程私有的分片中，start/end不需要加锁
+ * 打印报告时会合并所有线程的数据，线程退出后其数据仍会保留到报告中
+ *
+ * 同一条目的一次start与end必须在同一线程中调用
+ * 打印、查询与导出可以在其他线程计时的同时调用，得到的是各条目某一时刻的一致快照，
+ * 只有分位数与调用树可能相差正在进行中的几次计时
+ * 清除与释放操作应当在其他线程停止计时后调用
+ */
+
+/*---------------------------EZS_BENCHMARK 句柄---------------------------*/
+
+/*
+ * 以名称调用的ezs_benchmark_start/end每次都需要在名称表中查找条目
+ * 在高频调用的热点代码中，这部分开销不可忽视
+ *
+ * 此时可以先用ezs_benchmark_register获取条目的句柄，再使用ezs_benchmark_start_id/end_id计时
+ * 句柄在条目注册后保持不变，直到调用ezs_benchmark_drop
+ * 对同一名称重复注册会得到同一个句柄
+ *
+ * 也可以直接使用EZS_BENCHMARK_SCOPE宏，它会把句柄缓存在函数内的静态变量中，
+ * 并在离开当前作用域时自动结束计时
+ */
+
+// benchmark条目的句柄
+typedef uint32_t ezs_benchmark_id;
+
+// 无效的benchmark句柄
+#define EZS_BENCHMARK_INVALID_ID ((ezs_benchmark_id) UINT32_MAX)
+
+// 注册名为name的benchmark条目，返回其句柄
+// 名称已注册时返回已有的句柄
+// 注册失败时返回EZS_BENCHMARK_INVALID_ID
+[[nodiscard]] ezs_benchmark_id ezs_benchmark_register(const char *name);
+
+// 句柄为id的benchmark开始计时
+void ezs_benchmark_start_id(ezs_benchmark_id id);
+
+// 句柄为id的benchmark结束计时
+void ezs_benchmark_end_id(ezs_benchmark_id id);
+
+/*---------------------------EZS_BENCHMARK 基础接口---------------------------*/
+
 // 条目为name的benchmark开始计时
 void ezs_benchmark_start(const char *name);
 
@@ -18,10 +66,12 @@ void ezs_benchmark_print_all(void);
 // 打印指定名称列表的benchmark条目的统计数据
 void ezs_benchmark_print(char *names[]);
 
-// 清除所有已注册的benchmark条目
+// 清除所有benchmark条目的统计数据
+// 已注册的条目及其句柄仍然有效
 void ezs_benchmark_clear(void);
 
 // 释放所有已注册的benchmark条目占用的内存
+// 此后所有已获得的句柄均失效，EZS_BENCHMARK_SCOPE会在下次执行时重新注册
 // 除非你确定不会再使用benchmark功能，否则不应调用此函数
 void ezs_benchmark_drop(void);
 
@@ -31,3 +81,267 @@ void ezs_benchmark_drop(void);
 // 因此通常不需要手动调用
 // 如果你不希望该函数被自动注册为atexit处理程序，可以在编译时定义宏EZS_BENCHMARK_NO_AUTO_EXIT
 void ezs_benchmark_final_report(void);
+
+/*---------------------------EZS_BENCHMARK 吞吐量---------------------------*/
+
+/*
+ * 很多热点代码关心的是单位时间内处理了多少数据，而不是单次调用的耗时
+ * 以ezs_benchmark_end_with_work结束计时时，可以同时给出本次处理的元素数与字节数
+ * 存在这样的条目时，报告中会增加吞吐量表，以处理的总量除以总耗时给出每秒的元素数与字节数
+ *
+ * 吞吐量只统计以*_with_work结束的计时，同一条目中以普通的end结束的计时不计入
+ * 不关心的一项可以传入0
+ *
+ * 例如：
+ * ezs_benchmark_start("memcpy");
+ * memcpy(dst, src, size);
+ * ezs_benchmark_end_with_work("memcpy", 1, size);
+ */
+
+// 条目为name的benchmark结束计时，并记录本次处理了items个元素、bytes个字节
+void ezs_benchmark_end_with_work(const char *name, uint64_t items, uint64_t bytes);
+
+// 句柄为id的benchmark结束计时，并记录本次处理了items个元素、bytes个字节
+void ezs_benchmark_end_id_with_work(ezs_benchmark_id id, uint64_t items, uint64_t bytes);
+
+/*---------------------------EZS_BENCHMARK 计时开销---------------------------*/
+
+/*
+ * 每次计时的结果都包含计时本身的开销：读取时钟的耗时，以及start/end函数的返回与调用
+ * 对于很短的代码段，这部分开销可能占到测量值的很大比例
+ *
+ * ezs_benchmark_calibrate会反复测量一对空的start_id/end_id，得到开销的分布
+ * 报告中的Net Mean为平均值减去开销的中位数，Net Min为最小值减去开销的最小值
+ * Mean与Min等其余各列仍为未经修正的原始值
+ *
+ * 默认在首次注册条目时自动校准一次（约需1ms）
+ * 当你不希望该功能时，可以在编译时定义宏EZS_BENCHMARK_NO_AUTO_CALIBRATE
+ * 也可以在任意时刻手动调用ezs_benchmark_calibrate重新校准，例如在CPU频率稳定之后
+ */
+
+// 测量当前线程中一对空的start/end的开销，结果用于之后打印的报告
+void ezs_benchmark_calibrate(void);
+
+// 获取最近一次校准得到的计时开销的中位数与最小值
+// 置空的指针表示不关心该值
+// 尚未校准时返回false
+bool ezs_benchmark_timer_overhead(struct timespec *median, struct timespec *min);
+
+/*---------------------------EZS_BENCHMARK 分位数---------------------------*/
+
+/*
+ * 每个条目都维护一个对数-线性分桶的耗时直方图，内存固定，记录为O(1)
+ * 报告中单独的分位数表会给出P50/P95/P99/P99.9，也可以用下面的函数查询任意分位数
+ *
+ * 分位数的精度由直方图的有效数字位数决定，默认为2位（相对误差约1%）
+ * 有效数字位数只能在编译期通过CMake缓存变量EZS_BENCHMARK_HISTOGRAM_SIGNIFICANT_DIGITS设置为1~3位，
+ * 它决定了每个条目的桶布局，因此查询时无法指定精度，所有查询与报告共用同一精度
+ * 可记录的耗时上限约为18分钟，更长的耗时会被计入最高的桶
+ */
+
+// 查询名为name的条目的耗时分位数，结果存入value
+// percentile取值范围[0, 100]，例如99.9表示P99.9
+// 结果的精度为编译期设定的直方图有效数字位数，且不会超出条目的[Min, Max]
+// 条目不存在或尚无数据时返回false
+bool ezs_benchmark_percentile(const char *name, double percentile, struct timespec *value) __attribute__((nonnull(3)));
+
+// 查询句柄为id的条目的耗时分位数，结果存入value
+// percentile取值范围[0, 100]，例如99.9表示P99.9
+// 条目不存在或尚无数据时返回false
+bool ezs_benchmark_percentile_id(ezs_benchmark_id id, double percentile, struct timespec *value) __attribute__((nonnull(3)));
+
+/*---------------------------EZS_BENCHMARK 稳健统计---------------------------*/
+
+/*
+ * 一次抢占或缺页就足以让平均值与标准差严重偏离，而中位数与四分位数几乎不受影响
+ * 稳健统计量同样由耗时直方图计算，因此无论运行多久内存占用都是固定的，精度与分位数相同
+ *
+ * 离群值按Tukey栅栏划分，IQR = Q3 - Q1：
+ * 低于Q1 - 3 * IQR为严重偏低，位于[Q1 - 3 * IQR, Q1 - 1.5 * IQR)为轻度偏低
+ * 高于Q3 + 3 * IQR为严重偏高，位于(Q3 + 1.5 * IQR, Q3 + 3 * IQR]为轻度偏高
+ *
+ * 报告中会给出Robust Statistics Table
+ * 调用ezs_benchmark_exclude_outliers(true)后，结果表格与导出文件中的平均值、标准差与相对标准差
+ * 只基于栅栏以内的样本计算
+ */
+
+// 条目的稳健统计量，耗时单位均为纳秒
+typedef struct {
+    uint64_t samples; // 参与统计的样本数
+    double median_ns;
+    double mad_ns; // 中位数绝对偏差，未乘以正态一致性系数1.4826
+    double q1_ns; // 第一四分位数
+    double q3_ns; // 第三四分位数
+    double iqr_ns; // 四分位距
+    uint64_t low_severe;
+    uint64_t low_mild;
+    uint64_t high_mild;
+    uint64_t high_severe;
+    double inlier_mean_ns; // 去除所有离群值后的平均值
+    double inlier_std_dev_ns; // 去除所有离群值后的样本标准差
+} ezs_benchmark_robust_stats;
+
+// 查询名为name的条目的稳健统计量，结果存入stats
+// 条目不存在或尚无数据时返回false
+bool ezs_benchmark_robust_statistics(const char *name, ezs_benchmark_robust_stats *stats) __attribute__((nonnull(2)));
+
+// 查询句柄为id的条目的稳健统计量，结果存入stats
+// 条目不存在或尚无数据时返回false
+bool ezs_benchmark_robust_statistics_id(ezs_benchmark_id id, ezs_benchmark_robust_stats *stats) __attribute__((nonnull(2)));
+
+// 设置报告中的平均值、标准差与相对标准差是否去除离群值，默认不去除
+void ezs_benchmark_exclude_outliers(bool exclude);
+
+/*---------------------------EZS_BENCHMARK 硬件计数器---------------------------*/
+
+/*
+ * 仅有耗时无法解释代码为什么变慢，此时可以启用硬件性能计数器（仅Linux，基于perf_event_open）
+ * 启用后，每次start/end都会额外读取一组计数器，报告中会增加硬件计数器表，
+ * 给出每次调用的周期数、指令数、IPC、缓存未命中率与每千条指令的分支预测失败次数（MPKI）
+ *
+ * 每次读取计数器需要一次系统调用（约1us），因此默认关闭，只适合用于耗时远大于此的区域
+ * 计数器只统计用户态，且各线程在首次计时时各自打开一组
+ *
+ * 在计数器不可用时（例如perf_event_paranoid过高、虚拟机未暴露PMU或非Linux平台），
+ * 会打印一条警告，并继续只记录耗时
+ */
+
+// 硬件计数器的种类，可以按位组合
+typedef enum {
+    EZS_BENCHMARK_PERF_CYCLES = 1u << 0, // CPU周期
+    EZS_BENCHMARK_PERF_INSTRUCTIONS = 1u << 1, // 执行的指令
+    EZS_BENCHMARK_PERF_CACHE_REFERENCES = 1u << 2, // 末级缓存访问
+    EZS_BENCHMARK_PERF_CACHE_MISSES = 1u << 3, // 末级缓存未命中
+    EZS_BENCHMARK_PERF_BRANCH_MISSES = 1u << 4, // 分支预测失败
+    EZS_BENCHMARK_PERF_ALL = (1u << 5) - 1,
+} ezs_benchmark_perf_event;
+
+// 启用events中的硬件计数器，之后开始的计时会同时读取计数器
+// 会先在当前线程中试探，计数器全部不可用时返回false，并继续只记录耗时
+// 部分计数器不可用时仍然返回true，报告中对应的列显示为N/A
+// events为0时关闭硬件计数器并返回false
+bool ezs_benchmark_enable_perf_counters(unsigned events);
+
+/*---------------------------EZS_BENCHMARK 资源使用量---------------------------*/
+
+/*
+ * 耗时的尖峰往往来自缺页或被调度器抢占，而这些在耗时中是看不出来的
+ * 启用资源使用量后，每次start/end都会额外读取一次本线程的getrusage(RUSAGE_THREAD)（仅Linux），
+ * 报告中会增加资源使用量表，给出次缺页与主缺页、主动与被动上下文切换的总次数，以及每次调用的用户态与内核态CPU时间
+ *
+ * 每次读取需要一次系统调用，因此默认关闭，只适合用于耗时远大于此的区域
+ */
+
+// 启用或关闭资源使用量的记录，之后开始的计时会同时读取资源使用量
+// 当前平台不支持时打印警告并返回false，并继续只记录耗时
+// enable为false时关闭并返回false
+bool ezs_benchmark_enable_resource_usage(bool enable);
+
+/*---------------------------EZS_BENCHMARK CPU时间---------------------------*/
+
+/*
+ * 耗时是墙钟时间，等待I/O或锁的区域与一直在计算的区域看起来没有区别
+ * 启用CPU时间后，每次start/end都会额外读取本线程与本进程的CPU时间，报告中会增加CPU时间表：
+ * 线程CPU时间 / 耗时 明显低于100%说明区域在阻塞，进程CPU时间 / 耗时 超过100%说明期间还有其他线程在运行
+ *
+ * 在Linux上每次读取需要两次系统调用，因此默认关闭
+ */
+
+// 启用或关闭CPU时间的记录，之后开始的计时会同时读取CPU时间
+// 当前平台不支持时打印警告并返回false，并继续只记录耗时
+// enable为false时关闭并返回false
+bool ezs_benchmark_enable_cpu_time(bool enable);
+
+/*---------------------------EZS_BENCHMARK 捕获模式---------------------------*/
+
+/*
+ * 默认情况下，每次end都会立即更新统计数据（平均值、方差、直方图等），这部分开销落在被测线程上
+ *
+ * 启用捕获模式后，end只把一条原始样本(id, 开始时间, 结束时间)追加到本线程预先分配的环形缓冲区，
+ * 统计数据推迟到打印、查询或导出时才计算
+ * 缓冲区写满后会覆盖最旧的样本，覆盖前尚未被统计的样本不会计入统计数据，报告中会给出丢失的样本数
+ * end不会替将被覆盖的样本计算统计数据，否则缓冲区写满后每次end的开销都会超过默认模式
+ * 因此缓冲区应当足够容纳两次合并（打印、查询、导出）之间的所有样本，
+ * 启用ezs_benchmark_live_publish时，发布线程每次刷新都会在被测线程之外合并
+ *
+ * 缓冲区中保留的原始样本可以用ezs_benchmark_samples取出，用于自定义的分析
+ */
+
+// 一条原始样本，时间为ezs_clock_get_performance_counter给出的纳秒数
+typedef struct {
+    ezs_benchmark_id id; // 条目的句柄，可用ezs_benchmark_name获取名称
+    uint32_t thread; // 记录该样本的线程的序号，按线程首次计时的顺序从0开始
+    uint64_t start_ns;
+    uint64_t end_ns;
+} ezs_benchmark_sample;
+
+// 启用捕获模式，每个线程的环形缓冲区可容纳samples_per_thread条样本（每条24字节）
+// 缓冲区在各线程下一次start时分配，分配失败时该线程退回到立即统计
+// samples_per_thread为0时关闭捕获模式
+void ezs_benchmark_enable_capture(size_t samples_per_thread);
+
+// 将所有线程缓冲区中保留的样本复制到samples，最多复制capacity条
+// 同一线程的样本按时间先后排列
+// 返回保留的样本总数，可以先以(nullptr, 0)调用获取所需的容量
+size_t ezs_benchmark_samples(ezs_benchmark_sample *samples, size_t capacity);
+
+// 获取句柄对应的名称，句柄无效时返回nullptr
+// 名称在ezs_benchmark_drop之前保持有效
+const char *ezs_benchmark_name(ezs_benchmark_id id);
+
+/*---------------------------EZS_BENCHMARK 堆分配---------------------------*/
+
+/*
+ * 以CMake选项EZS_BENCHMARK_ALLOC_TRACKING=ON构建时（仅Linux + GCC/Clang），
+ * 会通过链接器的--wrap选项拦截malloc/calloc/realloc/free，并把每次分配归属到本线程最内层的正在计时的区域
+ * 报告中会增加堆分配表，给出每次调用的分配次数与字节数，以及单次调用中尚未释放的字节数的峰值（Peak Live）
+ *
+ * 分配次数与字节数不含子区域，Peak Live包含子区域
+ * 只有静态链接进可执行文件的代码中的调用会被拦截，共享库内部（包括libc自身，例如strdup）的分配不会被计入
+ * 每次分配会额外读取一次malloc_usable_size，因此默认关闭
+ */
+
+/*---------------------------EZS_BENCHMARK 嵌套区域---------------------------*/
+
+/*
+ * 在一个条目的start与end之间开始的其他条目，被视为该条目的子区域
+ * 例如 request → parse → hash，每个线程各自维护正在计时的区域栈
+ * 同一条目出现在不同的父区域下时，会在调用树中分别统计
+ *
+ * 调用树中的Total为包含子区域的总耗时，Self为扣除直接子区域后的耗时
+ * 存在嵌套的区域时，ezs_benchmark_print_all会在结果表之后打印调用树
+ */
+
+// 打印所有线程合并后的调用树
+void ezs_benchmark_print_tree(void);
+
+/*---------------------------EZS_BENCHMARK_SCOPE---------------------------*/
+
+// 为当前作用域计时，离开作用域时自动结束计时
+// 句柄在首次执行时注册，并缓存在函数内的静态变量中，之后的执行不再查找名称表
+// 因此name应当是在该位置上固定不变的名称
+// ezs_benchmark_drop之后缓存自动失效并重新注册，注册失败时本次不计时，下次执行时重试
+// 依赖GCC/Clang的cleanup属性
+//
+// 例如：
+// void parse(void) {
+//     EZS_BENCHMARK_SCOPE("parse");
+//     ...
+// }
+#define EZS_BENCHMARK_SCOPE(name) \
+    I_EZS_BENCHMARK_SCOPE(name, \
+                          I_EZS_BENCHMARK_CONCAT(i_ezs_benchmark_scope_, __LINE__), \
+                          I_EZS_BENCHMARK_CONCAT(i_ezs_benchmark_scope_cache_, __LINE__))
+
+#define I_EZS_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define I_EZS_BENCHMARK_CONCAT(a, b) I_EZS_BENCHMARK_CONCAT_IMPL(a, b)
+#define I_EZS_BENCHMARK_SCOPE(name, var, cache) \
+    static _Atomic uint64_t cache = 0; \
+    __attribute__((cleanup(i_ezs_benchmark_scope_exit))) \
+    const ezs_benchmark_id var = i_ezs_benchmark_scope_enter(&cache, (name))
+
+// EZS_BENCHMARK_SCOPE的内部实现，不应直接调用
+ezs_benchmark_id i_ezs_benchmark_scope_enter(_Atomic uint64_t *cache, const char *name) __attribute__((nonnull(1)));
+
+// EZS_BENCHMARK_SCOPE的内部实现，不应直接调用
+void i_ezs_benchmark_scope_exit(const ezs_benchmark_id *id);
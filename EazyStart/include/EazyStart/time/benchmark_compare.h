@@ -0,0 +1,42 @@
+#pragma once
+
+/*
+ * EazyStart的benchmark条目对比
+ *
+ * 两次运行的平均值相差3%时，仅凭平均值与相对标准差无法判断这是真实的差异还是噪声
+ * ezs_benchmark_compare对两个条目记录的耗时分布进行统计检验：
+ * 1. 加速比：基准条目的平均耗时 / 候选条目的平均耗时，大于1表示候选更快
+ *    并通过自助法（bootstrap）重采样给出95%置信区间
+ * 2. Mann-Whitney U检验：不假设耗时服从正态分布，给出两组耗时来自同一分布的双侧p值
+ * 当p值小于0.05且置信区间不包含1时，判定候选更快或更慢，否则判定为无法区分
+ *
+ * 检验基于每个条目的耗时直方图，耗时按直方图的精度（默认约1%）分组
+ *
+ * 例如：
+ * for (...) { ezs_benchmark_start("sort old"); old_sort(data); ezs_benchmark_end("sort old"); }
+ * for (...) { ezs_benchmark_start("sort new"); new_sort(data); ezs_benchmark_end("sort new"); }
+ * ezs_benchmark_compare("sort old", "sort new", nullptr);
+ */
+
+// 对比的结论
+typedef enum {
+    EZS_BENCHMARK_INDISTINGUISHABLE, // 无法区分
+    EZS_BENCHMARK_FASTER, // 候选更快
+    EZS_BENCHMARK_SLOWER, // 候选更慢
+} ezs_benchmark_verdict;
+
+// 对比的结果
+typedef struct {
+    double baseline_mean_ns; // 基准条目的平均耗时（纳秒）
+    double candidate_mean_ns; // 候选条目的平均耗时（纳秒）
+    double speedup; // 加速比，大于1表示候选更快
+    double speedup_lower; // 加速比95%置信区间的下界
+    double speedup_upper; // 加速比95%置信区间的上界
+    double p_value; // Mann-Whitney U检验的双侧p值
+    ezs_benchmark_verdict verdict;
+} ezs_benchmark_comparison;
+
+// 对比基准条目baseline与候选条目candidate，并打印对比表
+// result不为nullptr时存入对比的结果
+// 任一条目不存在或少于2次计时时返回false
+bool ezs_benchmark_compare(const char *baseline, const char *candidate, ezs_benchmark_comparison *result) __attribute__((nonnull(1, 2)));
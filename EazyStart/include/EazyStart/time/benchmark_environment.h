@@ -0,0 +1,30 @@
+#pragma once
+
+/*
+ * EazyStart的benchmark运行环境
+ *
+ * 同一段代码在不同的机器、不同的系统设置下测得的耗时往往相差很大：
+ * 线程在核心之间迁移会丢失缓存，CPU频率调节器与睿频会让主频随负载和温度变化
+ * ezs_benchmark_setup_environment在测量前将当前线程绑定到一个核心，并检查这些设置
+ * 绑定只作用于调用它的线程：已经存在的其他线程不受影响，之后由该线程创建的线程会继承同一个核心，
+ * 因此多线程的测量（例如ezs_benchmark_scaling）不应在绑定后的线程中进行
+ *
+ * 报告与导出文件会附带运行环境信息，便于判断两份结果是否可以比较：
+ * CPU型号、逻辑核心数、各级缓存大小、内核版本，以及编译EazyStart所用的编译器、编译选项与构建类型
+ * pinned_cpu给出绑定的核心与被绑定的线程号，cpu_governor是该核心的频率调节器，
+ * 没有绑定时是生成报告的线程当时所在核心的频率调节器
+ *
+ * 绑定核心与系统设置的检查仅支持Linux，其他平台上只记录编译信息
+ *
+ * 例如：
+ * int main(void) {
+ *     ezs_benchmark_setup_environment(2);
+ *     run_workload();
+ * }
+ */
+
+// 准备测量环境：将当前线程（仅当前线程）绑定到编号为cpu的核心，并检查可能影响结果的系统设置
+// cpu为负数时不绑定，只检查当前所在核心的设置
+// CPU频率调节器不是performance或睿频已开启时打印警告
+// 绑定失败或当前平台不支持时返回false
+bool ezs_benchmark_setup_environment(int cpu);
@@ -0,0 +1,58 @@
+#pragma once
+
+/*
+ * EazyStart的benchmark结果导出与基线对比
+ *
+ * ezs_benchmark_export_json/csv将所有条目合并后的统计数据写入文件，供其他工具读取
+ * 耗时的单位均为纳秒，吞吐量（items_per_second/bytes_per_second）的单位为每秒，未记录工作量时为0
+ * JSON的environment对象记录了运行环境（见benchmark_environment.h），CSV只包含各条目的统计数据
+ * outliers为Tukey栅栏以外的样本数，启用ezs_benchmark_exclude_outliers时mean_ns/std_dev_ns/rsd_percent不含离群值
+ *
+ * ezs_benchmark_compare_baseline读取之前导出的文件作为基线，与当前的数据逐条对比
+ * 当某个条目的平均值或分位数（P50/P95/P99）比基线慢了超过threshold时，视为性能退化
+ * 其返回值可以直接作为main函数的返回值，用于在构建流程中拦截性能退化
+ *
+ * 例如：
+ * int main(void) {
+ *     run_workload();
+ *     ezs_benchmark_export_json("current.json");
+ *     return ezs_benchmark_compare_baseline("baseline.json", 0.05);
+ * }
+ */
+
+/*---------------------------EZS_BENCHMARK 导出---------------------------*/
+
+// 将所有条目的统计数据以JSON格式写入path，文件已存在时覆盖
+// 写入失败时返回false
+bool ezs_benchmark_export_json(const char *path) __attribute__((nonnull(1)));
+
+// 将所有条目的统计数据以CSV格式写入path，文件已存在时覆盖
+// 首行为列名，每个条目一行
+// 写入失败时返回false
+bool ezs_benchmark_export_csv(const char *path) __attribute__((nonnull(1)));
+
+/*---------------------------EZS_BENCHMARK 时间线---------------------------*/
+
+/*
+ * 汇总表格会掩盖线程之间的停顿与先后顺序问题
+ * ezs_benchmark_export_trace将捕获模式记录的每一次start/end写成Chrome Trace Event格式的JSON，
+ * 可以在chrome://tracing或Perfetto（https://ui.perfetto.dev）中按线程查看时间线，嵌套的区域会显示为层叠的色块
+ *
+ * 时间线的数据来自捕获模式的环形缓冲区，因此需要先调用ezs_benchmark_enable_capture
+ * 内存占用由缓冲区容量决定，写满后最旧的区域会被丢弃，尚未计入统计数据的区域同时从统计数据中丢失
+ */
+
+// 将捕获模式下保留的所有样本以Chrome Trace Event格式写入path，文件已存在时覆盖
+// 时间以第一个样本的开始时间为零点，线程以其序号区分
+// 运行环境信息写入顶层的otherData对象
+// 写入失败时返回false
+bool ezs_benchmark_export_trace(const char *path) __attribute__((nonnull(1)));
+
+/*---------------------------EZS_BENCHMARK 基线对比---------------------------*/
+
+// 读取path中的基线（由ezs_benchmark_export_json或ezs_benchmark_export_csv导出，按内容自动识别格式），
+// 与当前的统计数据对比并打印对比表
+// threshold为允许的相对变慢程度，例如0.05表示允许慢5%
+// 只在基线或当前数据中出现的条目会被列出，但不视为退化
+// 没有退化时返回EXIT_SUCCESS，存在退化或无法读取基线时返回EXIT_FAILURE
+[[nodiscard]] int ezs_benchmark_compare_baseline(const char *path, double threshold) __attribute__((nonnull(1)));
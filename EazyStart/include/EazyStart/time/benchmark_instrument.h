@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+
+/*
+ * EazyStart的函数级自动插桩
+ *
+ * 以-finstrument-functions编译的代码在每个函数的入口与出口调用__cyg_profile_func_enter/exit，
+ * EazyStart提供这两个钩子，无需修改源码即可得到每个函数的调用次数、总耗时与自身耗时（扣除被插桩的子函数）
+ * 递归调用只在最外层返回时计入总耗时，自身耗时按每层分别扣除
+ *
+ * 在CMake中打开EZS_BENCHMARK_INSTRUMENT_FUNCTIONS后，对需要插桩的目标调用ezs_instrument_functions(目标)：
+ * 该函数为目标加上-finstrument-functions，并以ENABLE_EXPORTS（-rdynamic）链接，使dladdr能够解析函数名
+ * EazyStart自身与STC不会被插桩，static函数会显示为"模块+偏移"
+ *
+ * 每个线程在首次进入被插桩的函数时分配自己的函数表与调用栈，钩子不加锁，只做一次哈希查找与一次时钟读取，
+ * 函数名在打印报告时才由dladdr解析
+ * 插桩的开销与调用次数成正比，短小的热函数会被明显拖慢，可以用以下方式限制开销：
+ * 1. 编译期：EZS_BENCHMARK_INSTRUMENT_EXCLUDE_FILES与EZS_BENCHMARK_INSTRUMENT_EXCLUDE_FUNCTIONS
+ *    （GCC的-finstrument-functions-exclude-file-list/-function-list），被排除的函数完全没有开销
+ * 2. 运行期：ezs_benchmark_instrument_filter，被过滤的函数在每个线程中首次调用时解析一次名称，
+ *    之后只有一次哈希查找，不读取时钟
+ *
+ * ezs_benchmark_print_all（包括程序退出时的报告）会打印自身耗时最多的函数
+ *
+ * 仅支持Linux上的GCC/Clang，其他平台上相关函数不做任何事
+ *
+ * 例如：
+ * ezs_benchmark_instrument_filter("parse_*,eval_*", "*_inline");
+ * run_workload();
+ * ezs_benchmark_print_instrumented();
+ */
+
+// 设置运行期过滤器，include与exclude均为以逗号分隔的通配符模式（fnmatch），与函数名匹配
+// include为nullptr或空字符串时包含所有函数，函数同时匹配两者时被排除
+// 新的过滤器对所有函数生效，已记录的数据保留
+// 未启用插桩或内存不足时返回false，此时过滤器不变
+bool ezs_benchmark_instrument_filter(const char *include, const char *exclude);
+
+// 暂停或恢复记录，暂停期间进入的函数不计时，默认为记录
+void ezs_benchmark_instrument_enable(bool enable);
+
+// 打印自身耗时最多的函数
+void ezs_benchmark_print_instrumented(void);
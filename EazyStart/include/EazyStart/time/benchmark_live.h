@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * EazyStart的实时统计发布
+ *
+ * 报告只在程序退出时打印，对连续运行数天的服务没有帮助
+ * ezs_benchmark_live_publish启动一个发布线程，每隔一段时间将所有条目合并后的统计数据
+ * 写入一块命名的共享内存（shm_open + mmap），其他进程可以随时附加并读取，无需停止被测进程，也不经过它的stdout
+ *
+ * 共享内存以顺序锁（seqlock）保护：发布线程写入前后各递增一次序号，读者在序号为奇数或前后不一致时重试，
+ * 因此读者永远不会阻塞发布线程，被测进程也感知不到读者的存在
+ * 共享内存的开头记录了格式版本，读者拒绝附加版本或条目大小不一致的共享内存
+ *
+ * 读者可以使用ezs_benchmark_live_attach等函数，或者直接运行命令行工具ezs_benchmark_live：
+ * ezs_benchmark_live /my-service        持续刷新表格
+ * ezs_benchmark_live /my-service 0      只打印一次
+ *
+ * 仅支持POSIX系统，其他平台上发布与附加总是失败
+ *
+ * 例如：
+ * ezs_benchmark_live_publish("/my-service", 1000, 256);
+ */
+
+// 共享内存格式的版本，布局改变时递增
+#define EZS_BENCHMARK_LIVE_VERSION 1
+// 共享内存中条目名称的最大长度（含结尾的'\0'），更长的名称会被截断
+#define EZS_BENCHMARK_LIVE_NAME_SIZE 64
+
+// 共享内存中的一个条目，耗时单位均为纳秒
+typedef struct {
+    char name[EZS_BENCHMARK_LIVE_NAME_SIZE];
+    uint64_t count;
+    double mean_ns;
+    double min_ns;
+    double max_ns;
+    double std_dev_ns;
+    double p50_ns;
+    double p95_ns;
+    double p99_ns;
+    double p999_ns;
+} ezs_benchmark_live_entry;
+
+// 一次读取得到的快照信息
+typedef struct {
+    int64_t pid; // 发布者的进程号
+    uint64_t snapshot; // 发布的次数
+    struct timespec updated; // 最近一次发布的时间（TIME_UTC）
+    size_t entry_count; // 快照中的条目总数，可能大于读取时给出的容量
+    bool stopped; // 发布者已停止发布
+} ezs_benchmark_live_info;
+
+// 附加到共享内存的读者
+typedef struct ezs_benchmark_live_reader ezs_benchmark_live_reader;
+
+/*---------------------------发布---------------------------*/
+
+// 以name（如"/my-service"，须以'/'开头）创建共享内存，每隔interval_ms毫秒发布一次统计数据，最多发布max_entries个条目
+// 重复调用会先停止之前的发布
+// 共享内存以独占方式创建：name已被仍在运行的进程发布时失败，只有记录的发布者进程已退出（例如崩溃）时才回收它
+// 参数无效、系统不支持或创建共享内存失败时返回false
+// ezs_benchmark_drop（包括程序退出时的报告）会停止发布
+bool ezs_benchmark_live_publish(const char *name, unsigned interval_ms, size_t max_entries) __attribute__((nonnull(1)));
+
+// 发布最后一次快照后停止发布，并删除共享内存的名称，已附加的读者仍可读取最后的快照
+void ezs_benchmark_live_stop(void);
+
+/*---------------------------读取---------------------------*/
+
+// 以只读方式附加到名为name的共享内存
+// 共享内存不存在、尚未初始化完毕或版本不一致时返回nullptr
+[[nodiscard]] ezs_benchmark_live_reader *ezs_benchmark_live_attach(const char *name) __attribute__((nonnull(1)));
+
+// 读取一份一致的快照，信息存入info，前capacity个条目存入entries，entries可以为nullptr
+// 返回存入entries的条目数
+size_t ezs_benchmark_live_read(ezs_benchmark_live_reader *reader, ezs_benchmark_live_info *info,
+                               ezs_benchmark_live_entry entries[], size_t capacity) __attribute__((nonnull(1, 2)));
+
+// 读取一份快照并以表格形式打印到stdout
+void ezs_benchmark_live_print(ezs_benchmark_live_reader *reader) __attribute__((nonnull(1)));
+
+// 解除附加并释放读者，reader可以为nullptr
+void ezs_benchmark_live_detach(ezs_benchmark_live_reader *reader);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "benchmark_run.h"
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * EazyStart的开环负载测试
+ *
+ * 用start/end在循环中计时属于闭环测量：一次慢调用会推迟之后所有的调用，
+ * 这段本应排队等待的时间没有计入任何一次调用的耗时，于是高分位数被严重低估（协同遗漏，coordinated omission）
+ *
+ * ezs_benchmark_load按固定的目标速率预先排定每次调用的计划开始时间，与被测函数的快慢无关：
+ * 1. 未到计划时间时等待，落后于计划时立即发起下一次调用，不会跳过
+ * 2. 修正后的延迟从计划开始时间算起，包含了因前面的慢调用而排队的时间，即真实请求方看到的延迟
+ * 3. 未修正的延迟从实际开始时间算起，与闭环测量的结果相同，两者的差距就是被掩盖的排队时间
+ * 报告中同时给出两组分位数，以及实际达到的速率与目标速率
+ *
+ * 调用在当前线程中串行发起，因此目标速率不应超过被测函数单线程的吞吐量，否则队列会无限增长
+ * 为此测试最多持续duration的2倍，到时仍未发起的计划调用不再发起，计入unissued_calls并打印警告
+ *
+ * 例如：
+ * ezs_benchmark_load_options options = {.target_rate = 10000, .duration = {.tv_sec = 5}};
+ * ezs_benchmark_load("lookup", lookup, &table, &options);
+ */
+
+// 负载测试的选项
+typedef struct {
+    double target_rate; // 目标速率（次/秒）
+    struct timespec duration; // 计划发起调用的时长
+} ezs_benchmark_load_options;
+
+// 负载测试的结果，延迟的单位均为纳秒
+typedef struct {
+    uint64_t calls; // 实际调用次数
+    uint64_t unissued_calls; // 到达截止时间时仍未发起的计划调用次数
+    double target_rate; // 目标速率（次/秒）
+    double achieved_rate; // 实际速率（次/秒）
+    double p50_ns; // 修正后的分位数，从计划开始时间算起
+    double p90_ns;
+    double p99_ns;
+    double p999_ns;
+    double max_ns; // 各分位数均不超过对应的最大值
+    double uncorrected_p50_ns; // 未修正的分位数，从实际开始时间算起
+    double uncorrected_p90_ns;
+    double uncorrected_p99_ns;
+    double uncorrected_p999_ns;
+    double uncorrected_max_ns;
+} ezs_benchmark_load_result;
+
+// 以name为名称，按options中的目标速率与时长运行开环负载测试
+// 选项不合法时返回全0的结果
+// 结果会被记录下来，并出现在ezs_benchmark_print_all的报告中，同名的多次运行只保留最后一次的结果
+ezs_benchmark_load_result ezs_benchmark_load(const char *name, ezs_benchmark_function function, void *context,
+                                             const ezs_benchmark_load_options *options) __attribute__((nonnull(1, 2, 4)));
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stddef.h>
+
+/*
+ * EazyStart的采样分析器
+ *
+ * start/end只能度量已经怀疑的代码段，采样分析器用于找出没有想到的热点：
+ * 启用后，每个线程每消耗一段CPU时间就会收到一次SIGPROF，信号处理函数记录该线程的调用栈，
+ * 以及该线程当时最内层的正在计时的benchmark区域
+ *
+ * 每个线程使用自己的CPU时间定时器，调用ezs_benchmark_enable_profiler的线程立即开始采样，
+ * 其他线程在下一次ezs_benchmark_start时开始采样，从未计时的线程不会被采样
+ * （进程级的定时器在Linux 6.3之前总是把信号发给主线程，无法反映其他线程的热点）
+ *
+ * ezs_benchmark_print_all（包括程序退出时的报告）会按区域打印最热的函数，
+ * 函数以样本中最内层的帧计，不在任何区域中的样本归入[no region]
+ * ezs_benchmark_export_collapsed则写出flamegraph.pl与speedscope可读取的折叠栈格式，
+ * 每个栈的根为区域名称
+ *
+ * 仅支持Linux（timer_create + backtrace + dladdr），其他平台上启用总是失败
+ * 函数名由dladdr解析，只能解析动态符号表中的函数，因此可执行文件需要以-rdynamic链接
+ * （CMake中为ENABLE_EXPORTS属性），static函数会显示为"模块+偏移"
+ *
+ * 样本保存在启用时预先分配的缓冲区中，信号处理函数不分配内存，缓冲区写满后新的样本会被丢弃
+ *
+ * 例如：
+ * ezs_benchmark_enable_profiler(1000, 100000);
+ * run_workload();
+ * ezs_benchmark_export_collapsed("profile.folded");
+ */
+
+// 启用采样分析器，每个线程每消耗1/frequency_hz秒的CPU时间采样一次，最多保留max_samples个样本（每个约520字节）
+// 重复启用会先停止采样，并清除之前的样本
+// 参数无效或系统不支持时返回false
+bool ezs_benchmark_enable_profiler(unsigned frequency_hz, size_t max_samples);
+
+// 停止采样，已记录的样本保留到ezs_benchmark_clear或ezs_benchmark_drop
+void ezs_benchmark_disable_profiler(void);
+
+// 按区域打印样本最多的函数
+void ezs_benchmark_print_profile(void);
+
+// 将所有样本以折叠栈格式写入path，文件已存在时覆盖
+// 每行为"区域;最外层函数;...;最内层函数 样本数"
+// 写入失败时返回false
+bool ezs_benchmark_export_collapsed(const char *path) __attribute__((nonnull(1)));
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * EazyStart的微基准测试运行器
+ *
+ * ezs_benchmark_start/end适合度量耗时在微秒以上的代码段
+ * 对于耗时只有几纳秒到几百纳秒的操作，一次计时本身的开销与时钟精度就会淹没被测代码
+ *
+ * ezs_benchmark_run会自动完成以下工作：
+ * 1. 预热：反复调用被测函数，让缓存、分支预测器与CPU频率进入稳定状态
+ * 2. 校准：逐步增大每个样本内的调用次数，直到一个样本的耗时远大于时钟精度
+ * 3. 采样：重复采样，直到平均值的相对标准误低于目标，或用完时间预算
+ * 结果以每次调用的耗时给出，并会出现在ezs_benchmark_print_all的报告中
+ *
+ * 被测函数的返回值如果没有被使用，编译器可能会把整个调用优化掉
+ * 此时应当使用ezs_do_not_optimize或ezs_clobber_memory，而不是volatile变量
+ *
+ * 例如：
+ * static void roll(void *context) {
+ *     ezs_do_not_optimize(ezs_random_int_inclusive(1, 6));
+ * }
+ * ezs_benchmark_run("dice roll", roll, nullptr, nullptr);
+ */
+
+/*---------------------------EZS_BENCHMARK_RUN 防优化原语---------------------------*/
+
+#if defined(__GNUC__) || defined(__clang__)
+// 告诉编译器value的值会被使用，阻止其计算被优化掉
+// value可以是任意表达式，不会产生额外的内存读写
+#define ezs_do_not_optimize(value) __asm__ volatile("" : : "r,m"(value) : "memory")
+// 告诉编译器所有内存都可能被读写，阻止对内存的写入被优化掉或被重排到此处之后
+#define ezs_clobber_memory() __asm__ volatile("" : : : "memory")
+#else
+// 在不支持内联汇编的编译器上，通过调用外部函数尽量阻止优化，效果不作保证
+#define ezs_do_not_optimize(value) ((void) (value), i_ezs_clobber_memory())
+#define ezs_clobber_memory() i_ezs_clobber_memory()
+#endif
+
+// ezs_clobber_memory的后备实现，不应直接调用
+void i_ezs_clobber_memory(void);
+
+/*---------------------------EZS_BENCHMARK_RUN 运行器---------------------------*/
+
+// 被测函数，context为调用ezs_benchmark_run时传入的上下文
+typedef void (*ezs_benchmark_function)(void *context);
+
+// 运行器的选项
+typedef struct {
+    struct timespec warmup_time; // 预热时长
+    struct timespec time_budget; // 校准与采样的总时长上限
+    struct timespec min_sample_time; // 一个样本的最短耗时，实际取值不会小于时钟精度的1000倍
+    double target_relative_error; // 目标相对标准误，例如0.01表示1%
+    uint64_t min_samples; // 最少样本数
+    uint64_t max_samples; // 最多样本数
+} ezs_benchmark_run_options;
+
+// 运行器的结果，耗时均为每次调用的耗时
+typedef struct {
+    uint64_t batch_size; // 每个样本内的调用次数
+    uint64_t sample_count; // 样本数
+    uint64_t total_iterations; // 采样阶段的总调用次数
+    double mean_ns; // 平均耗时（纳秒）
+    double min_ns; // 最快样本的平均耗时（纳秒）
+    double std_dev_ns; // 样本间的标准差（纳秒）
+    double relative_standard_error; // 平均值的相对标准误，例如0.01表示1%
+    bool converged; // 是否在时间预算内达到了目标相对标准误
+} ezs_benchmark_run_result;
+
+// 获取默认选项
+// 预热0.1s，时间预算1s，样本最短10us，目标相对标准误1%，样本数[10, 100000]
+[[nodiscard]] ezs_benchmark_run_options ezs_benchmark_run_default_options(void);
+
+// 以name为名称运行微基准测试
+// options置空表示使用默认选项
+// 结果会被记录下来，并出现在ezs_benchmark_print_all的报告中
+// 同名的多次运行只保留最后一次的结果
+ezs_benchmark_run_result ezs_benchmark_run(const char *name, ezs_benchmark_function function, void *context,
+                                           const ezs_benchmark_run_options *options)
+__attribute__((nonnull(1, 2)));
+
+/*---------------------------EZS_BENCHMARK_RUN 规模扫描---------------------------*/
+
+/*
+ * 同一算法常常需要在不同的输入规模下分别计时，例如N = 1K, 2K, ..., 1M
+ * ezs_benchmark_sweep按几何级数取一系列规模，对每个规模调用一次ezs_benchmark_run，
+ * 每个规模的结果以"名称/N"记录，然后以最小二乘法把耗时分别拟合为c·f(n)，
+ * f(n)为1、log n、n、n log n与n²，取归一化均方根误差最小的一个作为经验复杂度
+ *
+ * 报告中会增加复杂度表，给出最佳拟合的复杂度、系数c与误差，意外的平方复杂度因此可以被自动发现
+ *
+ * 例如：
+ * static void sort(void *context, uint64_t n) {
+ *     sort_array(((int **) context)[0], n);
+ * }
+ * ezs_benchmark_sweep("sort", sort, &data, &(ezs_benchmark_sweep_range){.min_n = 1024, .max_n = 1 << 20, .multiplier = 2}, nullptr);
+ */
+
+// 参数化的被测函数，n为本次调用的输入规模
+typedef void (*ezs_benchmark_sweep_function)(void *context, uint64_t n);
+
+// 每个规模开始计时之前调用一次，用于准备规模为n的输入，其耗时不计入结果
+typedef void (*ezs_benchmark_sweep_setup)(void *context, uint64_t n);
+
+// 扫描的规模范围
+typedef struct {
+    uint64_t min_n; // 最小规模，不小于1
+    uint64_t max_n; // 最大规模（包含）
+    double multiplier; // 相邻两个规模之比，必须大于1，例如2
+    ezs_benchmark_sweep_setup setup; // 可以为nullptr
+} ezs_benchmark_sweep_range;
+
+// 经验复杂度
+typedef enum {
+    EZS_BENCHMARK_O_1,
+    EZS_BENCHMARK_O_LOG_N,
+    EZS_BENCHMARK_O_N,
+    EZS_BENCHMARK_O_N_LOG_N,
+    EZS_BENCHMARK_O_N_SQUARED,
+} ezs_benchmark_complexity;
+
+// 扫描的结果
+typedef struct {
+    size_t point_count; // 实际测量的规模个数
+    ezs_benchmark_complexity complexity; // 拟合误差最小的复杂度
+    double coefficient_ns; // 每次调用的耗时 ≈ coefficient_ns × f(n)
+    double rms; // 归一化均方根误差，以各规模的平均耗时为单位，例如0.05表示5%
+} ezs_benchmark_sweep_result;
+
+// 以name为名称对range中的每个规模运行微基准测试，并拟合经验复杂度
+// options置空表示使用默认选项，每个规模各自使用完整的时间预算
+// range无效时不运行，并返回point_count为0的结果
+ezs_benchmark_sweep_result ezs_benchmark_sweep(const char *name, ezs_benchmark_sweep_function function, void *context,
+                                               const ezs_benchmark_sweep_range *range,
+                                               const ezs_benchmark_run_options *options)
+__attribute__((nonnull(1, 2, 4)));
+
+// 获取复杂度的名称，例如"O(n log n)"
+const char *ezs_benchmark_complexity_name(ezs_benchmark_complexity complexity);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * EazyStart的多线程扩展测试
+ *
+ * 单线程的耗时无法说明代码能否利用更多的核心：锁竞争、伪共享与内存带宽都只在多个线程同时运行时才会出现
+ * ezs_benchmark_scaling依次以1、2、4……个线程（直到硬件线程数）同时运行被测函数：
+ * 1. 所有线程就绪后才同时开始，避免先创建的线程独占资源
+ * 2. 每个线程调用被测函数iterations次，整轮的墙钟时间为最早开始到最晚结束
+ * 3. 吞吐量 = 总调用次数 / 墙钟时间，加速比 = 吞吐量 / 单线程吞吐量，并行效率 = 加速比 / 线程数
+ *
+ * 每个线程的耗时记录在名为"name/N threads"的benchmark条目中，
+ * 因此结果表格中的Count为线程数，Min与Max之差反映了线程之间的负载不均
+ * 扩展测试的结果会出现在ezs_benchmark_print_all的报告中
+ *
+ * 每个线程的工作量固定，线程数增加时总工作量随之增加（弱扩展）
+ *
+ * 例如：
+ * static void increment(void *context, unsigned thread, unsigned thread_count) {
+ *     atomic_fetch_add((atomic_int *) context, 1);
+ * }
+ * atomic_int counter = 0;
+ * ezs_benchmark_scaling("atomic increment", increment, &counter, nullptr, nullptr, 0);
+ */
+
+// 被测函数，thread为线程序号，取值范围[0, thread_count)
+typedef void (*ezs_benchmark_scaling_function)(void *context, unsigned thread, unsigned thread_count);
+
+// 扩展测试的选项
+typedef struct {
+    unsigned max_threads; // 最多的线程数，0表示硬件线程数
+    uint64_t iterations; // 每个线程调用被测函数的次数
+} ezs_benchmark_scaling_options;
+
+// 一种线程数下的结果
+typedef struct {
+    unsigned threads;
+    double wall_ns; // 墙钟时间（纳秒）
+    double calls_per_second; // 吞吐量
+    double speedup; // 相对单线程吞吐量的加速比
+    double efficiency; // 并行效率，1表示线性扩展
+} ezs_benchmark_scaling_point;
+
+// 获取默认选项
+// 最多为硬件线程数，每个线程调用10000次
+[[nodiscard]] ezs_benchmark_scaling_options ezs_benchmark_scaling_default_options(void);
+
+// 以name为名称运行多线程扩展测试
+// options置空表示使用默认选项
+// 返回测量的线程数的种数，其中前capacity种的结果存入points，points可以为nullptr
+// 创建线程失败时停止测试，已经测量的结果仍然有效
+// 结果会被记录下来，并出现在ezs_benchmark_print_all的报告中，同名的多次运行只保留最后一次的结果
+size_t ezs_benchmark_scaling(const char *name, ezs_benchmark_scaling_function function, void *context,
+                             const ezs_benchmark_scaling_options *options,
+                             ezs_benchmark_scaling_point points[], size_t capacity) __attribute__((nonnull(1, 2)));
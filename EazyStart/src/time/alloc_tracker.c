@@ -0,0 +1,103 @@
+#include "alloc_tracker.h"
+#include <stddef.h>
+
+#ifdef EZS_BENCHMARK_ALLOC_TRACKING
+#include <malloc.h>
+
+// 只访问本线程的计数，拦截函数中不需要加锁，也不会重入
+static thread_local i_ezs_alloc_counters t_counters = {};
+
+// 由链接器的--wrap选项提供，指向原本的分配函数
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+// 记录一次成功的分配
+static void record_allocation(void *ptr, const size_t size) {
+    t_counters.count += 1;
+    t_counters.bytes += size;
+    t_counters.live += (int64_t) malloc_usable_size(ptr);
+    if (t_counters.live > t_counters.peak) {
+        t_counters.peak = t_counters.live;
+    }
+}
+
+void *__wrap_malloc(const size_t size) {
+    void *ptr = __real_malloc(size);
+    if (nullptr != ptr) {
+        record_allocation(ptr, size);
+    }
+    return ptr;
+}
+
+void *__wrap_calloc(const size_t count, const size_t size) {
+    void *ptr = __real_calloc(count, size);
+    // 溢出时calloc返回nullptr，因此这里的乘法不会溢出
+    if (nullptr != ptr) {
+        record_allocation(ptr, count * size);
+    }
+    return ptr;
+}
+
+void *__wrap_realloc(void *ptr, const size_t size) {
+    const int64_t old_size = nullptr != ptr ? (int64_t) malloc_usable_size(ptr) : 0;
+    void *new_ptr = __real_realloc(ptr, size);
+    if (nullptr == new_ptr) {
+        // size为0时原内存已被释放，否则原内存保持不变
+        if (0 == size) {
+            t_counters.live -= old_size;
+        }
+        return nullptr;
+    }
+    t_counters.live -= old_size;
+    record_allocation(new_ptr, size);
+    return new_ptr;
+}
+
+void __wrap_free(void *ptr) {
+    if (nullptr != ptr) {
+        t_counters.live -= (int64_t) malloc_usable_size(ptr);
+    }
+    __real_free(ptr);
+}
+
+void i_ezs_alloc_tracker_read(i_ezs_alloc_counters *counters) {
+    *counters = t_counters;
+}
+
+void i_ezs_alloc_tracker_restore(const i_ezs_alloc_counters *counters) {
+    t_counters = *counters;
+}
+
+int64_t i_ezs_alloc_tracker_begin_peak(void) {
+    const int64_t outer_peak = t_counters.peak;
+    t_counters.peak = t_counters.live;
+    return outer_peak;
+}
+
+void i_ezs_alloc_tracker_end_peak(const int64_t outer_peak) {
+    if (outer_peak > t_counters.peak) {
+        t_counters.peak = outer_peak;
+    }
+}
+
+#else
+
+void i_ezs_alloc_tracker_read(i_ezs_alloc_counters *counters) {
+    *counters = (i_ezs_alloc_counters){};
+}
+
+void i_ezs_alloc_tracker_restore(const i_ezs_alloc_counters *counters) {
+    (void) counters;
+}
+
+int64_t i_ezs_alloc_tracker_begin_peak(void) {
+    return 0;
+}
+
+void i_ezs_alloc_tracker_end_peak(const int64_t outer_peak) {
+    (void) outer_peak;
+}
+
+#endif
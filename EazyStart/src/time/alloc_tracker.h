@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * EZS内部使用的堆分配追踪
+ *
+ * 以CMake选项EZS_BENCHMARK_ALLOC_TRACKING构建时，通过链接器的--wrap选项
+ * 拦截malloc/calloc/realloc/free，并在每个线程中累计分配的次数与字节数
+ * 未启用时，I_EZS_ALLOC_TRACKING为false，读取得到的计数恒为0
+ *
+ * 只有静态链接进可执行文件的代码中的调用会被拦截，共享库（包括libc自身，例如strdup）内部的分配不会被计入
+ * 因此在其他线程或共享库中分配、在本线程中释放的内存会使live减小，甚至为负
+ *
+ * 本头文件为EZS内部使用，不属于公开接口
+ */
+
+#ifdef EZS_BENCHMARK_ALLOC_TRACKING
+#define I_EZS_ALLOC_TRACKING true
+#else
+#define I_EZS_ALLOC_TRACKING false
+#endif
+
+// 当前线程的分配计数
+typedef struct {
+    uint64_t count; // 分配次数，realloc计为一次分配
+    uint64_t bytes; // 申请的字节总数
+    int64_t live; // 当前线程分配减去释放的字节数，按实际可用大小计算
+    int64_t peak; // 自上次i_ezs_alloc_tracker_begin_peak以来live的最大值
+} i_ezs_alloc_counters;
+
+// 读取当前线程的分配计数
+void i_ezs_alloc_tracker_read(i_ezs_alloc_counters *counters) __attribute__((nonnull(1)));
+
+// 将当前线程的分配计数恢复为counters，使此后的分配（例如EZS自身的分配）不计入任何区域
+void i_ezs_alloc_tracker_restore(const i_ezs_alloc_counters *counters) __attribute__((nonnull(1)));
+
+// 将当前线程的peak重置为live，开始统计新的峰值，返回重置前的peak
+int64_t i_ezs_alloc_tracker_begin_peak(void);
+
+// 结束i_ezs_alloc_tracker_begin_peak开始的峰值统计，将peak恢复为不小于outer_peak
+void i_ezs_alloc_tracker_end_peak(int64_t outer_peak);
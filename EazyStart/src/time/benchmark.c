@@ -1,7 +1,21 @@
 #include "EazyStart/time/benchmark.h"
+#include "EazyStart/time/benchmark_live.h"
 #include "EazyStart/time/clock.h"
+#include "alloc_tracker.h"
+#include "benchmark_internal.h"
+#include "call_tree.h"
+#include "cpu_time.h"
+#include "histogram.h"
+#include "perf_counter.h"
+#include "resource_usage.h"
+#include "table.h"
 #include <inttypes.h>
 #include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
 #include <stc/cstr.h>
 
 typedef struct {
@@ -12,8 +26,46 @@ typedef struct {
     struct timespec maxDuration;
     struct timespec sumDuration;
     long double correctedSumSquaredDuration; // Corrected Sum of Squares [Welford 方差计算]
+    i_ezs_histogram histogram; // 耗时分布 [纳秒]
+    bool hasCounterStart; // 本次计时开始时是否读取了硬件计数器
+    uint64_t counterStart[I_EZS_PERF_COUNTER_KINDS]; // 本次计时开始时的硬件计数器
+    uint64_t counterSum[I_EZS_PERF_COUNTER_KINDS]; // 硬件计数器增量的总和
+    uint64_t counterCount; // 带有硬件计数器数据的计时次数
+    unsigned counterEvents; // 计数过的硬件计数器种类
+    bool hasUsageStart; // 本次计时开始时是否读取了资源使用量
+    i_ezs_resource_usage usageStart; // 本次计时开始时的资源使用量
+    i_ezs_resource_usage usageSum; // 资源使用量增量的总和
+    uint64_t usageCount; // 带有资源使用量数据的计时次数
+    bool hasCpuStart; // 本次计时开始时是否读取了CPU时间
+    i_ezs_cpu_time cpuStart; // 本次计时开始时的CPU时间
+    uint64_t cpuThreadNs; // 线程CPU时间增量的总和
+    uint64_t cpuProcessNs; // 进程CPU时间增量的总和
+    uint64_t cpuWallNs; // 带有CPU时间数据的计时的总耗时
+    uint64_t cpuCount; // 带有CPU时间数据的计时次数
+    uint64_t workCount; // 给出了工作量的计时次数
+    uint64_t workItems; // 处理的元素总数
+    uint64_t workBytes; // 处理的字节总数
+    uint64_t workNanoseconds; // 给出了工作量的计时的总耗时
+    uint64_t allocCalls; // 追踪了堆分配的计时次数
+    uint64_t allocCount; // 不含子区域的分配次数
+    uint64_t allocBytes; // 不含子区域的分配字节数
+    uint64_t allocPeakBytes; // 单次计时中尚未释放的字节数的最大值，包含子区域
 } BenchmarkEntry;
 
+// 一次计时处理的工作量
+typedef struct {
+    uint64_t items;
+    uint64_t bytes;
+} BenchmarkWork;
+
+// 将纳秒数转换为timespec
+static struct timespec nanoseconds_to_timespec(const uint64_t nanoseconds) {
+    return (struct timespec){
+        .tv_sec = (time_t) (nanoseconds / 1000000000ULL),
+        .tv_nsec = (long) (nanoseconds % 1000000000ULL)
+    };
+}
+
 // 平均值计算
 static struct timespec mean_duration(const struct timespec sumDuration, const uint64_t count) {
     return ezs_clock_timespec_div(sumDuration, count);
@@ -35,46 +87,671 @@ static long double relative_standard_deviation(const long double sample_std_dev,
     return meanInSeconds != 0.0 ? sample_std_dev / meanInSeconds * 100.0 : 0.0;
 }
 
+// 查询条目的耗时分位数，percentile取值范围[0, 100]
+// 直方图给出的是桶内的最大等价值，这里将其限制在[min, max]之内
+static uint64_t entry_percentile(const BenchmarkEntry *entry, const double percentile) {
+    const uint64_t value = i_ezs_histogram_value_at_quantile(&entry->histogram, percentile / 100.0);
+    const uint64_t min = i_ezs_benchmark_timespec_to_ns(entry->minDuration);
+    const uint64_t max = i_ezs_benchmark_timespec_to_ns(entry->maxDuration);
+    return value < min ? min : value > max ? max : value;
+}
+
+// 将桶的中间值限制在条目的[min, max]之内
+static double clamp_bucket_value(const BenchmarkEntry *entry, const uint64_t value) {
+    const uint64_t min = i_ezs_benchmark_timespec_to_ns(entry->minDuration);
+    const uint64_t max = i_ezs_benchmark_timespec_to_ns(entry->maxDuration);
+    return (double) (value < min ? min : value > max ? max : value);
+}
+
+// 查询排在第rank位（从1开始）的样本所在的桶
+static size_t bucket_at_rank(const i_ezs_histogram_bucket buckets[], const size_t count, const uint64_t rank) {
+    uint64_t seen = 0;
+    for (size_t i = 0; i < count; i += 1) {
+        seen += buckets[i].count;
+        if (seen >= rank) {
+            return i;
+        }
+    }
+    return count - 1;
+}
+
+// 按最近秩法查询分位数，quantile取值范围[0, 1]
+static double bucket_quantile(const BenchmarkEntry *entry, const i_ezs_histogram_bucket buckets[], const size_t count,
+                              const uint64_t total, const double quantile) {
+    const double rank = ceil(quantile * (double) total);
+    const size_t index = bucket_at_rank(buckets, count, rank < 1.0 ? 1 : (uint64_t) rank);
+    return clamp_bucket_value(entry, buckets[index].value);
+}
+
+// 中位数绝对偏差
+// 桶按值排列，因此以中位数为起点向两侧归并，偏差即按从小到大的顺序出现
+static double median_absolute_deviation(const BenchmarkEntry *entry, const i_ezs_histogram_bucket buckets[],
+                                        const size_t count, const uint64_t total, const double median) {
+    size_t right = 0;
+    while (right < count && clamp_bucket_value(entry, buckets[right].value) < median) {
+        right += 1;
+    }
+    size_t left = right;
+    const uint64_t rank = (total + 1) / 2;
+    uint64_t seen = 0;
+    while (true) {
+        const double left_deviation = left > 0 ? median - clamp_bucket_value(entry, buckets[left - 1].value) : INFINITY;
+        const double right_deviation = right < count ? clamp_bucket_value(entry, buckets[right].value) - median : INFINITY;
+        const bool take_left = left_deviation < right_deviation;
+        seen += take_left ? buckets[left - 1].count : buckets[right].count;
+        if (seen >= rank) {
+            return take_left ? left_deviation : right_deviation;
+        }
+        if (take_left) {
+            left -= 1;
+        } else {
+            right += 1;
+        }
+    }
+}
+
+// 由条目的耗时直方图计算稳健统计量
+// 直方图为空或分配失败时返回false
+static bool calculate_robust_statistics(const BenchmarkEntry *entry, ezs_benchmark_robust_stats *stats) {
+    size_t count = 0;
+    i_ezs_histogram_bucket *buckets = i_ezs_histogram_buckets(&entry->histogram, &count);
+    if (nullptr == buckets) {
+        return false;
+    }
+    const uint64_t total = entry->histogram.total;
+    *stats = (ezs_benchmark_robust_stats){.samples = total};
+    stats->median_ns = bucket_quantile(entry, buckets, count, total, 0.5);
+    stats->q1_ns = bucket_quantile(entry, buckets, count, total, 0.25);
+    stats->q3_ns = bucket_quantile(entry, buckets, count, total, 0.75);
+    stats->iqr_ns = stats->q3_ns - stats->q1_ns;
+    stats->mad_ns = median_absolute_deviation(entry, buckets, count, total, stats->median_ns);
+
+    // Tukey栅栏
+    const double low_severe = stats->q1_ns - 3.0 * stats->iqr_ns;
+    const double low_mild = stats->q1_ns - 1.5 * stats->iqr_ns;
+    const double high_mild = stats->q3_ns + 1.5 * stats->iqr_ns;
+    const double high_severe = stats->q3_ns + 3.0 * stats->iqr_ns;
+    uint64_t inliers = 0;
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i += 1) {
+        const double value = clamp_bucket_value(entry, buckets[i].value);
+        if (value < low_severe) {
+            stats->low_severe += buckets[i].count;
+        } else if (value < low_mild) {
+            stats->low_mild += buckets[i].count;
+        } else if (value > high_severe) {
+            stats->high_severe += buckets[i].count;
+        } else if (value > high_mild) {
+            stats->high_mild += buckets[i].count;
+        } else {
+            inliers += buckets[i].count;
+            sum += value * (double) buckets[i].count;
+        }
+    }
+
+    if (inliers == total) {
+        // 没有离群值时使用精确的平均值与标准差
+        stats->inlier_mean_ns =
+                (double) i_ezs_benchmark_timespec_to_ns(mean_duration(entry->sumDuration, entry->count));
+        stats->inlier_std_dev_ns =
+                (double) (sample_standard_deviation(entry->correctedSumSquaredDuration, entry->count) * 1e9L);
+    } else {
+        stats->inlier_mean_ns = sum / (double) inliers;
+        double squared_sum = 0.0;
+        for (size_t i = 0; i < count; i += 1) {
+            const double value = clamp_bucket_value(entry, buckets[i].value);
+            if (value >= low_mild && value <= high_mild) {
+                const double delta = value - stats->inlier_mean_ns;
+                squared_sum += delta * delta * (double) buckets[i].count;
+            }
+        }
+        stats->inlier_std_dev_ns = inliers > 1 ? sqrt(squared_sum / (double) (inliers - 1)) : 0.0;
+    }
+    free(buckets);
+    return true;
+}
+
 // BenchmarkEntry统计数值计算
 // 计算平均值、样本标准差和相对标准差
+// exclude_outliers为true时基于Tukey栅栏以内的样本计算
 // 返回false表示计算失败（count为0）
 static bool calculate_benchmark_statistics(const BenchmarkEntry *const entry,
+                                           const bool exclude_outliers,
                                            struct timespec *meanDuration,
                                            long double *sample_std_dev,
                                            long double *rel_std_dev) {
     if (0 == entry->count) {
         return false;
     }
-    *meanDuration = mean_duration(entry->sumDuration, entry->count);
-    *sample_std_dev = sample_standard_deviation(entry->correctedSumSquaredDuration, entry->count);
+    ezs_benchmark_robust_stats robust;
+    if (exclude_outliers && calculate_robust_statistics(entry, &robust)) {
+        *meanDuration = nanoseconds_to_timespec((uint64_t) llround(robust.inlier_mean_ns));
+        *sample_std_dev = (long double) robust.inlier_std_dev_ns / 1e9L;
+    } else {
+        *meanDuration = mean_duration(entry->sumDuration, entry->count);
+        *sample_std_dev = sample_standard_deviation(entry->correctedSumSquaredDuration, entry->count);
+    }
     *rel_std_dev = relative_standard_deviation(*sample_std_dev, *meanDuration);
     return true;
 }
 
+// 合并两份条目的统计数据，结果存入dst [Chan 并行方差合并]
+// 仅合并统计数据，不合并计时状态
+// src可以是其他线程分片中条目的快照，其直方图的分桶数组可能仍在被所属线程记录
+static void merge_benchmark_entry(BenchmarkEntry *dst, const BenchmarkEntry *src) {
+    if (0 == src->count) {
+        return;
+    }
+    if (!i_ezs_histogram_merge_snapshot(&dst->histogram, &src->histogram)) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Failed to allocate the histogram. Percentiles are unreliable.\n");
+    }
+    for (int kind = 0; kind < I_EZS_PERF_COUNTER_KINDS; kind += 1) {
+        dst->counterSum[kind] += src->counterSum[kind];
+    }
+    dst->counterCount += src->counterCount;
+    dst->counterEvents |= src->counterEvents;
+    // 以全0为起点累加，即直接相加
+    i_ezs_resource_usage_accumulate(&dst->usageSum, &(i_ezs_resource_usage){}, &src->usageSum);
+    dst->usageCount += src->usageCount;
+    dst->cpuThreadNs += src->cpuThreadNs;
+    dst->cpuProcessNs += src->cpuProcessNs;
+    dst->cpuWallNs += src->cpuWallNs;
+    dst->cpuCount += src->cpuCount;
+    dst->workCount += src->workCount;
+    dst->workItems += src->workItems;
+    dst->workBytes += src->workBytes;
+    dst->workNanoseconds += src->workNanoseconds;
+    dst->allocCalls += src->allocCalls;
+    dst->allocCount += src->allocCount;
+    dst->allocBytes += src->allocBytes;
+    if (src->allocPeakBytes > dst->allocPeakBytes) {
+        dst->allocPeakBytes = src->allocPeakBytes;
+    }
+    if (0 == dst->count) {
+        dst->count = src->count;
+        dst->minDuration = src->minDuration;
+        dst->maxDuration = src->maxDuration;
+        dst->sumDuration = src->sumDuration;
+        dst->correctedSumSquaredDuration = src->correctedSumSquaredDuration;
+        return;
+    }
+    const uint64_t count = dst->count + src->count;
+    const long double dstMean = ezs_clock_timespec_to_seconds(mean_duration(dst->sumDuration, dst->count));
+    const long double srcMean = ezs_clock_timespec_to_seconds(mean_duration(src->sumDuration, src->count));
+    const long double delta = srcMean - dstMean;
+    dst->correctedSumSquaredDuration += src->correctedSumSquaredDuration +
+            delta * delta * (long double) dst->count * (long double) src->count / (long double) count;
+    dst->count = count;
+    ezs_clock_timespec_add_eq(&dst->sumDuration, src->sumDuration);
+    if (ezs_clock_timespec_compare(src->minDuration, dst->minDuration) < 0) {
+        dst->minDuration = src->minDuration;
+    }
+    if (ezs_clock_timespec_compare(src->maxDuration, dst->maxDuration) > 0) {
+        dst->maxDuration = src->maxDuration;
+    }
+}
+
+// 将一次耗时计入条目的统计数据
+// 返回false表示直方图分配失败，该次耗时未计入分位数
+static bool update_benchmark_statistics(BenchmarkEntry *entry, const struct timespec duration) {
+    entry->count += 1;
+    const bool is_recorded = i_ezs_histogram_record(&entry->histogram, i_ezs_benchmark_timespec_to_ns(duration));
+
+    if (entry->count == 1) {
+        entry->minDuration = duration;
+        entry->maxDuration = duration;
+        entry->sumDuration = duration;
+        entry->correctedSumSquaredDuration = 0.0;
+        return is_recorded;
+    }
+
+    if (ezs_clock_timespec_compare(duration, entry->minDuration) < 0) {
+        entry->minDuration = duration;
+    } else if (ezs_clock_timespec_compare(duration, entry->maxDuration) > 0) {
+        entry->maxDuration = duration;
+    }
+
+    // 维护 corrected sum of squares [Welford 方差计算]
+    // 维护 sumDuration [时间总和]
+    const long double currentDurationInSeconds = ezs_clock_timespec_to_seconds(duration);
+    const struct timespec previousMean = ezs_clock_timespec_div(entry->sumDuration, entry->count - 1);
+    const long double previousMeanInSeconds = ezs_clock_timespec_to_seconds(previousMean);
+    const struct timespec currentSum = ezs_clock_timespec_add(entry->sumDuration, duration);
+    entry->sumDuration = currentSum;
+    const struct timespec currentMean = ezs_clock_timespec_div(currentSum, entry->count);
+    const long double currentMeanInSeconds = ezs_clock_timespec_to_seconds(currentMean);
+    entry->correctedSumSquaredDuration +=
+            (currentDurationInSeconds - previousMeanInSeconds) *
+            (currentDurationInSeconds - currentMeanInSeconds);
+    return is_recorded;
+}
+
 #define i_keypro cstr
-#define i_val BenchmarkEntry
+#define i_val ezs_benchmark_id
 #define i_tag bench
 #include <stc/smap.h>
 
-static smap_bench g_benchmarks = {};
+/*
+ * 多线程设计：
+ * 名称与句柄的注册表是全局的，由g_lock保护，注册只在每个名称首次出现时发生
+ * 计时数据记录在每个线程私有的分片（BenchmarkShard）中，start/end不需要加锁
+ * 分片在线程首次计时时创建，并挂到全局链表上，线程退出后其数据仍然保留
+ * 打印报告时在g_lock下合并所有分片的数据
+ *
+ * 同一条目的start与end必须在同一线程中调用
+ *
+ * 打印、查询与导出可以在其他线程计时的同时进行（实时发布线程就是如此）：
+ * 所属线程以每个条目的顺序锁（ShardEntry::sequence）包住对统计数据的更新，
+ * 合并时读取条目的快照，读到一半被更新时重试，因此不会读到撕裂的timespec或不一致的count与M2
+ * 直方图的分桶数组不在快照之内，合并时逐个读取计数，与count可能相差正在进行中的几次记录
+ * 调用树的节点计数没有加锁，同样可能相差正在进行中的几次调用
+ * 清除与释放操作会改写或释放其他线程的分片，仍然应当在其他线程停止计时后调用
+ */
+
+/*
+ * 嵌套区域：
+ * 每个分片维护本线程正在计时的区域栈，start时入栈，end时出栈
+ * 入栈时以栈顶区域为父节点，在本线程的调用树中找到（或创建）对应的节点
+ * end时将耗时计入该节点，并计入其父节点的子区域耗时，由此得到不含子区域的self耗时
+ *
+ * 区域通常按后进先出的顺序结束；提前结束的外层区域会直接从栈中移除，
+ * 其尚未结束的子区域仍然计入原来的父节点
+ *
+ * 启用堆分配追踪时，区域在start时记下本线程的分配计数，end时计算差值
+ * 子区域结束时把其分配计入父区域的子区域分配，由此把分配归属到最内层的区域
+ */
+
+// 正在计时的区域
+typedef struct {
+    ezs_benchmark_id id;
+    uint32_t node; // 调用树中的节点，I_EZS_CALL_TREE_NONE表示不在树中记录
+    i_ezs_alloc_counters allocStart; // start时本线程的分配计数
+    uint64_t childAllocCount; // 已结束的子区域的分配次数
+    uint64_t childAllocBytes; // 已结束的子区域的分配字节数
+    int64_t outerPeak; // start时外层的峰值，end时恢复
+} ActiveRegion;
+
+// 分片中的条目
+// 所属线程在更新统计数据前后各递增一次sequence，奇数表示正在更新，其他线程据此读取一致的快照
+typedef struct {
+    _Atomic uint32_t sequence;
+    BenchmarkEntry entry;
+} ShardEntry;
+
+// 每个线程私有的条目分片
+typedef struct BenchmarkShard {
+    ShardEntry *entries; // 以句柄为下标
+    ezs_benchmark_id capacity; // 仅在g_lock下增长，保证合并时不会被重新分配
+    smap_bench ids; // 本线程的名称到句柄的缓存，仅由所属线程访问
+    i_ezs_call_tree tree; // 本线程的调用树，仅在g_lock下加入节点
+    ActiveRegion *regions; // 正在计时的区域栈，仅由所属线程访问
+    uint32_t region_depth;
+    uint32_t region_capacity;
+    i_ezs_perf_group perf; // 本线程的硬件计数器，仅由所属线程访问
+    unsigned perf_requested; // 打开perf时请求的种类，与g_perf_events不同时重新打开
+    uint32_t thread_index; // 分片创建的顺序，用于区分样本来自哪个线程
+    ezs_benchmark_sample *samples; // 捕获模式下的环形缓冲区，所属线程写入，g_lock的持有者读取
+    size_t sample_capacity; // 仅在g_lock下改变
+    size_t sample_next; // 下一个样本写入的位置，仅由所属线程访问
+    _Atomic uint64_t sample_count; // 写入过的样本总数，仅由所属线程写入
+    uint64_t folded_sample_count; // 已计入统计数据的样本总数，由g_lock保护
+    BenchmarkEntry *captured; // 从环形缓冲区计入的统计数据，以句柄为下标，由g_lock保护
+    ezs_benchmark_id captured_capacity;
+    struct BenchmarkShard *next;
+} BenchmarkShard;
+
+static once_flag g_lock_once = ONCE_FLAG_INIT;
+static mtx_t g_lock;
+// 名称到句柄的映射
+static smap_bench g_benchmark_ids = {};
+// 以句柄为下标的条目名称
+static char **g_benchmark_names = nullptr;
+static ezs_benchmark_id g_benchmark_name_capacity = 0;
+static _Atomic ezs_benchmark_id g_benchmark_count = 0;
+// 所有线程的分片
+static BenchmarkShard *g_shards = nullptr;
+static uint32_t g_shard_count = 0;
+// 每次drop后递增，用于使各线程缓存的分片指针失效
+static atomic_uint_fast64_t g_generation = 1;
+static thread_local BenchmarkShard *t_shard = nullptr;
+static thread_local uint_fast64_t t_shard_generation = 0;
 #ifndef EZS_BENCHMARK_NO_AUTO_EXIT
 static bool g_is_atexit_registered = false;
 #endif
 
-void ezs_benchmark_clear(void) {
-    smap_bench_clear(&g_benchmarks);
+// 计时开销的校准结果，由g_lock保护
+static constexpr int CALIBRATION_WARMUP_ROUNDS = 1000;
+static constexpr int CALIBRATION_ROUNDS = 10000;
+// 校准所用的条目不在名称表中，因此不会出现在报告里
+static ezs_benchmark_id g_calibration_id = EZS_BENCHMARK_INVALID_ID;
+static bool g_is_calibrated = false;
+// 校准期间的计时不记录到调用树中，以免在调用校准的区域下出现隐藏的子区域
+static thread_local bool t_is_calibrating = false;
+// 本线程最内层的正在计时的区域，由采样分析器的信号处理函数读取
+// 使用initial-exec模型，保证在信号处理函数中访问时不会分配内存
+static thread_local __attribute__((tls_model("initial-exec"))) _Atomic ezs_benchmark_id t_active_region =
+        EZS_BENCHMARK_INVALID_ID;
+static uint64_t g_overhead_median_ns = 0;
+static uint64_t g_overhead_min_ns = 0;
+// 捕获模式下每个线程的环形缓冲区容量，0表示不启用捕获模式
+static _Atomic size_t g_capture_capacity = 0;
+// 未计入统计数据就被覆盖的样本数，由g_lock保护
+static uint64_t g_overwritten_sample_count = 0;
+// 启用的硬件计数器种类，0表示不启用
+static _Atomic unsigned g_perf_events = 0;
+
+static _Atomic bool g_exclude_outliers = false;
+
+static _Atomic bool g_resource_usage = false;
+
+static _Atomic bool g_cpu_time = false;
+#ifndef EZS_BENCHMARK_NO_AUTO_CALIBRATE
+static once_flag g_auto_calibrate_once = ONCE_FLAG_INIT;
+#endif
+
+static void init_lock(void) {
+    if (thrd_success != mtx_init(&g_lock, mtx_plain)) {
+        fprintf(stderr, "[EZS BENCHMARK][FATAL] "
+                "Failed to initialize the benchmark lock. Benchmark cannot proceed.\n");
+        exit(EXIT_FAILURE);
+    }
 }
 
-void ezs_benchmark_drop(void) {
-    smap_bench_drop(&g_benchmarks);
+static void lock(void) {
+    call_once(&g_lock_once, init_lock);
+    mtx_lock(&g_lock);
 }
 
-void ezs_benchmark_final_report(void) {
-    ezs_benchmark_print_all();
-    ezs_benchmark_drop();
+static void unlock(void) {
+    mtx_unlock(&g_lock);
 }
 
-void ezs_benchmark_start(const char *name) {
+// 将条目置为初始状态，保留直方图已分配的内存
+// 条目必须已经初始化过，新分配的条目应使用init_benchmark_entry
+static void reset_benchmark_entry(BenchmarkEntry *entry) {
+    i_ezs_histogram histogram = entry->histogram;
+    i_ezs_histogram_reset(&histogram);
+    *entry = (BenchmarkEntry){.histogram = histogram};
+    entry->idle = true;
+    entry->minDuration.tv_sec = INT64_MAX;
+    entry->minDuration.tv_nsec = 1000000000L - 1;
+}
+
+// 初始化新分配的条目
+static void init_benchmark_entry(BenchmarkEntry *entry) {
+    *entry = (BenchmarkEntry){0};
+    reset_benchmark_entry(entry);
+}
+
+// 释放条目占用的内存
+static void drop_benchmark_entry(BenchmarkEntry *entry) {
+    i_ezs_histogram_drop(&entry->histogram);
+}
+
+// 计算不小于required的容量
+static ezs_benchmark_id grow_capacity(const ezs_benchmark_id capacity, const ezs_benchmark_id required) {
+    ezs_benchmark_id new_capacity = capacity > 0 ? capacity : 16;
+    while (new_capacity < required) {
+        new_capacity *= 2;
+    }
+    return new_capacity;
+}
+
+// 查找已注册的句柄，未注册时返回EZS_BENCHMARK_INVALID_ID
+// 调用者需持有g_lock
+static ezs_benchmark_id find_benchmark_id(const char *name) {
+    auto const it = smap_bench_find(&g_benchmark_ids, name);
+    return it.ref != nullptr ? it.ref->second : EZS_BENCHMARK_INVALID_ID;
+}
+
+// 检查句柄是否有效
+static bool is_valid_benchmark_id(const ezs_benchmark_id id) {
+    return id < atomic_load_explicit(&g_benchmark_count, memory_order_acquire);
+}
+
+// 获取句柄对应的名称，用于输出错误信息
+// 名称字符串在drop之前不会被释放，因此可以在解锁后使用
+static const char *benchmark_name(const ezs_benchmark_id id) {
+    lock();
+    const char *name = id < g_benchmark_count ? g_benchmark_names[id] : "<unknown>";
+    unlock();
+    return name;
+}
+
+// 获取当前线程的分片，不存在时创建
+static BenchmarkShard *current_shard(void) {
+    const uint_fast64_t generation = atomic_load_explicit(&g_generation, memory_order_acquire);
+    if (nullptr != t_shard && t_shard_generation == generation) {
+        return t_shard;
+    }
+    BenchmarkShard *shard = calloc(1, sizeof(*shard));
+    if (nullptr == shard) {
+        fprintf(stderr, "[EZS BENCHMARK][FATAL] "
+                "Failed to allocate the benchmark shard of this thread. Benchmark cannot proceed.\n");
+        exit(EXIT_FAILURE);
+    }
+    i_ezs_call_tree_init(&shard->tree);
+    lock();
+    shard->thread_index = g_shard_count;
+    g_shard_count += 1;
+    shard->next = g_shards;
+    g_shards = shard;
+    t_shard_generation = atomic_load_explicit(&g_generation, memory_order_relaxed);
+    unlock();
+    t_shard = shard;
+    return shard;
+}
+
+// 获取分片中句柄为id的条目，id必须有效，shard必须是当前线程的分片
+static BenchmarkEntry *shard_entry(BenchmarkShard *shard, const ezs_benchmark_id id) {
+    if (id < shard->capacity) {
+        return &shard->entries[id].entry;
+    }
+    lock();
+    const ezs_benchmark_id new_capacity = grow_capacity(shard->capacity, id + 1);
+    ShardEntry *entries = realloc(shard->entries, new_capacity * sizeof(*entries));
+    if (nullptr == entries) {
+        unlock();
+        fprintf(stderr, "[EZS BENCHMARK][FATAL] "
+                "Failed to allocate benchmark entries. Benchmark cannot proceed.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (ezs_benchmark_id i = shard->capacity; i < new_capacity; i += 1) {
+        atomic_init(&entries[i].sequence, 0);
+        init_benchmark_entry(&entries[i].entry);
+    }
+    shard->entries = entries;
+    shard->capacity = new_capacity;
+    unlock();
+    return &shard->entries[id].entry;
+}
+
+// 所属线程开始更新分片中句柄为id的条目的统计数据
+// 更新期间不能获取g_lock，否则会与正在等待快照的合并相互等待
+static void begin_entry_update(BenchmarkShard *shard, const ezs_benchmark_id id) {
+    _Atomic uint32_t *sequence = &shard->entries[id].sequence;
+    atomic_store_explicit(sequence, atomic_load_explicit(sequence, memory_order_relaxed) + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+// 所属线程结束更新
+static void end_entry_update(BenchmarkShard *shard, const ezs_benchmark_id id) {
+    _Atomic uint32_t *sequence = &shard->entries[id].sequence;
+    atomic_store_explicit(sequence, atomic_load_explicit(sequence, memory_order_relaxed) + 1, memory_order_release);
+}
+
+// 读取分片条目的一致快照，所属线程正在更新时重试
+// 快照中的直方图与原条目共用分桶数组，只能用merge_benchmark_entry读取，不能释放
+// 调用者需持有g_lock
+static BenchmarkEntry snapshot_benchmark_entry(const ShardEntry *slot) {
+    BenchmarkEntry snapshot;
+    for (;;) {
+        const uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (0 == (sequence & 1)) {
+            memcpy(&snapshot, &slot->entry, sizeof(snapshot));
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&slot->sequence, memory_order_relaxed) == sequence) {
+                return snapshot;
+            }
+        }
+        thrd_yield();
+    }
+}
+
+/*
+ * 捕获模式：
+ * end只把(id, start, end)追加到本线程预先分配的环形缓冲区，不做任何统计
+ * 在合并条目（打印、查询、导出）时，才在g_lock下把尚未处理的样本计入分片的captured，
+ * 而不是所属线程的条目，因此合并不会与所属线程同时写同一份数据
+ *
+ * 环形缓冲区是单生产者单消费者的：所属线程写入样本后以release递增sample_count，
+ * g_lock的持有者以acquire读取sample_count后读取样本
+ * 所属线程写入第k + capacity个样本时会覆盖第k个样本，因此读取者读完样本后再检查一次sample_count，
+ * 样本在读取期间可能已被覆盖时丢弃读到的内容
+ * 缓冲区写满后覆盖最旧的样本，覆盖前未被处理的样本不会计入统计数据，只累计丢失的数量
+ * 所属线程不替被覆盖的样本计算统计数据，使end在任何时候都只有一次写入，也不会分配内存
+ */
+
+// 使分片的captured覆盖所有已分配的句柄
+// 调用者需持有g_lock
+static bool reserve_captured_entries(BenchmarkShard *shard) {
+    if (shard->captured_capacity >= shard->capacity) {
+        return true;
+    }
+    BenchmarkEntry *captured = realloc(shard->captured, shard->capacity * sizeof(*captured));
+    if (nullptr == captured) {
+        return false;
+    }
+    for (ezs_benchmark_id i = shard->captured_capacity; i < shard->capacity; i += 1) {
+        init_benchmark_entry(&captured[i]);
+    }
+    shard->captured = captured;
+    shard->captured_capacity = shard->capacity;
+    return true;
+}
+
+// 检查刚读取的第index个样本在读取期间是否可能已被所属线程覆盖
+// 必须在读取样本之后调用
+static bool is_sample_overwritten(const BenchmarkShard *shard, const uint64_t index) {
+    atomic_thread_fence(memory_order_acquire);
+    return index + shard->sample_capacity <= atomic_load_explicit(&shard->sample_count, memory_order_relaxed);
+}
+
+// 将分片中尚未处理的样本计入captured
+// 调用者需持有g_lock
+static void fold_captured_samples(BenchmarkShard *shard) {
+    const uint64_t count = atomic_load_explicit(&shard->sample_count, memory_order_acquire);
+    if (count == shard->folded_sample_count) {
+        return;
+    }
+    if (!reserve_captured_entries(shard)) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Failed to allocate entries for captured samples. Captured samples are not in the statistics yet.\n");
+        return;
+    }
+    uint64_t index = shard->folded_sample_count;
+    if (count - index > shard->sample_capacity) {
+        g_overwritten_sample_count += count - index - shard->sample_capacity;
+        index = count - shard->sample_capacity;
+    }
+    for (; index < count; index += 1) {
+        const ezs_benchmark_sample sample = shard->samples[index % shard->sample_capacity];
+        if (is_sample_overwritten(shard, index)) {
+            g_overwritten_sample_count += 1;
+            continue;
+        }
+        if (sample.id < shard->captured_capacity &&
+            !update_benchmark_statistics(&shard->captured[sample.id],
+                                         nanoseconds_to_timespec(sample.end_ns - sample.start_ns))) {
+            fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                    "Failed to allocate the histogram of benchmark item '%s'. Percentiles are unreliable.\n",
+                    g_benchmark_names[sample.id]);
+        }
+    }
+    // 只推进到开始时读到的总数，处理期间新追加的样本留到下一次
+    shard->folded_sample_count = count;
+}
+
+// 调用者需持有g_lock
+static void fold_all_captured_samples(void) {
+    for (BenchmarkShard *shard = g_shards; nullptr != shard; shard = shard->next) {
+        fold_captured_samples(shard);
+    }
+}
+
+// 按g_capture_capacity重新分配当前线程的环形缓冲区，原有的样本先计入统计数据
+static void resize_capture_buffer(BenchmarkShard *shard, const size_t capacity) {
+    lock();
+    fold_captured_samples(shard);
+    free(shard->samples);
+    shard->samples = nullptr;
+    shard->sample_capacity = 0;
+    shard->sample_next = 0;
+    atomic_store_explicit(&shard->sample_count, 0, memory_order_relaxed);
+    shard->folded_sample_count = 0;
+    if (capacity <= SIZE_MAX / sizeof(*shard->samples)) {
+        shard->samples = malloc(capacity * sizeof(*shard->samples));
+    }
+    if (nullptr != shard->samples) {
+        shard->sample_capacity = capacity;
+    }
+    unlock();
+    if (nullptr == shard->samples) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Failed to allocate the capture buffer of this thread. Falling back to immediate statistics.\n");
+    }
+}
+
+// 捕获模式下，在start时确保本线程的环形缓冲区已分配，使end不需要分配内存
+static void prepare_capture_buffer(BenchmarkShard *shard) {
+    const size_t capacity = atomic_load_explicit(&g_capture_capacity, memory_order_relaxed);
+    if (0 != capacity && shard->sample_capacity != capacity && !t_is_calibrating) {
+        resize_capture_buffer(shard, capacity);
+    }
+}
+
+// 捕获模式下将一次计时追加到本线程的环形缓冲区，返回是否已捕获
+static bool capture_sample(BenchmarkShard *shard, const ezs_benchmark_id id,
+                           const struct timespec startTime, const struct timespec endTime) {
+    if (0 == shard->sample_capacity || t_is_calibrating ||
+        0 == atomic_load_explicit(&g_capture_capacity, memory_order_relaxed)) {
+        return false;
+    }
+    const uint64_t count = atomic_load_explicit(&shard->sample_count, memory_order_relaxed);
+    // 与is_sample_overwritten配对：读取者读到了这次写入的内容时，也必然读到不小于count的sample_count
+    atomic_thread_fence(memory_order_release);
+    shard->samples[shard->sample_next] = (ezs_benchmark_sample){
+        .id = id,
+        .thread = shard->thread_index,
+        .start_ns = i_ezs_benchmark_timespec_to_ns(startTime),
+        .end_ns = i_ezs_benchmark_timespec_to_ns(endTime),
+    };
+    shard->sample_next = shard->sample_next + 1 == shard->sample_capacity ? 0 : shard->sample_next + 1;
+    atomic_store_explicit(&shard->sample_count, count + 1, memory_order_release);
+    return true;
+}
+
+// 合并所有分片中句柄为id的条目
+// 调用者需持有g_lock，并在使用完毕后调用drop_benchmark_entry释放结果
+static BenchmarkEntry merged_benchmark_entry(const ezs_benchmark_id id) {
+    fold_all_captured_samples();
+    BenchmarkEntry merged;
+    init_benchmark_entry(&merged);
+    for (const BenchmarkShard *shard = g_shards; nullptr != shard; shard = shard->next) {
+        if (id < shard->capacity) {
+            const BenchmarkEntry snapshot = snapshot_benchmark_entry(&shard->entries[id]);
+            merge_benchmark_entry(&merged, &snapshot);
+        }
+        if (id < shard->captured_capacity) {
+            merge_benchmark_entry(&merged, &shard->captured[id]);
+        }
+    }
+    return merged;
+}
+
+// 调用者需持有g_lock
+static void register_atexit_handler(void) {
 #ifndef EZS_BENCHMARK_NO_AUTO_EXIT
     if (!g_is_atexit_registered) {
         if (0 != atexit(ezs_benchmark_final_report)) {
@@ -85,24 +762,469 @@ void ezs_benchmark_start(const char *name) {
         g_is_atexit_registered = true;
     }
 #endif
-    auto const res = smap_bench_emplace(&g_benchmarks, name, (BenchmarkEntry){0});
-    BenchmarkEntry *entry = &res.ref->second;
+}
+
+void i_ezs_benchmark_register_atexit(void) {
+    lock();
+    register_atexit_handler();
+    unlock();
+}
+
+void ezs_benchmark_clear(void) {
+    i_ezs_benchmark_run_clear();
+    i_ezs_benchmark_scaling_clear();
+    i_ezs_benchmark_load_clear();
+    i_ezs_benchmark_instrument_clear();
+    i_ezs_benchmark_profile_clear();
+    atomic_store_explicit(&t_active_region, EZS_BENCHMARK_INVALID_ID, memory_order_relaxed);
+    lock();
+    for (BenchmarkShard *shard = g_shards; nullptr != shard; shard = shard->next) {
+        for (ezs_benchmark_id id = 0; id < shard->capacity; id += 1) {
+            reset_benchmark_entry(&shard->entries[id].entry);
+        }
+        for (ezs_benchmark_id id = 0; id < shard->captured_capacity; id += 1) {
+            reset_benchmark_entry(&shard->captured[id]);
+        }
+        i_ezs_call_tree_reset(&shard->tree);
+        shard->region_depth = 0;
+        shard->sample_next = 0;
+        atomic_store_explicit(&shard->sample_count, 0, memory_order_relaxed);
+        shard->folded_sample_count = 0;
+    }
+    g_overwritten_sample_count = 0;
+    unlock();
+}
+
+void ezs_benchmark_drop(void) {
+    // 先停止发布，发布线程会读取所有条目
+    ezs_benchmark_live_stop();
+    i_ezs_benchmark_run_clear();
+    i_ezs_benchmark_scaling_clear();
+    i_ezs_benchmark_load_clear();
+    i_ezs_benchmark_instrument_clear();
+    // 先停止采样，样本中的区域在名称释放后不再有效
+    i_ezs_benchmark_profile_drop();
+    atomic_store_explicit(&t_active_region, EZS_BENCHMARK_INVALID_ID, memory_order_relaxed);
+    lock();
+    while (nullptr != g_shards) {
+        BenchmarkShard *next = g_shards->next;
+        for (ezs_benchmark_id id = 0; id < g_shards->capacity; id += 1) {
+            drop_benchmark_entry(&g_shards->entries[id].entry);
+        }
+        for (ezs_benchmark_id id = 0; id < g_shards->captured_capacity; id += 1) {
+            drop_benchmark_entry(&g_shards->captured[id]);
+        }
+        free(g_shards->captured);
+        smap_bench_drop(&g_shards->ids);
+        i_ezs_call_tree_drop(&g_shards->tree);
+        i_ezs_perf_group_close(&g_shards->perf);
+        free(g_shards->samples);
+        free(g_shards->regions);
+        free(g_shards->entries);
+        free(g_shards);
+        g_shards = next;
+    }
+    smap_bench_drop(&g_benchmark_ids);
+    g_benchmark_ids = (smap_bench){};
+    const ezs_benchmark_id count = atomic_load_explicit(&g_benchmark_count, memory_order_relaxed);
+    for (ezs_benchmark_id id = 0; id < count; id += 1) {
+        free(g_benchmark_names[id]);
+    }
+    free(g_benchmark_names);
+    g_benchmark_names = nullptr;
+    g_benchmark_name_capacity = 0;
+    g_calibration_id = EZS_BENCHMARK_INVALID_ID;
+    g_shard_count = 0;
+    g_overwritten_sample_count = 0;
+    atomic_store_explicit(&g_benchmark_count, 0, memory_order_release);
+    atomic_fetch_add_explicit(&g_generation, 1, memory_order_acq_rel);
+    unlock();
+}
+
+void ezs_benchmark_final_report(void) {
+    ezs_benchmark_print_all();
+    ezs_benchmark_drop();
+}
+
+// 分配一个新的句柄，listed为false时该条目不加入名称表，也就不会出现在报告中
+// 调用者需持有g_lock，失败时返回EZS_BENCHMARK_INVALID_ID
+static ezs_benchmark_id add_benchmark(const char *name, const bool listed) {
+    const ezs_benchmark_id id = atomic_load_explicit(&g_benchmark_count, memory_order_relaxed);
+    if (EZS_BENCHMARK_INVALID_ID - 1 <= id) {
+        return EZS_BENCHMARK_INVALID_ID;
+    }
+    if (id >= g_benchmark_name_capacity) {
+        const ezs_benchmark_id new_capacity = grow_capacity(g_benchmark_name_capacity, id + 1);
+        char **names = realloc(g_benchmark_names, new_capacity * sizeof(*names));
+        if (nullptr == names) {
+            return EZS_BENCHMARK_INVALID_ID;
+        }
+        g_benchmark_names = names;
+        g_benchmark_name_capacity = new_capacity;
+    }
+    char *name_copy = strdup(name);
+    if (nullptr == name_copy) {
+        return EZS_BENCHMARK_INVALID_ID;
+    }
+    g_benchmark_names[id] = name_copy;
+    if (listed) {
+        smap_bench_emplace(&g_benchmark_ids, name, id);
+    }
+    atomic_store_explicit(&g_benchmark_count, id + 1, memory_order_release);
+    return id;
+}
+
+ezs_benchmark_id ezs_benchmark_register(const char *name) {
+    lock();
+    register_atexit_handler();
+    ezs_benchmark_id id = find_benchmark_id(name);
+    if (EZS_BENCHMARK_INVALID_ID == id) {
+        id = add_benchmark(name, true);
+    }
+    unlock();
+    if (EZS_BENCHMARK_INVALID_ID == id) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to register benchmark item '%s'.\n", name);
+        return EZS_BENCHMARK_INVALID_ID;
+    }
+#ifndef EZS_BENCHMARK_NO_AUTO_CALIBRATE
+    call_once(&g_auto_calibrate_once, ezs_benchmark_calibrate);
+#endif
+    return id;
+}
+
+void ezs_benchmark_calibrate(void) {
+    lock();
+    if (EZS_BENCHMARK_INVALID_ID == g_calibration_id) {
+        g_calibration_id = add_benchmark("[EZS] timer overhead", false);
+    }
+    const ezs_benchmark_id id = g_calibration_id;
+    unlock();
+    if (EZS_BENCHMARK_INVALID_ID == id) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to register the calibration item. Timer overhead is not measured.\n");
+        return;
+    }
+
+    // 与用户代码走完全相同的start_id/end_id路径，两次读取时钟之间的一切都计入开销
+    BenchmarkShard *shard = current_shard();
+    BenchmarkEntry *entry = shard_entry(shard, id);
+    t_is_calibrating = true;
+    for (int i = 0; i < CALIBRATION_WARMUP_ROUNDS; i += 1) {
+        ezs_benchmark_start_id(id);
+        ezs_benchmark_end_id(id);
+    }
+    begin_entry_update(shard, id);
+    reset_benchmark_entry(entry);
+    end_entry_update(shard, id);
+    for (int i = 0; i < CALIBRATION_ROUNDS; i += 1) {
+        ezs_benchmark_start_id(id);
+        ezs_benchmark_end_id(id);
+    }
+    t_is_calibrating = false;
+
+    lock();
+    g_overhead_median_ns = entry_percentile(entry, 50.0);
+    g_overhead_min_ns = i_ezs_benchmark_timespec_to_ns(entry->minDuration);
+    g_is_calibrated = true;
+    unlock();
+    begin_entry_update(shard, id);
+    reset_benchmark_entry(entry);
+    end_entry_update(shard, id);
+}
+
+bool ezs_benchmark_timer_overhead(struct timespec *median, struct timespec *min) {
+    lock();
+    const bool is_calibrated = g_is_calibrated;
+    if (is_calibrated) {
+        if (nullptr != median) {
+            *median = nanoseconds_to_timespec(g_overhead_median_ns);
+        }
+        if (nullptr != min) {
+            *min = nanoseconds_to_timespec(g_overhead_min_ns);
+        }
+    }
+    unlock();
+    return is_calibrated;
+}
+
+// 获取名为name的条目的句柄，优先使用当前线程的缓存
+// 未注册且create为true时注册该名称
+static ezs_benchmark_id resolve_benchmark_id(const char *name, const bool create) {
+    BenchmarkShard *shard = current_shard();
+    auto const cached = smap_bench_find(&shard->ids, name);
+    if (cached.ref != nullptr) {
+        return cached.ref->second;
+    }
+    ezs_benchmark_id id = EZS_BENCHMARK_INVALID_ID;
+    if (create) {
+        id = ezs_benchmark_register(name);
+    } else {
+        lock();
+        id = find_benchmark_id(name);
+        unlock();
+    }
+    if (EZS_BENCHMARK_INVALID_ID != id) {
+        smap_bench_emplace(&shard->ids, name, id);
+    }
+    return id;
+}
+
+// 按g_perf_events打开当前线程的硬件计数器，失败时打印警告
+static void open_perf_counters(BenchmarkShard *shard, const unsigned events) {
+    i_ezs_perf_group_close(&shard->perf);
+    shard->perf_requested = events;
+    if (0 != events && !i_ezs_perf_group_open(&shard->perf, events)) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Hardware performance counters are unavailable in this thread "
+                "(check /proc/sys/kernel/perf_event_paranoid). Falling back to time only.\n");
+    }
+}
+
+// 读取当前线程的硬件计数器，未启用或不可用时返回false
+static bool read_perf_counters(BenchmarkShard *shard, uint64_t values[I_EZS_PERF_COUNTER_KINDS]) {
+    const unsigned events = atomic_load_explicit(&g_perf_events, memory_order_relaxed);
+    if (0 == events) {
+        return false;
+    }
+    if (shard->perf_requested != events) {
+        open_perf_counters(shard, events);
+    }
+    return i_ezs_perf_group_read(&shard->perf, values);
+}
+
+// 将本次计时的硬件计数器增量计入条目
+static void record_perf_counters(BenchmarkShard *shard, BenchmarkEntry *entry) {
+    if (!entry->hasCounterStart) {
+        return;
+    }
+    entry->hasCounterStart = false;
+    uint64_t values[I_EZS_PERF_COUNTER_KINDS];
+    if (!read_perf_counters(shard, values)) {
+        return;
+    }
+    // 计时期间计数器被重新打开时，读数会从0重新开始，此时丢弃本次数据
+    for (int kind = 0; kind < I_EZS_PERF_COUNTER_KINDS; kind += 1) {
+        if (values[kind] < entry->counterStart[kind]) {
+            return;
+        }
+    }
+    for (int kind = 0; kind < I_EZS_PERF_COUNTER_KINDS; kind += 1) {
+        entry->counterSum[kind] += values[kind] - entry->counterStart[kind];
+    }
+    entry->counterCount += 1;
+    entry->counterEvents |= shard->perf.events;
+}
+
+static void record_resource_usage(BenchmarkEntry *entry) {
+    if (!entry->hasUsageStart) {
+        return;
+    }
+    entry->hasUsageStart = false;
+    i_ezs_resource_usage usage;
+    if (i_ezs_resource_usage_read(&usage) &&
+        i_ezs_resource_usage_accumulate(&entry->usageSum, &entry->usageStart, &usage)) {
+        entry->usageCount += 1;
+    }
+}
+
+bool ezs_benchmark_enable_resource_usage(const bool enable) {
+    i_ezs_resource_usage usage;
+    if (enable && !i_ezs_resource_usage_read(&usage)) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Per-thread resource usage is unavailable on this platform. Falling back to time only.\n");
+        atomic_store_explicit(&g_resource_usage, false, memory_order_relaxed);
+        return false;
+    }
+    atomic_store_explicit(&g_resource_usage, enable, memory_order_relaxed);
+    return enable;
+}
+
+// duration为本次计时的耗时（纳秒）
+static void record_cpu_time(BenchmarkEntry *entry, const uint64_t duration) {
+    if (!entry->hasCpuStart) {
+        return;
+    }
+    entry->hasCpuStart = false;
+    i_ezs_cpu_time time;
+    if (!i_ezs_cpu_time_read(&time) || time.thread_ns < entry->cpuStart.thread_ns ||
+        time.process_ns < entry->cpuStart.process_ns) {
+        return;
+    }
+    entry->cpuThreadNs += time.thread_ns - entry->cpuStart.thread_ns;
+    entry->cpuProcessNs += time.process_ns - entry->cpuStart.process_ns;
+    entry->cpuWallNs += duration;
+    entry->cpuCount += 1;
+}
+
+bool ezs_benchmark_enable_cpu_time(const bool enable) {
+    i_ezs_cpu_time time;
+    if (enable && !i_ezs_cpu_time_read(&time)) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "CPU time clocks are unavailable on this platform. Falling back to wall time only.\n");
+        atomic_store_explicit(&g_cpu_time, false, memory_order_relaxed);
+        return false;
+    }
+    atomic_store_explicit(&g_cpu_time, enable, memory_order_relaxed);
+    return enable;
+}
+
+bool ezs_benchmark_enable_perf_counters(const unsigned events) {
+    const unsigned requested = events & EZS_BENCHMARK_PERF_ALL;
+    if (0 == requested) {
+        atomic_store_explicit(&g_perf_events, 0, memory_order_relaxed);
+        return false;
+    }
+    // 先在当前线程中试探，避免在所有线程中反复失败
+    BenchmarkShard *shard = current_shard();
+    i_ezs_perf_group_close(&shard->perf);
+    if (!i_ezs_perf_group_open(&shard->perf, requested)) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Hardware performance counters are unavailable "
+                "(check /proc/sys/kernel/perf_event_paranoid). Falling back to time only.\n");
+        shard->perf_requested = 0;
+        atomic_store_explicit(&g_perf_events, 0, memory_order_relaxed);
+        return false;
+    }
+    if (shard->perf.events != requested) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Some hardware performance counters are unavailable and will be reported as N/A.\n");
+    }
+    shard->perf_requested = requested;
+    atomic_store_explicit(&g_perf_events, requested, memory_order_relaxed);
+    return true;
+}
+
+// 将句柄为id的区域压入当前线程的区域栈，返回压入的区域，未压入时返回nullptr
+static ActiveRegion *push_region(BenchmarkShard *shard, const ezs_benchmark_id id) {
+    if (t_is_calibrating) {
+        return nullptr;
+    }
+    if (shard->region_depth == shard->region_capacity) {
+        const uint32_t new_capacity = shard->region_capacity > 0 ? shard->region_capacity * 2 : 16;
+        ActiveRegion *regions = realloc(shard->regions, new_capacity * sizeof(*regions));
+        if (nullptr == regions) {
+            fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                    "Failed to allocate the region stack. Benchmark item '%s' is not recorded in the call tree.\n",
+                    benchmark_name(id));
+            return nullptr;
+        }
+        shard->regions = regions;
+        shard->region_capacity = new_capacity;
+    }
+
+    // 父区域不在树中记录时，子区域也无法确定路径
+    uint32_t node = I_EZS_CALL_TREE_NONE;
+    const uint32_t parent = shard->region_depth > 0
+                                ? shard->regions[shard->region_depth - 1].node
+                                : I_EZS_CALL_TREE_NONE;
+    if (0 == shard->region_depth || I_EZS_CALL_TREE_NONE != parent) {
+        node = i_ezs_call_tree_find_child(&shard->tree, parent, id);
+        if (I_EZS_CALL_TREE_NONE == node) {
+            // 合并时会读取各分片的调用树，因此加入节点需要持有g_lock
+            lock();
+            node = i_ezs_call_tree_add_child(&shard->tree, parent, id);
+            unlock();
+            if (I_EZS_CALL_TREE_NONE == node) {
+                fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                        "Failed to allocate the call tree. Benchmark item '%s' is not recorded in the call tree.\n",
+                        benchmark_name(id));
+            }
+        }
+    }
+    shard->regions[shard->region_depth] = (ActiveRegion){.id = id, .node = node};
+    shard->region_depth += 1;
+    atomic_store_explicit(&t_active_region, id, memory_order_relaxed);
+    return &shard->regions[shard->region_depth - 1];
+}
+
+// 开始统计区域的堆分配，应在读取开始时间之前最后调用，使计时本身的分配不计入区域
+static void begin_region_allocations(ActiveRegion *region) {
+    region->outerPeak = i_ezs_alloc_tracker_begin_peak();
+    i_ezs_alloc_tracker_read(&region->allocStart);
+}
+
+// 结束统计区域的堆分配，把不含子区域的分配计入entry，并把包含子区域的分配计入父区域parent
+static void end_region_allocations(const ActiveRegion *region, ActiveRegion *parent, BenchmarkEntry *entry) {
+    i_ezs_alloc_counters end;
+    i_ezs_alloc_tracker_read(&end);
+    i_ezs_alloc_tracker_end_peak(region->outerPeak);
+    const uint64_t count = end.count - region->allocStart.count;
+    const uint64_t bytes = end.bytes - region->allocStart.bytes;
+    const int64_t peak = end.peak - region->allocStart.live;
+    entry->allocCalls += 1;
+    entry->allocCount += count - region->childAllocCount;
+    entry->allocBytes += bytes - region->childAllocBytes;
+    if (peak > 0 && (uint64_t) peak > entry->allocPeakBytes) {
+        entry->allocPeakBytes = (uint64_t) peak;
+    }
+    if (nullptr != parent) {
+        parent->childAllocCount += count;
+        parent->childAllocBytes += bytes;
+    }
+}
+
+// 将句柄为id的区域从当前线程的区域栈中移除，并把耗时计入调用树，分配计入entry
+static void pop_region(BenchmarkShard *shard, const ezs_benchmark_id id, const uint64_t duration_ns,
+                       BenchmarkEntry *entry) {
+    // 通常就是栈顶，提前结束的外层区域需要向下查找
+    for (uint32_t i = shard->region_depth; i > 0; i -= 1) {
+        if (shard->regions[i - 1].id != id) {
+            continue;
+        }
+        const ActiveRegion region = shard->regions[i - 1];
+        memmove(&shard->regions[i - 1], &shard->regions[i], (shard->region_depth - i) * sizeof(*shard->regions));
+        shard->region_depth -= 1;
+        atomic_store_explicit(&t_active_region,
+                              shard->region_depth > 0
+                                  ? shard->regions[shard->region_depth - 1].id
+                                  : EZS_BENCHMARK_INVALID_ID,
+                              memory_order_relaxed);
+        if (I_EZS_ALLOC_TRACKING) {
+            end_region_allocations(&region, i > 1 ? &shard->regions[i - 2] : nullptr, entry);
+        }
+        if (I_EZS_CALL_TREE_NONE != region.node) {
+            i_ezs_call_tree_record(&shard->tree, region.node, duration_ns);
+        }
+        return;
+    }
+}
 
-    // 如果是新创建的条目，进行初始化
-    if (res.inserted) {
-        entry->idle = true;
-        entry->minDuration.tv_sec = INT64_MAX;
-        entry->minDuration.tv_nsec = 1000000000L - 1;
+// 句柄为id的benchmark开始计时
+// 启用堆分配追踪时，本线程的分配计数会恢复为allocations，使计时本身的分配不计入任何区域
+static void start_benchmark_id(const ezs_benchmark_id id, const i_ezs_alloc_counters *allocations) {
+    if (!is_valid_benchmark_id(id)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Benchmark id %" PRIu32 " is not registered. "
+                "Ignoring this call.\n", id);
+        return;
     }
+    BenchmarkShard *shard = current_shard();
+    BenchmarkEntry *entry = shard_entry(shard, id);
 
     // 状态检查
-    else if (!entry->idle) {
+    if (!entry->idle) {
         fprintf(stderr, "[EZS BENCHMARK][ERROR] "
                 "Benchmark item '%s' was started twice without being ended. "
-                "Ignoring this call.\n", name);
+                "Ignoring this call.\n", benchmark_name(id));
         return;
     }
     entry->idle = false;
+    ActiveRegion *region = push_region(shard, id);
+    prepare_capture_buffer(shard);
+    i_ezs_benchmark_profile_prepare_thread();
+    if (I_EZS_ALLOC_TRACKING) {
+        i_ezs_alloc_tracker_restore(allocations);
+        if (nullptr != region) {
+            begin_region_allocations(region);
+        }
+    }
+    // 先读取计数器再读取时钟，读取计数器的开销不计入耗时
+    entry->hasCounterStart = read_perf_counters(shard, entry->counterStart);
+    entry->hasUsageStart = atomic_load_explicit(&g_resource_usage, memory_order_relaxed) &&
+                           i_ezs_resource_usage_read(&entry->usageStart);
+    entry->hasCpuStart = atomic_load_explicit(&g_cpu_time, memory_order_relaxed) &&
+                         i_ezs_cpu_time_read(&entry->cpuStart);
     // 记录开始时间并更新状态
     if (!ezs_clock_get_performance_counter(&entry->lastTime, nullptr, 0)) {
         fprintf(stderr, "[EZS BENCHMARK][FATAL] "
@@ -111,7 +1233,74 @@ void ezs_benchmark_start(const char *name) {
     }
 }
 
-void ezs_benchmark_end(const char *name) {
+ezs_benchmark_id i_ezs_benchmark_active_region(void) {
+    return atomic_load_explicit(&t_active_region, memory_order_relaxed);
+}
+
+void i_ezs_benchmark_prepare_thread(const ezs_benchmark_id id) {
+    if (!is_valid_benchmark_id(id)) {
+        return;
+    }
+    BenchmarkShard *shard = current_shard();
+    shard_entry(shard, id);
+    prepare_capture_buffer(shard);
+    i_ezs_benchmark_profile_prepare_thread();
+}
+
+void ezs_benchmark_start_id(const ezs_benchmark_id id) {
+    i_ezs_alloc_counters allocations = {};
+    i_ezs_alloc_tracker_read(&allocations);
+    start_benchmark_id(id, &allocations);
+}
+
+// 以endTime作为结束时间，记录句柄为id的条目的一次计时
+// work不为nullptr时同时记录本次处理的工作量
+static void record_benchmark_end(const ezs_benchmark_id id, const struct timespec endTime,
+                                 const BenchmarkWork *work) {
+    BenchmarkShard *shard = current_shard();
+    BenchmarkEntry *entry = shard_entry(shard, id);
+
+    const struct timespec duration = ezs_clock_timespec_sub(endTime, entry->lastTime);
+
+    // 状态检查
+    if (entry->idle) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Benchmark item '%s' was ended twice without being started. "
+                "Ignoring this call.\n", benchmark_name(id));
+        return;
+    }
+
+    // 更新统计数据，其他线程可能正在读取本条目的快照
+    begin_entry_update(shard, id);
+    entry->idle = true;
+    record_perf_counters(shard, entry);
+    record_resource_usage(entry);
+    record_cpu_time(entry, i_ezs_benchmark_timespec_to_ns(duration));
+    pop_region(shard, id, i_ezs_benchmark_timespec_to_ns(duration), entry);
+    // 之后更新统计数据时的分配不计入任何区域
+    i_ezs_alloc_counters allocations = {};
+    i_ezs_alloc_tracker_read(&allocations);
+    // 工作量只需累加，捕获模式下也直接计入条目
+    if (nullptr != work) {
+        entry->workCount += 1;
+        entry->workItems += work->items;
+        entry->workBytes += work->bytes;
+        entry->workNanoseconds += i_ezs_benchmark_timespec_to_ns(duration);
+    }
+    const bool is_captured = capture_sample(shard, id, entry->lastTime, endTime);
+    const bool is_recorded = is_captured || update_benchmark_statistics(entry, duration);
+    end_entry_update(shard, id);
+    // benchmark_name需要获取g_lock，只能在更新结束后调用
+    if (!is_recorded) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Failed to allocate the histogram of benchmark item '%s'. Percentiles are unreliable.\n",
+                benchmark_name(id));
+    }
+    i_ezs_alloc_tracker_restore(&allocations);
+}
+
+// 句柄为id的条目结束计时，work不为nullptr时同时记录工作量
+static void end_benchmark_id(const ezs_benchmark_id id, const BenchmarkWork *work) {
     struct timespec endTime = {};
     if (!ezs_clock_get_performance_counter(&endTime, nullptr, 0)) {
         fprintf(stderr, "[EZS BENCHMARK][FATAL] "
@@ -119,68 +1308,291 @@ void ezs_benchmark_end(const char *name) {
         return;
     }
 
-    // 查找条目
-    auto const it = smap_bench_find(&g_benchmarks, name);
-    if (it.ref == nullptr) {
+    if (!is_valid_benchmark_id(id)) {
         fprintf(stderr, "[EZS BENCHMARK][ERROR] "
-                "Benchmark item '%s' was ended without being started. "
-                "Ignoring this call.\n", name);
+                "Benchmark id %" PRIu32 " is not registered. "
+                "Ignoring this call.\n", id);
         return;
     }
+    record_benchmark_end(id, endTime, work);
+}
 
-    BenchmarkEntry *entry = &it.ref->second;
+void ezs_benchmark_end_id(const ezs_benchmark_id id) {
+    end_benchmark_id(id, nullptr);
+}
 
-    const struct timespec duration = ezs_clock_timespec_sub(endTime, entry->lastTime);
+void ezs_benchmark_end_id_with_work(const ezs_benchmark_id id, const uint64_t items, const uint64_t bytes) {
+    end_benchmark_id(id, &(const BenchmarkWork){.items = items, .bytes = bytes});
+}
 
-    // 状态检查
-    if (entry->idle) {
+void ezs_benchmark_start(const char *name) {
+    // 首次查找时注册与缓存名称的分配也不计入任何区域
+    i_ezs_alloc_counters allocations = {};
+    i_ezs_alloc_tracker_read(&allocations);
+    const ezs_benchmark_id id = resolve_benchmark_id(name, true);
+    if (EZS_BENCHMARK_INVALID_ID == id) {
+        return;
+    }
+    start_benchmark_id(id, &allocations);
+}
+
+// 条目为name的benchmark结束计时，work不为nullptr时同时记录工作量
+static void end_benchmark(const char *name, const BenchmarkWork *work) {
+    // 先取结束时间再查找条目，查找的开销不计入本次计时
+    struct timespec endTime = {};
+    if (!ezs_clock_get_performance_counter(&endTime, nullptr, 0)) {
+        fprintf(stderr, "[EZS BENCHMARK][FATAL] "
+                "Failed to get high-resolution time. Benchmark cannot proceed.\n");
+        return;
+    }
+
+    // 查找条目
+    const ezs_benchmark_id id = resolve_benchmark_id(name, false);
+    if (EZS_BENCHMARK_INVALID_ID == id) {
         fprintf(stderr, "[EZS BENCHMARK][ERROR] "
-                "Benchmark item '%s' was ended twice without being started. "
+                "Benchmark item '%s' was ended without being started. "
                 "Ignoring this call.\n", name);
         return;
     }
+    record_benchmark_end(id, endTime, work);
+}
 
-    // 更新统计数据
-    entry->idle = true;
-    entry->count += 1;
+void ezs_benchmark_end(const char *name) {
+    end_benchmark(name, nullptr);
+}
 
-    if (entry->count == 1) {
-        entry->minDuration = duration;
-        entry->maxDuration = duration;
-        entry->sumDuration = duration;
-        entry->correctedSumSquaredDuration = 0.0;
-        return;
+void ezs_benchmark_end_with_work(const char *name, const uint64_t items, const uint64_t bytes) {
+    end_benchmark(name, &(const BenchmarkWork){.items = items, .bytes = bytes});
+}
+
+void ezs_benchmark_enable_capture(const size_t samples_per_thread) {
+    atomic_store_explicit(&g_capture_capacity, samples_per_thread, memory_order_relaxed);
+}
+
+size_t ezs_benchmark_samples(ezs_benchmark_sample *samples, const size_t capacity) {
+    lock();
+    size_t total = 0;
+    for (const BenchmarkShard *shard = g_shards; nullptr != shard; shard = shard->next) {
+        const uint64_t count = atomic_load_explicit(&shard->sample_count, memory_order_acquire);
+        // 缓冲区中保留的是最近的sample_capacity个样本，从最旧的开始
+        uint64_t index = count > shard->sample_capacity ? count - shard->sample_capacity : 0;
+        for (; index < count; index += 1) {
+            const ezs_benchmark_sample sample = shard->samples[index % shard->sample_capacity];
+            if (is_sample_overwritten(shard, index)) {
+                continue;
+            }
+            if (nullptr != samples && total < capacity) {
+                samples[total] = sample;
+            }
+            total += 1;
+        }
     }
+    unlock();
+    return total;
+}
 
-    if (ezs_clock_timespec_compare(duration, entry->minDuration) < 0) {
-        entry->minDuration = duration;
-    } else if (ezs_clock_timespec_compare(duration, entry->maxDuration) > 0) {
-        entry->maxDuration = duration;
+const char *ezs_benchmark_name(const ezs_benchmark_id id) {
+    lock();
+    const char *name = id < g_benchmark_count && id != g_calibration_id ? g_benchmark_names[id] : nullptr;
+    unlock();
+    return name;
+}
+
+bool ezs_benchmark_percentile_id(const ezs_benchmark_id id, const double percentile, struct timespec *value) {
+    lock();
+    if (id >= g_benchmark_count) {
+        unlock();
+        return false;
+    }
+    BenchmarkEntry merged = merged_benchmark_entry(id);
+    const bool has_data = merged.count > 0;
+    if (has_data) {
+        *value = nanoseconds_to_timespec(entry_percentile(&merged, percentile));
     }
+    drop_benchmark_entry(&merged);
+    unlock();
+    return has_data;
+}
 
-    // 维护 corrected sum of squares [Welford 方差计算]
-    // 维护 sumDuration [时间总和]
-    const long double currentDurationInSeconds = ezs_clock_timespec_to_seconds(duration);
-    const struct timespec previousMean = ezs_clock_timespec_div(entry->sumDuration, entry->count - 1);
-    const long double previousMeanInSeconds = ezs_clock_timespec_to_seconds(previousMean);
-    const struct timespec currentSum = ezs_clock_timespec_add(entry->sumDuration, duration);
-    entry->sumDuration = currentSum;
-    const struct timespec currentMean = ezs_clock_timespec_div(currentSum, entry->count);
-    const long double currentMeanInSeconds = ezs_clock_timespec_to_seconds(currentMean);
-    entry->correctedSumSquaredDuration +=
-            (currentDurationInSeconds - previousMeanInSeconds) *
-            (currentDurationInSeconds - currentMeanInSeconds);
+bool ezs_benchmark_percentile(const char *name, const double percentile, struct timespec *value) {
+    lock();
+    const ezs_benchmark_id id = find_benchmark_id(name);
+    unlock();
+    return EZS_BENCHMARK_INVALID_ID != id && ezs_benchmark_percentile_id(id, percentile, value);
+}
+
+bool ezs_benchmark_robust_statistics_id(const ezs_benchmark_id id, ezs_benchmark_robust_stats *stats) {
+    lock();
+    if (id >= g_benchmark_count) {
+        unlock();
+        return false;
+    }
+    BenchmarkEntry merged = merged_benchmark_entry(id);
+    const bool has_data = merged.count > 0 && calculate_robust_statistics(&merged, stats);
+    drop_benchmark_entry(&merged);
+    unlock();
+    return has_data;
+}
+
+bool ezs_benchmark_robust_statistics(const char *name, ezs_benchmark_robust_stats *stats) {
+    lock();
+    const ezs_benchmark_id id = find_benchmark_id(name);
+    unlock();
+    return EZS_BENCHMARK_INVALID_ID != id && ezs_benchmark_robust_statistics_id(id, stats);
+}
+
+void ezs_benchmark_exclude_outliers(const bool exclude) {
+    atomic_store_explicit(&g_exclude_outliers, exclude, memory_order_relaxed);
+}
+
+ezs_benchmark_id i_ezs_benchmark_scope_enter(_Atomic uint64_t *cache, const char *name) {
+    // 缓存的高32位是注册时g_generation的低32位，低32位是句柄
+    // g_generation从1开始，因此初始值0不会命中；drop之后代数改变，缓存随之失效
+    // 多个线程同时注册时会得到同一个句柄，因此这里的竞争是良性的
+    const uint32_t generation = (uint32_t) atomic_load_explicit(&g_generation, memory_order_acquire);
+    const uint64_t cached = atomic_load_explicit(cache, memory_order_relaxed);
+    ezs_benchmark_id id = (ezs_benchmark_id) cached;
+    if (cached >> 32 != generation) {
+        id = ezs_benchmark_register(name);
+        if (EZS_BENCHMARK_INVALID_ID == id) {
+            // 注册失败时不缓存，下次执行时重试
+            return EZS_BENCHMARK_INVALID_ID;
+        }
+        atomic_store_explicit(cache, (uint64_t) generation << 32 | id, memory_order_relaxed);
+    }
+    ezs_benchmark_start_id(id);
+    return id;
+}
+
+void i_ezs_benchmark_scope_exit(const ezs_benchmark_id *id) {
+    // 注册失败时没有开始计时，ezs_benchmark_register已经报告过错误
+    if (EZS_BENCHMARK_INVALID_ID != *id) {
+        ezs_benchmark_end_id(*id);
+    }
+}
+
+/*---------------------------EZS_BENCHMARK 统计摘要---------------------------*/
+
+// 由合并后的条目生成摘要，name由调用者复制
+// 调用者需持有g_lock
+static i_ezs_benchmark_summary summarize_benchmark_entry(const BenchmarkEntry *entry) {
+    i_ezs_benchmark_summary summary = {.count = entry->count};
+    struct timespec meanDuration = {};
+    long double sample_std_dev = 0.0;
+    long double rel_std_dev = 0.0;
+    if (!calculate_benchmark_statistics(entry, atomic_load_explicit(&g_exclude_outliers, memory_order_relaxed),
+                                        &meanDuration, &sample_std_dev, &rel_std_dev)) {
+        return summary;
+    }
+    summary.mean_ns = (double) i_ezs_benchmark_timespec_to_ns(meanDuration);
+    summary.min_ns = (double) i_ezs_benchmark_timespec_to_ns(entry->minDuration);
+    summary.max_ns = (double) i_ezs_benchmark_timespec_to_ns(entry->maxDuration);
+    summary.std_dev_ns = (double) (sample_std_dev * 1e9L);
+    summary.rsd_percent = (double) rel_std_dev;
+    summary.p50_ns = (double) entry_percentile(entry, 50.0);
+    summary.p95_ns = (double) entry_percentile(entry, 95.0);
+    summary.p99_ns = (double) entry_percentile(entry, 99.0);
+    summary.p999_ns = (double) entry_percentile(entry, 99.9);
+    ezs_benchmark_robust_stats robust;
+    if (calculate_robust_statistics(entry, &robust)) {
+        summary.mad_ns = robust.mad_ns;
+        summary.iqr_ns = robust.iqr_ns;
+        summary.outliers = (double) (robust.low_severe + robust.low_mild + robust.high_mild + robust.high_severe);
+    }
+    if (entry->workNanoseconds > 0) {
+        summary.items_per_second = (double) entry->workItems * 1e9 / (double) entry->workNanoseconds;
+        summary.bytes_per_second = (double) entry->workBytes * 1e9 / (double) entry->workNanoseconds;
+    }
+    return summary;
+}
+
+i_ezs_benchmark_summary *i_ezs_benchmark_collect_summaries(size_t *count) {
+    *count = 0;
+    lock();
+    const size_t capacity = (size_t) smap_bench_size(&g_benchmark_ids);
+    i_ezs_benchmark_summary *summaries = calloc(capacity > 0 ? capacity : 1, sizeof(*summaries));
+    if (nullptr == summaries) {
+        unlock();
+        return nullptr;
+    }
+    c_foreach(it, smap_bench, g_benchmark_ids) {
+        BenchmarkEntry merged = merged_benchmark_entry(it.ref->second);
+        if (merged.count > 0) {
+            i_ezs_benchmark_summary summary = summarize_benchmark_entry(&merged);
+            summary.name = strdup(cstr_str(&it.ref->first));
+            if (nullptr == summary.name) {
+                drop_benchmark_entry(&merged);
+                unlock();
+                i_ezs_benchmark_summaries_drop(summaries, *count);
+                *count = 0;
+                return nullptr;
+            }
+            summaries[*count] = summary;
+            *count += 1;
+        }
+        drop_benchmark_entry(&merged);
+    }
+    unlock();
+    return summaries;
+}
+
+bool i_ezs_benchmark_merged_histogram(const char *name, i_ezs_histogram *histogram, double *mean_ns) {
+    lock();
+    const ezs_benchmark_id id = find_benchmark_id(name);
+    if (EZS_BENCHMARK_INVALID_ID == id) {
+        unlock();
+        return false;
+    }
+    BenchmarkEntry merged = merged_benchmark_entry(id);
+    const bool has_data = merged.count > 0 && i_ezs_histogram_merge(histogram, &merged.histogram);
+    if (has_data) {
+        *mean_ns = (double) i_ezs_benchmark_timespec_to_ns(mean_duration(merged.sumDuration, merged.count));
+    }
+    drop_benchmark_entry(&merged);
+    unlock();
+    return has_data;
+}
+
+void i_ezs_benchmark_summaries_drop(i_ezs_benchmark_summary *summaries, const size_t count) {
+    if (nullptr == summaries) {
+        return;
+    }
+    for (size_t i = 0; i < count; i += 1) {
+        free(summaries[i].name);
+    }
+    free(summaries);
 }
 
+/*---------------------------EZS_BENCHMARK 结果表格---------------------------*/
+
+// 报告中展示的分位数
+static const double REPORTED_PERCENTILES[] = {50.0, 95.0, 99.0, 99.9};
+#define REPORTED_PERCENTILE_COUNT (sizeof(REPORTED_PERCENTILES) / sizeof(REPORTED_PERCENTILES[0]))
+
+static const i_ezs_table_column BENCHMARK_COLUMNS[] = {
+    {"Benchmark Name", 20, true},
+    {"Count", 10, false},
+    {"Mean", 20, false},
+    {"Min", 20, false},
+    {"Max", 20, false},
+    {"Net Mean", 9, false},
+    {"Net Min", 9, false},
+    {"Std Dev", 16, false},
+    {"RSD", 8, false},
+};
+#define BENCHMARK_COLUMN_COUNT (sizeof(BENCHMARK_COLUMNS) / sizeof(BENCHMARK_COLUMNS[0]))
+
 static void print_benchmark_entry(const char *name, const BenchmarkEntry *entry) {
     char count_buf[32] = "N/A", min_buf[32] = "N/A", max_buf[32] = "N/A",
             mean_buf[32] = "N/A", std_dev_buf[64] = "N/A", rel_std_dev_buf[64] = "N/A";
+    char net_mean_buf[32] = "N/A", net_min_buf[32] = "N/A";
     struct timespec meanDuration = {};
     long double sample_std_dev = 0.0;
     long double rel_std_dev = 0.0;
     // 如果entry存在且统计数据计算成功，则格式化输出各项统计数据
     if (entry != nullptr &&
-        calculate_benchmark_statistics(entry, &meanDuration, &sample_std_dev, &rel_std_dev)) {
+        calculate_benchmark_statistics(entry, atomic_load_explicit(&g_exclude_outliers, memory_order_relaxed),
+                                        &meanDuration, &sample_std_dev, &rel_std_dev)) {
         sprintf(count_buf, "%" PRIu64, entry->count);
         if (!ezs_clock_timespec_to_string(entry->minDuration, min_buf, sizeof(min_buf))) {
             snprintf(min_buf, sizeof(min_buf), "Error of conversion");
@@ -191,6 +1603,16 @@ static void print_benchmark_entry(const char *name, const BenchmarkEntry *entry)
         if (!ezs_clock_timespec_to_string(meanDuration, mean_buf, sizeof(mean_buf))) {
             snprintf(mean_buf, sizeof(mean_buf), "Error of conversion");
         }
+        if (g_is_calibrated) {
+            const uint64_t mean = i_ezs_benchmark_timespec_to_ns(meanDuration);
+            const uint64_t min = i_ezs_benchmark_timespec_to_ns(entry->minDuration);
+            i_ezs_table_format_nanoseconds(
+                (double) (mean > g_overhead_median_ns ? mean - g_overhead_median_ns : 0),
+                net_mean_buf, sizeof(net_mean_buf));
+            i_ezs_table_format_nanoseconds(
+                (double) (min > g_overhead_min_ns ? min - g_overhead_min_ns : 0),
+                net_min_buf, sizeof(net_min_buf));
+        }
         if (snprintf(std_dev_buf, sizeof(std_dev_buf), "%Lfs", sample_std_dev) < 0) {
             snprintf(std_dev_buf, sizeof(std_dev_buf), "Error of conversion");
         }
@@ -199,43 +1621,503 @@ static void print_benchmark_entry(const char *name, const BenchmarkEntry *entry)
         }
     }
     // 输出结果
-    printf("│%-20s │ %10s │ %20s │ %20s │ %20s │ %16s │ %8s│\n",
-           name, count_buf, mean_buf, min_buf, max_buf, std_dev_buf, rel_std_dev_buf);
+    const char *const cells[BENCHMARK_COLUMN_COUNT] = {
+        name, count_buf, mean_buf, min_buf, max_buf, net_mean_buf, net_min_buf, std_dev_buf, rel_std_dev_buf
+    };
+    i_ezs_table_print_row(BENCHMARK_COLUMNS, BENCHMARK_COLUMN_COUNT, cells);
 }
 
 static void print_benchmark_header(void) {
-    printf("\n");
-    printf(
-        "┌────────────────────────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐\n");
-    printf(
-        "│                                                       Benchmark Result Table                                                       │\n");
-    printf(
-        "├─────────────────────┬────────────┬──────────────────────┬──────────────────────┬──────────────────────┬──────────────────┬─────────┤\n");
-    printf("│%-20s │ %10s │ %20s │ %20s │ %20s │ %16s │ %8s│\n",
-           "Benchmark Name", "Count", "Mean", "Min", "Max", "Std Dev", "RSD");
-    printf(
-        "├─────────────────────┼────────────┼──────────────────────┼──────────────────────┼──────────────────────┼──────────────────┼─────────┤\n");
+    i_ezs_table_print_header("Benchmark Result Table", BENCHMARK_COLUMNS, BENCHMARK_COLUMN_COUNT);
 }
 
+// 调用者需持有g_lock
 static void print_benchmark_footer(void) {
-    printf(
-        "└─────────────────────┴────────────┴──────────────────────┴──────────────────────┴──────────────────────┴──────────────────┴─────────┘\n\n");
+    i_ezs_table_print_footer(BENCHMARK_COLUMNS, BENCHMARK_COLUMN_COUNT);
+    if (g_overwritten_sample_count > 0) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "%" PRIu64 " captured samples were overwritten before being processed and are not in the statistics. "
+                "Use a larger capture buffer or print more often.\n", g_overwritten_sample_count);
+    }
+    if (g_is_calibrated) {
+        char median_buf[32], min_buf[32];
+        i_ezs_table_format_nanoseconds((double) g_overhead_median_ns, median_buf, sizeof(median_buf));
+        i_ezs_table_format_nanoseconds((double) g_overhead_min_ns, min_buf, sizeof(min_buf));
+        printf("[EZS] Net Mean = Mean - timer overhead median (%s), Net Min = Min - timer overhead min (%s)\n\n",
+               median_buf, min_buf);
+    }
+    if (atomic_load_explicit(&g_exclude_outliers, memory_order_relaxed)) {
+        printf("[EZS] Mean, Std Dev and RSD exclude the outliers outside the Tukey fences\n\n");
+    }
+}
+
+static const i_ezs_table_column PERCENTILE_COLUMNS[] = {
+    {"Benchmark Name", 20, true},
+    {"Samples", 10, false},
+    {"P50", 9, false},
+    {"P95", 9, false},
+    {"P99", 9, false},
+    {"P99.9", 9, false},
+};
+#define PERCENTILE_COLUMN_COUNT (sizeof(PERCENTILE_COLUMNS) / sizeof(PERCENTILE_COLUMNS[0]))
+
+// 打印句柄为id的条目的分位数，无数据时不打印，has_header记录是否已经打印过表头
+// 调用者需持有g_lock
+static void print_percentile_entry(const char *name, const ezs_benchmark_id id, bool *has_header) {
+    BenchmarkEntry merged = merged_benchmark_entry(id);
+    if (merged.count > 0) {
+        if (!*has_header) {
+            i_ezs_table_print_header("Latency Percentile Table", PERCENTILE_COLUMNS, PERCENTILE_COLUMN_COUNT);
+            *has_header = true;
+        }
+        char samples_buf[32];
+        char percentile_bufs[REPORTED_PERCENTILE_COUNT][32];
+        snprintf(samples_buf, sizeof(samples_buf), "%" PRIu64, merged.count);
+        for (size_t i = 0; i < REPORTED_PERCENTILE_COUNT; i += 1) {
+            i_ezs_table_format_nanoseconds((double) entry_percentile(&merged, REPORTED_PERCENTILES[i]),
+                                           percentile_bufs[i], sizeof(percentile_bufs[i]));
+        }
+        const char *const cells[PERCENTILE_COLUMN_COUNT] = {
+            name, samples_buf, percentile_bufs[0], percentile_bufs[1], percentile_bufs[2], percentile_bufs[3]
+        };
+        i_ezs_table_print_row(PERCENTILE_COLUMNS, PERCENTILE_COLUMN_COUNT, cells);
+    }
+    drop_benchmark_entry(&merged);
+}
+
+// 调用者需持有g_lock
+static void print_percentile_footer(const bool has_header) {
+    if (has_header) {
+        i_ezs_table_print_footer(PERCENTILE_COLUMNS, PERCENTILE_COLUMN_COUNT);
+        printf("[EZS] Percentiles come from the latency histogram (%d significant digits)\n\n",
+               I_EZS_HISTOGRAM_SIGNIFICANT_DIGITS);
+    }
 }
 
 void ezs_benchmark_print(char *names[]) {
+    lock();
     print_benchmark_header();
     for (size_t i = 0; names[i] != nullptr; i += 1) {
         const char *name = names[i];
-        auto const it = smap_bench_find(&g_benchmarks, name);
-        print_benchmark_entry(name, it.ref ? &it.ref->second : nullptr);
+        const ezs_benchmark_id id = find_benchmark_id(name);
+        if (EZS_BENCHMARK_INVALID_ID == id) {
+            print_benchmark_entry(name, nullptr);
+            continue;
+        }
+        BenchmarkEntry merged = merged_benchmark_entry(id);
+        print_benchmark_entry(name, &merged);
+        drop_benchmark_entry(&merged);
     }
     print_benchmark_footer();
+    bool has_header = false;
+    for (size_t i = 0; names[i] != nullptr; i += 1) {
+        const ezs_benchmark_id id = find_benchmark_id(names[i]);
+        if (EZS_BENCHMARK_INVALID_ID != id) {
+            print_percentile_entry(names[i], id, &has_header);
+        }
+    }
+    print_percentile_footer(has_header);
+    unlock();
+}
+
+static const i_ezs_table_column ROBUST_COLUMNS[] = {
+    {"Benchmark Name", 20, true},
+    {"Samples", 10, false},
+    {"Median", 9, false},
+    {"MAD", 9, false},
+    {"Q1", 9, false},
+    {"Q3", 9, false},
+    {"IQR", 9, false},
+    {"Low Severe", 10, false},
+    {"Low Mild", 10, false},
+    {"High Mild", 10, false},
+    {"High Severe", 11, false},
+};
+#define ROBUST_COLUMN_COUNT (sizeof(ROBUST_COLUMNS) / sizeof(ROBUST_COLUMNS[0]))
+
+static void print_robust_entry(const char *name, const ezs_benchmark_robust_stats *stats) {
+    char samples_buf[32], median_buf[32], mad_buf[32], q1_buf[32], q3_buf[32], iqr_buf[32];
+    char low_severe_buf[32], low_mild_buf[32], high_mild_buf[32], high_severe_buf[32];
+    snprintf(samples_buf, sizeof(samples_buf), "%" PRIu64, stats->samples);
+    i_ezs_table_format_nanoseconds(stats->median_ns, median_buf, sizeof(median_buf));
+    i_ezs_table_format_nanoseconds(stats->mad_ns, mad_buf, sizeof(mad_buf));
+    i_ezs_table_format_nanoseconds(stats->q1_ns, q1_buf, sizeof(q1_buf));
+    i_ezs_table_format_nanoseconds(stats->q3_ns, q3_buf, sizeof(q3_buf));
+    i_ezs_table_format_nanoseconds(stats->iqr_ns, iqr_buf, sizeof(iqr_buf));
+    snprintf(low_severe_buf, sizeof(low_severe_buf), "%" PRIu64, stats->low_severe);
+    snprintf(low_mild_buf, sizeof(low_mild_buf), "%" PRIu64, stats->low_mild);
+    snprintf(high_mild_buf, sizeof(high_mild_buf), "%" PRIu64, stats->high_mild);
+    snprintf(high_severe_buf, sizeof(high_severe_buf), "%" PRIu64, stats->high_severe);
+    const char *const cells[ROBUST_COLUMN_COUNT] = {
+        name, samples_buf, median_buf, mad_buf, q1_buf, q3_buf, iqr_buf,
+        low_severe_buf, low_mild_buf, high_mild_buf, high_severe_buf
+    };
+    i_ezs_table_print_row(ROBUST_COLUMNS, ROBUST_COLUMN_COUNT, cells);
+}
+
+// 调用者需持有g_lock
+static void print_robust_table(void) {
+    bool has_header = false;
+    c_foreach(it, smap_bench, g_benchmark_ids) {
+        BenchmarkEntry merged = merged_benchmark_entry(it.ref->second);
+        ezs_benchmark_robust_stats stats;
+        if (merged.count > 0 && calculate_robust_statistics(&merged, &stats)) {
+            if (!has_header) {
+                i_ezs_table_print_header("Robust Statistics Table", ROBUST_COLUMNS, ROBUST_COLUMN_COUNT);
+                has_header = true;
+            }
+            print_robust_entry(cstr_str(&it.ref->first), &stats);
+        }
+        drop_benchmark_entry(&merged);
+    }
+    if (has_header) {
+        i_ezs_table_print_footer(ROBUST_COLUMNS, ROBUST_COLUMN_COUNT);
+        printf("[EZS] Mild outliers lie beyond 1.5 IQR outside [Q1, Q3], severe outliers beyond 3 IQR\n\n");
+    }
+}
+
+static const i_ezs_table_column COUNTER_COLUMNS[] = {
+    {"Benchmark Name", 20, true},
+    {"Samples", 10, false},
+    {"Cycles", 10, false},
+    {"Instructions", 12, false},
+    {"IPC", 6, false},
+    {"Cache Refs", 10, false},
+    {"Cache Miss %", 12, false},
+    {"Branch Miss", 11, false},
+    {"Branch MPKI", 11, false},
+};
+#define COUNTER_COLUMN_COUNT (sizeof(COUNTER_COLUMNS) / sizeof(COUNTER_COLUMNS[0]))
+
+// 计数过kind时，将每次调用的平均值格式化到buf
+static void format_counter_per_call(const BenchmarkEntry *entry, const int kind, char *buf, const size_t size) {
+    if (0 != (entry->counterEvents & (1u << kind))) {
+        i_ezs_table_format_count((double) entry->counterSum[kind] / (double) entry->counterCount, buf, size);
+    }
+}
+
+// 计数过numerator与denominator时，将二者之比乘以scale格式化到buf
+static void format_counter_ratio(const BenchmarkEntry *entry, const int numerator, const int denominator,
+                                 const double scale, const char *suffix, char *buf, const size_t size) {
+    const unsigned required = (1u << numerator) | (1u << denominator);
+    if (required == (entry->counterEvents & required) && entry->counterSum[denominator] > 0) {
+        snprintf(buf, size, "%.2f%s",
+                 (double) entry->counterSum[numerator] / (double) entry->counterSum[denominator] * scale, suffix);
+    }
+}
+
+static void print_counter_entry(const char *name, const BenchmarkEntry *entry) {
+    char samples_buf[32], cycles_buf[32] = "N/A", instructions_buf[32] = "N/A", ipc_buf[32] = "N/A",
+            references_buf[32] = "N/A", miss_rate_buf[32] = "N/A", branch_buf[32] = "N/A", mpki_buf[32] = "N/A";
+    snprintf(samples_buf, sizeof(samples_buf), "%" PRIu64, entry->counterCount);
+    format_counter_per_call(entry, I_EZS_PERF_CYCLES, cycles_buf, sizeof(cycles_buf));
+    format_counter_per_call(entry, I_EZS_PERF_INSTRUCTIONS, instructions_buf, sizeof(instructions_buf));
+    format_counter_per_call(entry, I_EZS_PERF_CACHE_REFERENCES, references_buf, sizeof(references_buf));
+    format_counter_per_call(entry, I_EZS_PERF_BRANCH_MISSES, branch_buf, sizeof(branch_buf));
+    format_counter_ratio(entry, I_EZS_PERF_INSTRUCTIONS, I_EZS_PERF_CYCLES, 1.0, "", ipc_buf, sizeof(ipc_buf));
+    format_counter_ratio(entry, I_EZS_PERF_CACHE_MISSES, I_EZS_PERF_CACHE_REFERENCES, 100.0, "%",
+                         miss_rate_buf, sizeof(miss_rate_buf));
+    format_counter_ratio(entry, I_EZS_PERF_BRANCH_MISSES, I_EZS_PERF_INSTRUCTIONS, 1000.0, "",
+                         mpki_buf, sizeof(mpki_buf));
+    const char *const cells[COUNTER_COLUMN_COUNT] = {
+        name, samples_buf, cycles_buf, instructions_buf, ipc_buf, references_buf, miss_rate_buf, branch_buf, mpki_buf
+    };
+    i_ezs_table_print_row(COUNTER_COLUMNS, COUNTER_COLUMN_COUNT, cells);
+}
+
+static const i_ezs_table_column USAGE_COLUMNS[] = {
+    {"Benchmark Name", 20, true},
+    {"Samples", 10, false},
+    {"Minor Faults", 12, false},
+    {"Major Faults", 12, false},
+    {"Vol Switches", 12, false},
+    {"Invol Switches", 14, false},
+    {"User/Call", 9, false},
+    {"Sys/Call", 9, false},
+};
+#define USAGE_COLUMN_COUNT (sizeof(USAGE_COLUMNS) / sizeof(USAGE_COLUMNS[0]))
+
+static void print_resource_usage_entry(const char *name, const BenchmarkEntry *entry) {
+    const i_ezs_resource_usage *usage = &entry->usageSum;
+    char samples_buf[32], minor_buf[32], major_buf[32], voluntary_buf[32], involuntary_buf[32],
+            user_buf[32], system_buf[32];
+    snprintf(samples_buf, sizeof(samples_buf), "%" PRIu64, entry->usageCount);
+    snprintf(minor_buf, sizeof(minor_buf), "%" PRIu64, usage->minor_faults);
+    snprintf(major_buf, sizeof(major_buf), "%" PRIu64, usage->major_faults);
+    snprintf(voluntary_buf, sizeof(voluntary_buf), "%" PRIu64, usage->voluntary_switches);
+    snprintf(involuntary_buf, sizeof(involuntary_buf), "%" PRIu64, usage->involuntary_switches);
+    i_ezs_table_format_nanoseconds((double) usage->user_ns / (double) entry->usageCount, user_buf, sizeof(user_buf));
+    i_ezs_table_format_nanoseconds((double) usage->system_ns / (double) entry->usageCount,
+                                   system_buf, sizeof(system_buf));
+    const char *const cells[USAGE_COLUMN_COUNT] = {
+        name, samples_buf, minor_buf, major_buf, voluntary_buf, involuntary_buf, user_buf, system_buf
+    };
+    i_ezs_table_print_row(USAGE_COLUMNS, USAGE_COLUMN_COUNT, cells);
+}
+
+// 打印所有带有资源使用量数据的条目，没有数据时不打印
+// 调用者需持有g_lock
+static void print_resource_usage_table(void) {
+    bool has_header = false;
+    c_foreach(it, smap_bench, g_benchmark_ids) {
+        BenchmarkEntry merged = merged_benchmark_entry(it.ref->second);
+        if (merged.usageCount > 0) {
+            if (!has_header) {
+                i_ezs_table_print_header("Resource Usage Table", USAGE_COLUMNS, USAGE_COLUMN_COUNT);
+                has_header = true;
+            }
+            print_resource_usage_entry(cstr_str(&it.ref->first), &merged);
+        }
+        drop_benchmark_entry(&merged);
+    }
+    if (has_header) {
+        i_ezs_table_print_footer(USAGE_COLUMNS, USAGE_COLUMN_COUNT);
+        printf("[EZS] Faults and context switches are totals over the samples, "
+               "CPU time has a resolution of 1us and includes nested regions\n\n");
+    }
+}
+
+static const i_ezs_table_column CPU_TIME_COLUMNS[] = {
+    {"Benchmark Name", 20, true},
+    {"Samples", 10, false},
+    {"Wall/Call", 9, false},
+    {"Thread CPU/Call", 15, false},
+    {"Process CPU/Call", 16, false},
+    {"Thread Util", 11, false},
+    {"Process Util", 12, false},
+};
+#define CPU_TIME_COLUMN_COUNT (sizeof(CPU_TIME_COLUMNS) / sizeof(CPU_TIME_COLUMNS[0]))
+
+static void print_cpu_time_entry(const char *name, const BenchmarkEntry *entry) {
+    char samples_buf[32], wall_buf[32], thread_buf[32], process_buf[32],
+            thread_util_buf[32] = "N/A", process_util_buf[32] = "N/A";
+    const double count = (double) entry->cpuCount;
+    snprintf(samples_buf, sizeof(samples_buf), "%" PRIu64, entry->cpuCount);
+    i_ezs_table_format_nanoseconds((double) entry->cpuWallNs / count, wall_buf, sizeof(wall_buf));
+    i_ezs_table_format_nanoseconds((double) entry->cpuThreadNs / count, thread_buf, sizeof(thread_buf));
+    i_ezs_table_format_nanoseconds((double) entry->cpuProcessNs / count, process_buf, sizeof(process_buf));
+    if (entry->cpuWallNs > 0) {
+        snprintf(thread_util_buf, sizeof(thread_util_buf), "%.1f%%",
+                 (double) entry->cpuThreadNs / (double) entry->cpuWallNs * 100.0);
+        snprintf(process_util_buf, sizeof(process_util_buf), "%.1f%%",
+                 (double) entry->cpuProcessNs / (double) entry->cpuWallNs * 100.0);
+    }
+    const char *const cells[CPU_TIME_COLUMN_COUNT] = {
+        name, samples_buf, wall_buf, thread_buf, process_buf, thread_util_buf, process_util_buf
+    };
+    i_ezs_table_print_row(CPU_TIME_COLUMNS, CPU_TIME_COLUMN_COUNT, cells);
+}
+
+// 调用者需持有g_lock
+static void print_cpu_time_table(void) {
+    bool has_header = false;
+    c_foreach(it, smap_bench, g_benchmark_ids) {
+        BenchmarkEntry merged = merged_benchmark_entry(it.ref->second);
+        if (merged.cpuCount > 0) {
+            if (!has_header) {
+                i_ezs_table_print_header("CPU Time Table", CPU_TIME_COLUMNS, CPU_TIME_COLUMN_COUNT);
+                has_header = true;
+            }
+            print_cpu_time_entry(cstr_str(&it.ref->first), &merged);
+        }
+        drop_benchmark_entry(&merged);
+    }
+    if (has_header) {
+        i_ezs_table_print_footer(CPU_TIME_COLUMNS, CPU_TIME_COLUMN_COUNT);
+        printf("[EZS] Util = CPU time / wall time. Thread Util well below 100%% means the region was blocked "
+               "(I/O, locks, sleeping), Process Util above 100%% means other threads were running meanwhile\n\n");
+    }
+}
+
+// 打印所有带有硬件计数器数据的条目，没有数据时不打印
+// 调用者需持有g_lock
+static void print_counter_table(void) {
+    bool has_header = false;
+    c_foreach(it, smap_bench, g_benchmark_ids) {
+        BenchmarkEntry merged = merged_benchmark_entry(it.ref->second);
+        if (merged.counterCount > 0) {
+            if (!has_header) {
+                i_ezs_table_print_header("Hardware Counter Table", COUNTER_COLUMNS, COUNTER_COLUMN_COUNT);
+                has_header = true;
+            }
+            print_counter_entry(cstr_str(&it.ref->first), &merged);
+        }
+        drop_benchmark_entry(&merged);
+    }
+    if (has_header) {
+        i_ezs_table_print_footer(COUNTER_COLUMNS, COUNTER_COLUMN_COUNT);
+        printf("[EZS] Counters are per call in user mode, MPKI = branch misses per 1000 instructions\n\n");
+    }
+}
+
+static const i_ezs_table_column THROUGHPUT_COLUMNS[] = {
+    {"Benchmark Name", 20, true},
+    {"Calls", 10, false},
+    {"Items", 10, false},
+    {"Bytes", 10, false},
+    {"Items/s", 10, false},
+    {"Bandwidth", 12, false},
+};
+#define THROUGHPUT_COLUMN_COUNT (sizeof(THROUGHPUT_COLUMNS) / sizeof(THROUGHPUT_COLUMNS[0]))
+
+static void print_throughput_entry(const char *name, const BenchmarkEntry *entry) {
+    char calls_buf[32], items_buf[32], bytes_buf[32], items_rate_buf[32] = "N/A", bandwidth_buf[32] = "N/A";
+    snprintf(calls_buf, sizeof(calls_buf), "%" PRIu64, entry->workCount);
+    i_ezs_table_format_count((double) entry->workItems, items_buf, sizeof(items_buf));
+    i_ezs_table_format_count((double) entry->workBytes, bytes_buf, sizeof(bytes_buf));
+    // 耗时为0时（计时精度不足）无法计算吞吐量
+    if (entry->workNanoseconds > 0) {
+        const double seconds = (double) entry->workNanoseconds / 1e9;
+        if (entry->workItems > 0) {
+            i_ezs_table_format_count((double) entry->workItems / seconds, items_rate_buf, sizeof(items_rate_buf));
+        }
+        if (entry->workBytes > 0) {
+            i_ezs_table_format_bandwidth((double) entry->workBytes / seconds, bandwidth_buf, sizeof(bandwidth_buf));
+        }
+    }
+    const char *const cells[THROUGHPUT_COLUMN_COUNT] = {
+        name, calls_buf, items_buf, bytes_buf, items_rate_buf, bandwidth_buf
+    };
+    i_ezs_table_print_row(THROUGHPUT_COLUMNS, THROUGHPUT_COLUMN_COUNT, cells);
+}
+
+// 打印所有记录过工作量的条目，没有数据时不打印
+// 调用者需持有g_lock
+static void print_throughput_table(void) {
+    bool has_header = false;
+    c_foreach(it, smap_bench, g_benchmark_ids) {
+        BenchmarkEntry merged = merged_benchmark_entry(it.ref->second);
+        if (merged.workCount > 0) {
+            if (!has_header) {
+                i_ezs_table_print_header("Throughput Table", THROUGHPUT_COLUMNS, THROUGHPUT_COLUMN_COUNT);
+                has_header = true;
+            }
+            print_throughput_entry(cstr_str(&it.ref->first), &merged);
+        }
+        drop_benchmark_entry(&merged);
+    }
+    if (has_header) {
+        i_ezs_table_print_footer(THROUGHPUT_COLUMNS, THROUGHPUT_COLUMN_COUNT);
+        printf("[EZS] Throughput = total work / total time of the calls ended with work, 1 MB = 10^6 bytes\n\n");
+    }
+}
+
+static const i_ezs_table_column ALLOCATION_COLUMNS[] = {
+    {"Benchmark Name", 20, true},
+    {"Calls", 10, false},
+    {"Allocs/Call", 11, false},
+    {"Bytes/Call", 10, false},
+    {"Total Bytes", 11, false},
+    {"Peak Live", 10, false},
+};
+#define ALLOCATION_COLUMN_COUNT (sizeof(ALLOCATION_COLUMNS) / sizeof(ALLOCATION_COLUMNS[0]))
+
+static void print_allocation_entry(const char *name, const BenchmarkEntry *entry) {
+    char calls_buf[32], count_buf[32], bytes_buf[32], total_buf[32], peak_buf[32];
+    snprintf(calls_buf, sizeof(calls_buf), "%" PRIu64, entry->allocCalls);
+    i_ezs_table_format_count((double) entry->allocCount / (double) entry->allocCalls, count_buf, sizeof(count_buf));
+    i_ezs_table_format_bytes((double) entry->allocBytes / (double) entry->allocCalls, bytes_buf, sizeof(bytes_buf));
+    i_ezs_table_format_bytes((double) entry->allocBytes, total_buf, sizeof(total_buf));
+    i_ezs_table_format_bytes((double) entry->allocPeakBytes, peak_buf, sizeof(peak_buf));
+    const char *const cells[ALLOCATION_COLUMN_COUNT] = {
+        name, calls_buf, count_buf, bytes_buf, total_buf, peak_buf
+    };
+    i_ezs_table_print_row(ALLOCATION_COLUMNS, ALLOCATION_COLUMN_COUNT, cells);
+}
+
+// 打印所有追踪了堆分配的条目，未启用堆分配追踪或没有数据时不打印
+// 调用者需持有g_lock
+static void print_allocation_table(void) {
+    if (!I_EZS_ALLOC_TRACKING) {
+        return;
+    }
+    bool has_header = false;
+    c_foreach(it, smap_bench, g_benchmark_ids) {
+        BenchmarkEntry merged = merged_benchmark_entry(it.ref->second);
+        if (merged.allocCalls > 0) {
+            if (!has_header) {
+                i_ezs_table_print_header("Allocation Table", ALLOCATION_COLUMNS, ALLOCATION_COLUMN_COUNT);
+                has_header = true;
+            }
+            print_allocation_entry(cstr_str(&it.ref->first), &merged);
+        }
+        drop_benchmark_entry(&merged);
+    }
+    if (has_header) {
+        i_ezs_table_print_footer(ALLOCATION_COLUMNS, ALLOCATION_COLUMN_COUNT);
+        printf("[EZS] Allocations exclude nested regions, Peak Live = max bytes still allocated during one call "
+               "including nested regions\n\n");
+    }
+}
+
+// 调用树中显示的名称，校准所用的条目不显示
+// 调用者需持有g_lock
+static const char *call_tree_name(const ezs_benchmark_id id) {
+    return id < g_benchmark_count && id != g_calibration_id ? g_benchmark_names[id] : nullptr;
+}
+
+// 合并所有分片的调用树并打印
+// only_if_nested为true时，没有嵌套的区域则不打印
+// 调用者需持有g_lock
+static void print_call_tree(const bool only_if_nested) {
+    i_ezs_call_tree merged;
+    i_ezs_call_tree_init(&merged);
+    for (const BenchmarkShard *shard = g_shards; nullptr != shard; shard = shard->next) {
+        if (!i_ezs_call_tree_merge(&merged, &shard->tree)) {
+            fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                    "Failed to allocate the call tree. The call tree is incomplete.\n");
+        }
+    }
+    if (!only_if_nested || i_ezs_call_tree_has_nesting(&merged, call_tree_name)) {
+        i_ezs_call_tree_print(&merged, call_tree_name);
+    }
+    i_ezs_call_tree_drop(&merged);
+}
+
+void ezs_benchmark_print_tree(void) {
+    lock();
+    print_call_tree(false);
+    unlock();
 }
 
 void ezs_benchmark_print_all(void) {
+    i_ezs_benchmark_environment_print();
+    lock();
     print_benchmark_header();
-    c_foreach(it, smap_bench, g_benchmarks) {
-        print_benchmark_entry(cstr_str(&it.ref->first), &it.ref->second);
+    c_foreach(it, smap_bench, g_benchmark_ids) {
+        BenchmarkEntry merged = merged_benchmark_entry(it.ref->second);
+        print_benchmark_entry(cstr_str(&it.ref->first), &merged);
+        drop_benchmark_entry(&merged);
     }
     print_benchmark_footer();
+    bool has_header = false;
+    c_foreach(it, smap_bench, g_benchmark_ids) {
+        print_percentile_entry(cstr_str(&it.ref->first), it.ref->second, &has_header);
+    }
+    print_percentile_footer(has_header);
+    print_robust_table();
+    print_throughput_table();
+    print_allocation_table();
+    print_counter_table();
+    print_resource_usage_table();
+    print_cpu_time_table();
+    print_call_tree(true);
+    unlock();
+    i_ezs_benchmark_run_print_all();
+    i_ezs_benchmark_scaling_print_all();
+    i_ezs_benchmark_load_print_all();
+    i_ezs_benchmark_instrument_print_all();
+    i_ezs_benchmark_profile_print_all();
 }
+
+/*---------------------------清理局部宏---------------------------*/
+
+#undef REPORTED_PERCENTILE_COUNT
+#undef BENCHMARK_COLUMN_COUNT
+#undef PERCENTILE_COLUMN_COUNT
+#undef ROBUST_COLUMN_COUNT
+#undef COUNTER_COLUMN_COUNT
+#undef USAGE_COLUMN_COUNT
+#undef CPU_TIME_COLUMN_COUNT
+#undef THROUGHPUT_COLUMN_COUNT
+#undef ALLOCATION_COLUMN_COUNT
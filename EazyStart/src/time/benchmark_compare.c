@@ -0,0 +1,277 @@
+#include "EazyStart/time/benchmark_compare.h"
+#include "benchmark_internal.h"
+#include "histogram.h"
+#include "table.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*---------------------------EZS_BENCHMARK_COMPARE 参数---------------------------*/
+
+// 自助法的重采样轮数
+static constexpr int BOOTSTRAP_ROUNDS = 1000;
+// 每轮重采样的最大样本数，样本更多时按m-out-of-n自助法缩放
+static constexpr uint64_t BOOTSTRAP_MAX_RESAMPLE = 5000;
+// 显著性水平，对应95%置信区间
+static constexpr double SIGNIFICANCE_LEVEL = 0.05;
+
+/*---------------------------EZS_BENCHMARK_COMPARE 耗时分布---------------------------*/
+
+// 由直方图得到的耗时分布
+typedef struct {
+    i_ezs_histogram_bucket *buckets;
+    uint64_t *cumulative; // 前i+1个桶的计数之和，用于按计数加权抽样
+    size_t bucket_count;
+    uint64_t total;
+    double mean_ns; // 按桶的中间值计算的平均值
+    double exact_mean_ns; // 由条目记录的精确平均值
+} Distribution;
+
+static void drop_distribution(Distribution *distribution) {
+    free(distribution->buckets);
+    free(distribution->cumulative);
+    *distribution = (Distribution){};
+}
+
+// 读取名为name的条目的耗时分布，失败时打印错误并返回false
+static bool load_distribution(const char *name, Distribution *distribution) {
+    *distribution = (Distribution){};
+    i_ezs_histogram histogram = {};
+    if (!i_ezs_benchmark_merged_histogram(name, &histogram, &distribution->exact_mean_ns)) {
+        i_ezs_histogram_drop(&histogram);
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Benchmark item '%s' does not exist or has no data. Cannot compare.\n", name);
+        return false;
+    }
+    distribution->buckets = i_ezs_histogram_buckets(&histogram, &distribution->bucket_count);
+    i_ezs_histogram_drop(&histogram);
+    if (nullptr == distribution->buckets) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate memory for comparing '%s'.\n", name);
+        return false;
+    }
+    distribution->cumulative = malloc(distribution->bucket_count * sizeof(*distribution->cumulative));
+    if (nullptr == distribution->cumulative) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate memory for comparing '%s'.\n", name);
+        drop_distribution(distribution);
+        return false;
+    }
+    double sum = 0.0;
+    for (size_t i = 0; i < distribution->bucket_count; i += 1) {
+        distribution->total += distribution->buckets[i].count;
+        distribution->cumulative[i] = distribution->total;
+        sum += (double) distribution->buckets[i].value * (double) distribution->buckets[i].count;
+    }
+    distribution->mean_ns = sum / (double) distribution->total;
+    if (distribution->total < 2) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Benchmark item '%s' needs at least 2 samples to compare.\n", name);
+        drop_distribution(distribution);
+        return false;
+    }
+    return true;
+}
+
+/*---------------------------EZS_BENCHMARK_COMPARE 自助法---------------------------*/
+
+// 重采样使用独立的固定种子生成器，结果可复现，也不会影响ezs_random的序列 [SplitMix64]
+static uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// 按计数加权随机抽取一个桶的值
+static double draw(const Distribution *distribution, uint64_t *state) {
+    const uint64_t target = next_random(state) % distribution->total;
+    // 查找第一个cumulative > target的桶
+    size_t low = 0, high = distribution->bucket_count - 1;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (distribution->cumulative[middle] > target) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return (double) distribution->buckets[low].value;
+}
+
+// 一轮重采样得到的平均值
+// 样本数n大于BOOTSTRAP_MAX_RESAMPLE时只抽取m个，并将偏差按sqrt(m/n)缩放到n个样本的尺度
+static double resample_mean(const Distribution *distribution, uint64_t *state) {
+    const uint64_t m = distribution->total < BOOTSTRAP_MAX_RESAMPLE ? distribution->total : BOOTSTRAP_MAX_RESAMPLE;
+    double sum = 0.0;
+    for (uint64_t i = 0; i < m; i += 1) {
+        sum += draw(distribution, state);
+    }
+    const double mean = sum / (double) m;
+    return distribution->mean_ns + (mean - distribution->mean_ns) * sqrt((double) m / (double) distribution->total);
+}
+
+static int compare_double(const void *lhs, const void *rhs) {
+    const double a = *(const double *) lhs;
+    const double b = *(const double *) rhs;
+    return a < b ? -1 : a > b ? 1 : 0;
+}
+
+// 计算加速比的95%置信区间 [百分位自助法]
+// 直方图的中间值与精确平均值略有偏差，区间按二者之比校正到精确的加速比上
+static bool bootstrap_speedup(const Distribution *baseline, const Distribution *candidate,
+                              ezs_benchmark_comparison *result) {
+    double *ratios = malloc((size_t) BOOTSTRAP_ROUNDS * sizeof(*ratios));
+    if (nullptr == ratios) {
+        return false;
+    }
+    uint64_t state = 0x45A57B3C0F129D61ULL;
+    for (int i = 0; i < BOOTSTRAP_ROUNDS; i += 1) {
+        const double baseline_mean = resample_mean(baseline, &state);
+        const double candidate_mean = resample_mean(candidate, &state);
+        ratios[i] = candidate_mean > 0.0 ? baseline_mean / candidate_mean : INFINITY;
+    }
+    qsort(ratios, (size_t) BOOTSTRAP_ROUNDS, sizeof(*ratios), compare_double);
+    const double histogram_speedup = candidate->mean_ns > 0.0 ? baseline->mean_ns / candidate->mean_ns : INFINITY;
+    const double correction = isfinite(histogram_speedup) && histogram_speedup > 0.0
+                                  ? result->speedup / histogram_speedup
+                                  : 1.0;
+    const int lower_index = (int) floor(SIGNIFICANCE_LEVEL / 2.0 * BOOTSTRAP_ROUNDS);
+    const int upper_index = (int) ceil((1.0 - SIGNIFICANCE_LEVEL / 2.0) * BOOTSTRAP_ROUNDS) - 1;
+    result->speedup_lower = ratios[lower_index] * correction;
+    result->speedup_upper = ratios[upper_index] * correction;
+    free(ratios);
+    return true;
+}
+
+/*---------------------------EZS_BENCHMARK_COMPARE Mann-Whitney U检验---------------------------*/
+
+// 双侧p值，同一个桶内的耗时视为相同，使用带结校正与连续性校正的正态近似
+static double mann_whitney_p_value(const Distribution *baseline, const Distribution *candidate) {
+    const double n1 = (double) baseline->total;
+    const double n2 = (double) candidate->total;
+    const double n = n1 + n2;
+    double rank_sum = 0.0; // 基准组的秩和
+    double tie_sum = 0.0; // sum(t^3 - t)
+    double next_rank = 1.0;
+    size_t i = 0, j = 0;
+    // 两组的桶都按值从小到大排列，同一个值的桶合并为一组结
+    while (i < baseline->bucket_count || j < candidate->bucket_count) {
+        uint64_t value = UINT64_MAX;
+        if (i < baseline->bucket_count) {
+            value = baseline->buckets[i].value;
+        }
+        if (j < candidate->bucket_count && candidate->buckets[j].value < value) {
+            value = candidate->buckets[j].value;
+        }
+        double a = 0.0, b = 0.0;
+        if (i < baseline->bucket_count && baseline->buckets[i].value == value) {
+            a = (double) baseline->buckets[i].count;
+            i += 1;
+        }
+        if (j < candidate->bucket_count && candidate->buckets[j].value == value) {
+            b = (double) candidate->buckets[j].count;
+            j += 1;
+        }
+        const double t = a + b;
+        rank_sum += a * (next_rank + (t - 1.0) / 2.0);
+        tie_sum += t * t * t - t;
+        next_rank += t;
+    }
+    const double u = rank_sum - n1 * (n1 + 1.0) / 2.0;
+    const double variance = n1 * n2 / 12.0 * ((n + 1.0) - tie_sum / (n * (n - 1.0)));
+    if (variance <= 0.0) {
+        return 1.0;
+    }
+    double z = (fabs(u - n1 * n2 / 2.0) - 0.5) / sqrt(variance);
+    z = z > 0.0 ? z : 0.0;
+    return erfc(z / sqrt(2.0));
+}
+
+/*---------------------------EZS_BENCHMARK_COMPARE 对比---------------------------*/
+
+static const i_ezs_table_column COMPARE_COLUMNS[] = {
+    {"Baseline", 20, true},
+    {"Candidate", 20, true},
+    {"Base Mean", 10, false},
+    {"Cand Mean", 10, false},
+    {"Speedup", 8, false},
+    {"95% CI", 17, false},
+    {"p-value", 9, false},
+    {"Verdict", 17, false},
+};
+#define COMPARE_COLUMN_COUNT (sizeof(COMPARE_COLUMNS) / sizeof(COMPARE_COLUMNS[0]))
+
+static const char *verdict_name(const ezs_benchmark_verdict verdict) {
+    switch (verdict) {
+        case EZS_BENCHMARK_FASTER: return "faster";
+        case EZS_BENCHMARK_SLOWER: return "slower";
+        default: return "indistinguishable";
+    }
+}
+
+static void print_comparison(const char *baseline, const char *candidate, const ezs_benchmark_comparison *result) {
+    char base_mean_buf[32], cand_mean_buf[32], speedup_buf[32], ci_buf[64], p_buf[32];
+    i_ezs_table_format_nanoseconds(result->baseline_mean_ns, base_mean_buf, sizeof(base_mean_buf));
+    i_ezs_table_format_nanoseconds(result->candidate_mean_ns, cand_mean_buf, sizeof(cand_mean_buf));
+    snprintf(speedup_buf, sizeof(speedup_buf), "%.3fx", result->speedup);
+    snprintf(ci_buf, sizeof(ci_buf), "[%.3f, %.3f]", result->speedup_lower, result->speedup_upper);
+    if (result->p_value < 1e-4) {
+        snprintf(p_buf, sizeof(p_buf), "<0.0001");
+    } else {
+        snprintf(p_buf, sizeof(p_buf), "%.4f", result->p_value);
+    }
+    const char *const cells[COMPARE_COLUMN_COUNT] = {
+        baseline, candidate, base_mean_buf, cand_mean_buf, speedup_buf, ci_buf, p_buf, verdict_name(result->verdict)
+    };
+    i_ezs_table_print_header("Benchmark Comparison", COMPARE_COLUMNS, COMPARE_COLUMN_COUNT);
+    i_ezs_table_print_row(COMPARE_COLUMNS, COMPARE_COLUMN_COUNT, cells);
+    i_ezs_table_print_footer(COMPARE_COLUMNS, COMPARE_COLUMN_COUNT);
+    printf("[EZS] Speedup = Base Mean / Cand Mean with a bootstrap CI, p-value from the Mann-Whitney U test\n\n");
+}
+
+bool ezs_benchmark_compare(const char *baseline, const char *candidate, ezs_benchmark_comparison *result) {
+    Distribution baseline_distribution = {}, candidate_distribution = {};
+    if (!load_distribution(baseline, &baseline_distribution)) {
+        return false;
+    }
+    if (!load_distribution(candidate, &candidate_distribution)) {
+        drop_distribution(&baseline_distribution);
+        return false;
+    }
+
+    ezs_benchmark_comparison comparison = {
+        .baseline_mean_ns = baseline_distribution.exact_mean_ns,
+        .candidate_mean_ns = candidate_distribution.exact_mean_ns,
+        .verdict = EZS_BENCHMARK_INDISTINGUISHABLE,
+    };
+    comparison.speedup = comparison.candidate_mean_ns > 0.0
+                             ? comparison.baseline_mean_ns / comparison.candidate_mean_ns
+                             : INFINITY;
+    const bool ok = bootstrap_speedup(&baseline_distribution, &candidate_distribution, &comparison);
+    comparison.p_value = mann_whitney_p_value(&baseline_distribution, &candidate_distribution);
+    drop_distribution(&baseline_distribution);
+    drop_distribution(&candidate_distribution);
+    if (!ok) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate memory for comparing '%s' and '%s'.\n", baseline, candidate);
+        return false;
+    }
+
+    if (comparison.p_value < SIGNIFICANCE_LEVEL) {
+        if (comparison.speedup_lower > 1.0) {
+            comparison.verdict = EZS_BENCHMARK_FASTER;
+        } else if (comparison.speedup_upper < 1.0) {
+            comparison.verdict = EZS_BENCHMARK_SLOWER;
+        }
+    }
+    print_comparison(baseline, candidate, &comparison);
+    if (nullptr != result) {
+        *result = comparison;
+    }
+    return true;
+}
+
+/*---------------------------清理局部宏---------------------------*/
+
+#undef COMPARE_COLUMN_COUNT
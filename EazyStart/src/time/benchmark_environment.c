@@ -0,0 +1,274 @@
+#if defined(__linux__)
+#define _GNU_SOURCE // NOLINT(*-reserved-identifier)
+#endif
+
+#include "EazyStart/time/benchmark_environment.h"
+#include "benchmark_internal.h"
+#include "table.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+
+// 构建类型与编译选项由CMake定义
+#ifndef EZS_BENCHMARK_BUILD_TYPE
+#define EZS_BENCHMARK_BUILD_TYPE ""
+#endif
+#ifndef EZS_BENCHMARK_COMPILE_FLAGS
+#define EZS_BENCHMARK_COMPILE_FLAGS ""
+#endif
+
+#if defined(__clang__)
+#define ENVIRONMENT_COMPILER "Clang " __clang_version__
+#elif defined(__GNUC__)
+#define ENVIRONMENT_COMPILER "GCC " __VERSION__
+#else
+#define ENVIRONMENT_COMPILER "unknown"
+#endif
+
+// 各项信息在i_ezs_benchmark_environment_field数组中的位置
+enum {
+    FIELD_CPU_MODEL,
+    FIELD_LOGICAL_CPUS,
+    FIELD_L1D_CACHE,
+    FIELD_L2_CACHE,
+    FIELD_L3_CACHE,
+    FIELD_KERNEL,
+    FIELD_COMPILER,
+    FIELD_COMPILE_FLAGS,
+    FIELD_BUILD_TYPE,
+    FIELD_PINNED_CPU,
+    FIELD_CPU_GOVERNOR,
+    FIELD_TURBO,
+};
+static_assert(FIELD_TURBO + 1 == I_EZS_BENCHMARK_ENVIRONMENT_FIELDS, "Environment fields mismatch.");
+
+// ezs_benchmark_setup_environment绑定的核心，-1表示没有绑定
+static _Atomic int g_pinned_cpu = -1;
+// 被绑定的线程的内核线程号，只有这个线程（以及之后由它创建的线程）运行在g_pinned_cpu上
+static _Atomic long g_pinned_thread = 0;
+
+/*---------------------------EZS_BENCHMARK_ENVIRONMENT 系统信息---------------------------*/
+
+#if defined(__linux__)
+
+// 读取文件的第一行存入buf，不含换行符
+// 文件不存在或为空时返回false
+static bool read_first_line(const char *path, char *buf, const size_t size) {
+    FILE *file = fopen(path, "r");
+    if (nullptr == file) {
+        return false;
+    }
+    const bool ok = nullptr != fgets(buf, (int) size, file);
+    fclose(file);
+    if (ok) {
+        buf[strcspn(buf, "\r\n")] = '\0';
+    }
+    return ok && '\0' != buf[0];
+}
+
+// 从/proc/cpuinfo中读取CPU型号
+static bool read_cpu_model(char *buf, const size_t size) {
+    FILE *file = fopen("/proc/cpuinfo", "r");
+    if (nullptr == file) {
+        return false;
+    }
+    // x86为"model name"，部分ARM平台为"Processor"或"Hardware"
+    static const char *const KEYS[] = {"model name", "Processor", "Hardware"};
+    bool found = false;
+    char line[512];
+    while (!found && nullptr != fgets(line, sizeof(line), file)) {
+        for (size_t i = 0; !found && i < sizeof(KEYS) / sizeof(KEYS[0]); i += 1) {
+            const size_t length = strlen(KEYS[i]);
+            const char *colon = strchr(line, ':');
+            if (0 == strncmp(line, KEYS[i], length) && nullptr != colon) {
+                const char *value = colon + 1 + strspn(colon + 1, " \t");
+                snprintf(buf, size, "%.*s", (int) strcspn(value, "\r\n"), value);
+                found = '\0' != buf[0];
+            }
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+// 从sysfs中读取cpu0的各级缓存大小，level为1时只读取数据缓存
+static bool read_cache_size(const int level, char *buf, const size_t size) {
+    for (int index = 0; index < 16; index += 1) {
+        char path[128], text[32];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+        if (!read_first_line(path, text, sizeof(text))) {
+            return false;
+        }
+        if (atoi(text) != level) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+        if (read_first_line(path, text, sizeof(text)) && 0 == strcmp("Instruction", text)) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+        return read_first_line(path, buf, size);
+    }
+    return false;
+}
+
+// 读取编号为cpu的核心的频率调节器
+static bool read_governor(const int cpu, char *buf, const size_t size) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpu);
+    return read_first_line(path, buf, size);
+}
+
+// 读取睿频的状态，1为开启，0为关闭，-1为未知
+static int read_turbo(void) {
+    char text[16];
+    // intel_pstate驱动中该值为1表示关闭睿频
+    if (read_first_line("/sys/devices/system/cpu/intel_pstate/no_turbo", text, sizeof(text))) {
+        return 0 == strcmp("1", text) ? 0 : 1;
+    }
+    if (read_first_line("/sys/devices/system/cpu/cpufreq/boost", text, sizeof(text))) {
+        return 0 == strcmp("1", text) ? 1 : 0;
+    }
+    return -1;
+}
+
+// 当前线程所在的核心：绑定后为绑定的核心，否则为当前正在运行的核心
+static int current_cpu(void) {
+    const int pinned = atomic_load_explicit(&g_pinned_cpu, memory_order_relaxed);
+    return pinned >= 0 ? pinned : sched_getcpu();
+}
+
+bool ezs_benchmark_setup_environment(const int cpu) {
+    bool ok = true;
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET((size_t) cpu, &set);
+        }
+        if (cpu >= CPU_SETSIZE || 0 != sched_setaffinity(0, sizeof(set), &set)) {
+            fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                    "Failed to pin the current thread to CPU %d.\n", cpu);
+            ok = false;
+        } else {
+            atomic_store_explicit(&g_pinned_thread, syscall(SYS_gettid), memory_order_relaxed);
+            atomic_store_explicit(&g_pinned_cpu, cpu, memory_order_relaxed);
+        }
+    }
+
+    const int checked = current_cpu();
+    char governor[64];
+    if (checked >= 0 && read_governor(checked, governor, sizeof(governor)) && 0 != strcmp("performance", governor)) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "The CPU frequency governor of CPU %d is '%s' rather than 'performance'. "
+                "Results may vary with the clock frequency.\n", checked, governor);
+    }
+    if (1 == read_turbo()) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Turbo boost is enabled. Results may vary with the temperature and the load of other cores.\n");
+    }
+    return ok;
+}
+
+#else
+
+bool ezs_benchmark_setup_environment(const int cpu) {
+    (void) cpu;
+    fprintf(stderr, "[EZS BENCHMARK][WARN] "
+            "Benchmark environment setup is only supported on Linux.\n");
+    return false;
+}
+
+#endif
+
+/*---------------------------EZS_BENCHMARK_ENVIRONMENT 报告---------------------------*/
+
+void i_ezs_benchmark_collect_environment(i_ezs_benchmark_environment_field fields[I_EZS_BENCHMARK_ENVIRONMENT_FIELDS]) {
+    static const char *const KEYS[I_EZS_BENCHMARK_ENVIRONMENT_FIELDS] = {
+        [FIELD_CPU_MODEL] = "cpu_model",
+        [FIELD_LOGICAL_CPUS] = "logical_cpus",
+        [FIELD_L1D_CACHE] = "l1d_cache",
+        [FIELD_L2_CACHE] = "l2_cache",
+        [FIELD_L3_CACHE] = "l3_cache",
+        [FIELD_KERNEL] = "kernel",
+        [FIELD_COMPILER] = "compiler",
+        [FIELD_COMPILE_FLAGS] = "compile_flags",
+        [FIELD_BUILD_TYPE] = "build_type",
+        [FIELD_PINNED_CPU] = "pinned_cpu",
+        [FIELD_CPU_GOVERNOR] = "cpu_governor",
+        [FIELD_TURBO] = "turbo",
+    };
+    for (size_t i = 0; i < I_EZS_BENCHMARK_ENVIRONMENT_FIELDS; i += 1) {
+        fields[i].key = KEYS[i];
+        snprintf(fields[i].value, sizeof(fields[i].value), "unknown");
+    }
+    snprintf(fields[FIELD_COMPILER].value, sizeof(fields[FIELD_COMPILER].value), "%s", ENVIRONMENT_COMPILER);
+    snprintf(fields[FIELD_COMPILE_FLAGS].value, sizeof(fields[FIELD_COMPILE_FLAGS].value), "%s",
+             '\0' != EZS_BENCHMARK_COMPILE_FLAGS[0] ? EZS_BENCHMARK_COMPILE_FLAGS : "none");
+    snprintf(fields[FIELD_BUILD_TYPE].value, sizeof(fields[FIELD_BUILD_TYPE].value), "%s",
+             '\0' != EZS_BENCHMARK_BUILD_TYPE[0] ? EZS_BENCHMARK_BUILD_TYPE : "none");
+    const int pinned = atomic_load_explicit(&g_pinned_cpu, memory_order_relaxed);
+    if (pinned >= 0) {
+        // 绑定只作用于调用ezs_benchmark_setup_environment的线程，因此同时给出该线程
+        snprintf(fields[FIELD_PINNED_CPU].value, sizeof(fields[FIELD_PINNED_CPU].value), "%d (thread %ld)",
+                 pinned, atomic_load_explicit(&g_pinned_thread, memory_order_relaxed));
+    } else {
+        snprintf(fields[FIELD_PINNED_CPU].value, sizeof(fields[FIELD_PINNED_CPU].value), "none");
+    }
+#if defined(__linux__)
+    read_cpu_model(fields[FIELD_CPU_MODEL].value, sizeof(fields[FIELD_CPU_MODEL].value));
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > 0) {
+        snprintf(fields[FIELD_LOGICAL_CPUS].value, sizeof(fields[FIELD_LOGICAL_CPUS].value), "%ld", cpus);
+    }
+    for (int level = 1; level <= 3; level += 1) {
+        i_ezs_benchmark_environment_field *field = &fields[FIELD_L1D_CACHE + level - 1];
+        read_cache_size(level, field->value, sizeof(field->value));
+    }
+    struct utsname name;
+    if (0 == uname(&name)) {
+        snprintf(fields[FIELD_KERNEL].value, sizeof(fields[FIELD_KERNEL].value), "%s %s %s",
+                 name.sysname, name.release, name.machine);
+    }
+    const int cpu = current_cpu();
+    if (cpu >= 0) {
+        read_governor(cpu, fields[FIELD_CPU_GOVERNOR].value, sizeof(fields[FIELD_CPU_GOVERNOR].value));
+    }
+    const int turbo = read_turbo();
+    if (turbo >= 0) {
+        snprintf(fields[FIELD_TURBO].value, sizeof(fields[FIELD_TURBO].value), "%s", 1 == turbo ? "on" : "off");
+    }
+#endif
+}
+
+void i_ezs_benchmark_environment_print(void) {
+    i_ezs_benchmark_environment_field fields[I_EZS_BENCHMARK_ENVIRONMENT_FIELDS];
+    i_ezs_benchmark_collect_environment(fields);
+    i_ezs_table_column columns[] = {
+        {"Item", 14, true},
+        {"Value", 40, true},
+    };
+    for (size_t i = 0; i < I_EZS_BENCHMARK_ENVIRONMENT_FIELDS; i += 1) {
+        const int length = (int) strlen(fields[i].value);
+        columns[1].width = length > columns[1].width ? length : columns[1].width;
+    }
+    i_ezs_table_print_header("Benchmark Environment", columns, 2);
+    for (size_t i = 0; i < I_EZS_BENCHMARK_ENVIRONMENT_FIELDS; i += 1) {
+        const char *const cells[] = {fields[i].key, fields[i].value};
+        i_ezs_table_print_row(columns, 2, cells);
+    }
+    i_ezs_table_print_footer(columns, 2);
+}
+
+/*---------------------------清理局部宏---------------------------*/
+
+#undef ENVIRONMENT_COMPILER
@@ -0,0 +1,787 @@
+#include "EazyStart/time/benchmark_export.h"
+#include "EazyStart/time/benchmark.h"
+#include "benchmark_internal.h"
+#include "table.h"
+#include <ctype.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*---------------------------EZS_BENCHMARK_EXPORT 字段---------------------------*/
+
+// 导出文件中的数值字段，导出与读取基线共用同一张表
+// count单独处理，不在表中
+typedef struct {
+    const char *key;
+    size_t offset; // 在i_ezs_benchmark_summary中的偏移
+} SummaryField;
+
+static const SummaryField SUMMARY_FIELDS[] = {
+    {"mean_ns", offsetof(i_ezs_benchmark_summary, mean_ns)},
+    {"min_ns", offsetof(i_ezs_benchmark_summary, min_ns)},
+    {"max_ns", offsetof(i_ezs_benchmark_summary, max_ns)},
+    {"std_dev_ns", offsetof(i_ezs_benchmark_summary, std_dev_ns)},
+    {"rsd_percent", offsetof(i_ezs_benchmark_summary, rsd_percent)},
+    {"p50_ns", offsetof(i_ezs_benchmark_summary, p50_ns)},
+    {"p95_ns", offsetof(i_ezs_benchmark_summary, p95_ns)},
+    {"p99_ns", offsetof(i_ezs_benchmark_summary, p99_ns)},
+    {"p999_ns", offsetof(i_ezs_benchmark_summary, p999_ns)},
+    {"mad_ns", offsetof(i_ezs_benchmark_summary, mad_ns)},
+    {"iqr_ns", offsetof(i_ezs_benchmark_summary, iqr_ns)},
+    {"outliers", offsetof(i_ezs_benchmark_summary, outliers)},
+    {"items_per_second", offsetof(i_ezs_benchmark_summary, items_per_second)},
+    {"bytes_per_second", offsetof(i_ezs_benchmark_summary, bytes_per_second)},
+};
+#define SUMMARY_FIELD_COUNT (sizeof(SUMMARY_FIELDS) / sizeof(SUMMARY_FIELDS[0]))
+
+// 导出格式的版本号，格式发生不兼容的变化时递增
+static constexpr int EXPORT_FORMAT_VERSION = 1;
+
+static double *field_of(i_ezs_benchmark_summary *summary, const SummaryField *field) {
+    return (double *) ((char *) summary + field->offset);
+}
+
+static double field_value(const i_ezs_benchmark_summary *summary, const SummaryField *field) {
+    return *(const double *) ((const char *) summary + field->offset);
+}
+
+// 按键名查找字段，不存在时返回nullptr
+static const SummaryField *find_field(const char *key) {
+    for (size_t i = 0; i < SUMMARY_FIELD_COUNT; i += 1) {
+        if (0 == strcmp(SUMMARY_FIELDS[i].key, key)) {
+            return &SUMMARY_FIELDS[i];
+        }
+    }
+    return nullptr;
+}
+
+/*---------------------------EZS_BENCHMARK_EXPORT 导出---------------------------*/
+
+// 以JSON字符串的形式写入text，包括两侧的引号
+static void write_json_string(FILE *file, const char *text) {
+    fputc('"', file);
+    for (const unsigned char *p = (const unsigned char *) text; '\0' != *p; p += 1) {
+        switch (*p) {
+            case '"': fputs("\\\"", file); break;
+            case '\\': fputs("\\\\", file); break;
+            case '\n': fputs("\\n", file); break;
+            case '\r': fputs("\\r", file); break;
+            case '\t': fputs("\\t", file); break;
+            default:
+                if (*p < 0x20) {
+                    fprintf(file, "\\u%04x", *p);
+                } else {
+                    fputc(*p, file);
+                }
+        }
+    }
+    fputc('"', file);
+}
+
+// 以JSON对象的形式写入运行环境信息
+static void write_json_environment(FILE *file) {
+    i_ezs_benchmark_environment_field fields[I_EZS_BENCHMARK_ENVIRONMENT_FIELDS];
+    i_ezs_benchmark_collect_environment(fields);
+    for (size_t i = 0; i < I_EZS_BENCHMARK_ENVIRONMENT_FIELDS; i += 1) {
+        fprintf(file, "%s\"%s\": ", 0 == i ? "{" : ", ", fields[i].key);
+        write_json_string(file, fields[i].value);
+    }
+    fputc('}', file);
+}
+
+// 以CSV单元格的形式写入text，包含逗号、引号或换行时加引号
+static void write_csv_string(FILE *file, const char *text) {
+    if (nullptr == strpbrk(text, ",\"\r\n")) {
+        fputs(text, file);
+        return;
+    }
+    fputc('"', file);
+    for (const char *p = text; '\0' != *p; p += 1) {
+        if ('"' == *p) {
+            fputc('"', file);
+        }
+        fputc(*p, file);
+    }
+    fputc('"', file);
+}
+
+// 关闭导出的文件，并检查写入过程中是否出错
+static bool finish_export(FILE *file, const char *path) {
+    const bool has_error = 0 != ferror(file);
+    if (0 != fclose(file) || has_error) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to write the benchmark export '%s'.\n", path);
+        return false;
+    }
+    return true;
+}
+
+// 打开导出的文件并汇总所有条目
+// 失败时返回nullptr
+static FILE *begin_export(const char *path, i_ezs_benchmark_summary **summaries, size_t *count) {
+    *summaries = i_ezs_benchmark_collect_summaries(count);
+    if (nullptr == *summaries) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to collect benchmark statistics for export.\n");
+        return nullptr;
+    }
+    FILE *file = fopen(path, "w");
+    if (nullptr == file) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to open '%s' for the benchmark export.\n", path);
+        i_ezs_benchmark_summaries_drop(*summaries, *count);
+        return nullptr;
+    }
+    return file;
+}
+
+bool ezs_benchmark_export_json(const char *path) {
+    i_ezs_benchmark_summary *summaries = nullptr;
+    size_t count = 0;
+    FILE *file = begin_export(path, &summaries, &count);
+    if (nullptr == file) {
+        return false;
+    }
+    fprintf(file, "{\n  \"version\": %d,\n", EXPORT_FORMAT_VERSION);
+    fputs("  \"environment\": ", file);
+    write_json_environment(file);
+    fputs(",\n", file);
+    struct timespec overhead_median = {}, overhead_min = {};
+    if (ezs_benchmark_timer_overhead(&overhead_median, &overhead_min)) {
+        fprintf(file, "  \"timer_overhead_ns\": {\"median\": %.3f, \"min\": %.3f},\n",
+                (double) overhead_median.tv_sec * 1e9 + (double) overhead_median.tv_nsec,
+                (double) overhead_min.tv_sec * 1e9 + (double) overhead_min.tv_nsec);
+    }
+    fputs("  \"benchmarks\": [", file);
+    for (size_t i = 0; i < count; i += 1) {
+        fputs(0 == i ? "\n    {\"name\": " : ",\n    {\"name\": ", file);
+        write_json_string(file, summaries[i].name);
+        fprintf(file, ", \"count\": %" PRIu64, summaries[i].count);
+        for (size_t j = 0; j < SUMMARY_FIELD_COUNT; j += 1) {
+            fprintf(file, ", \"%s\": %.3f", SUMMARY_FIELDS[j].key, field_value(&summaries[i], &SUMMARY_FIELDS[j]));
+        }
+        fputc('}', file);
+    }
+    fputs(0 == count ? "]\n}\n" : "\n  ]\n}\n", file);
+    i_ezs_benchmark_summaries_drop(summaries, count);
+    return finish_export(file, path);
+}
+
+bool ezs_benchmark_export_csv(const char *path) {
+    i_ezs_benchmark_summary *summaries = nullptr;
+    size_t count = 0;
+    FILE *file = begin_export(path, &summaries, &count);
+    if (nullptr == file) {
+        return false;
+    }
+    fputs("name,count", file);
+    for (size_t j = 0; j < SUMMARY_FIELD_COUNT; j += 1) {
+        fprintf(file, ",%s", SUMMARY_FIELDS[j].key);
+    }
+    fputc('\n', file);
+    for (size_t i = 0; i < count; i += 1) {
+        write_csv_string(file, summaries[i].name);
+        fprintf(file, ",%" PRIu64, summaries[i].count);
+        for (size_t j = 0; j < SUMMARY_FIELD_COUNT; j += 1) {
+            fprintf(file, ",%.3f", field_value(&summaries[i], &SUMMARY_FIELDS[j]));
+        }
+        fputc('\n', file);
+    }
+    i_ezs_benchmark_summaries_drop(summaries, count);
+    return finish_export(file, path);
+}
+
+/*---------------------------EZS_BENCHMARK_EXPORT 时间线---------------------------*/
+
+bool ezs_benchmark_export_trace(const char *path) {
+    const size_t capacity = ezs_benchmark_samples(nullptr, 0);
+    ezs_benchmark_sample *samples = malloc((capacity > 0 ? capacity : 1) * sizeof(*samples));
+    if (nullptr == samples) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate memory for the trace export.\n");
+        return false;
+    }
+    // 两次调用之间其他线程可能又写入了样本，以实际复制的数量为准
+    size_t count = ezs_benchmark_samples(samples, capacity);
+    count = count < capacity ? count : capacity;
+    if (0 == count) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "No captured samples to export. Call ezs_benchmark_enable_capture before timing.\n");
+    }
+    FILE *file = fopen(path, "w");
+    if (nullptr == file) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to open '%s' for the trace export.\n", path);
+        free(samples);
+        return false;
+    }
+
+    uint64_t origin_ns = UINT64_MAX;
+    uint32_t thread_count = 0;
+    for (size_t i = 0; i < count; i += 1) {
+        origin_ns = samples[i].start_ns < origin_ns ? samples[i].start_ns : origin_ns;
+        thread_count = samples[i].thread >= thread_count ? samples[i].thread + 1 : thread_count;
+    }
+
+    fputs("{\"displayTimeUnit\": \"ns\", \"otherData\": ", file);
+    write_json_environment(file);
+    fputs(", \"traceEvents\": [", file);
+    bool is_first = true;
+    // 线程名称的元数据事件
+    for (uint32_t thread = 0; thread < thread_count; thread += 1) {
+        fprintf(file, "%s\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %" PRIu32
+                ", \"args\": {\"name\": \"EZS Thread %" PRIu32 "\"}}", is_first ? "" : ",", thread, thread);
+        is_first = false;
+    }
+    // 每个样本是一个完整事件，ts与dur的单位为微秒
+    for (size_t i = 0; i < count; i += 1) {
+        const char *name = ezs_benchmark_name(samples[i].id);
+        if (nullptr == name) {
+            continue;
+        }
+        fputs(is_first ? "\n  {\"name\": " : ",\n  {\"name\": ", file);
+        is_first = false;
+        write_json_string(file, name);
+        fprintf(file, ", \"cat\": \"ezs\", \"ph\": \"X\", \"pid\": 1, \"tid\": %" PRIu32
+                ", \"ts\": %.3f, \"dur\": %.3f}",
+                samples[i].thread,
+                (double) (samples[i].start_ns - origin_ns) / 1e3,
+                (double) (samples[i].end_ns - samples[i].start_ns) / 1e3);
+    }
+    fputs(is_first ? "]}\n" : "\n]}\n", file);
+    free(samples);
+    return finish_export(file, path);
+}
+
+/*---------------------------EZS_BENCHMARK_EXPORT 读取基线---------------------------*/
+
+// 读取的基线条目列表
+typedef struct {
+    i_ezs_benchmark_summary *items;
+    size_t count;
+    size_t capacity;
+} Baseline;
+
+// 追加一个条目，所有字段初始化为NAN，表示基线中没有该字段
+// 失败时返回nullptr
+static i_ezs_benchmark_summary *add_baseline_item(Baseline *baseline) {
+    if (baseline->count == baseline->capacity) {
+        const size_t new_capacity = baseline->capacity > 0 ? baseline->capacity * 2 : 16;
+        i_ezs_benchmark_summary *items = realloc(baseline->items, new_capacity * sizeof(*items));
+        if (nullptr == items) {
+            return nullptr;
+        }
+        baseline->items = items;
+        baseline->capacity = new_capacity;
+    }
+    i_ezs_benchmark_summary *item = &baseline->items[baseline->count];
+    *item = (i_ezs_benchmark_summary){};
+    for (size_t i = 0; i < SUMMARY_FIELD_COUNT; i += 1) {
+        *field_of(item, &SUMMARY_FIELDS[i]) = NAN;
+    }
+    baseline->count += 1;
+    return item;
+}
+
+// 为条目设置一个字段，未知的字段被忽略，以兼容更新版本导出的文件
+static void set_baseline_field(i_ezs_benchmark_summary *item, const char *key, const double value) {
+    if (0 == strcmp("count", key)) {
+        item->count = value > 0.0 ? (uint64_t) value : 0;
+        return;
+    }
+    const SummaryField *field = find_field(key);
+    if (nullptr != field) {
+        *field_of(item, field) = value;
+    }
+}
+
+// 读取整个文件，结果以'\0'结尾
+// 失败时返回nullptr
+static char *read_file(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (nullptr == file) {
+        return nullptr;
+    }
+    size_t size = 0, capacity = 4096;
+    char *content = malloc(capacity);
+    while (nullptr != content) {
+        size += fread(content + size, 1, capacity - size - 1, file);
+        if (size < capacity - 1) {
+            break;
+        }
+        capacity *= 2;
+        char *grown = realloc(content, capacity);
+        if (nullptr == grown) {
+            free(content);
+            content = nullptr;
+        } else {
+            content = grown;
+        }
+    }
+    const bool has_error = 0 != ferror(file);
+    fclose(file);
+    if (nullptr == content || has_error) {
+        free(content);
+        return nullptr;
+    }
+    content[size] = '\0';
+    return content;
+}
+
+// 只支持导出文件所用到的JSON子集：对象、数组、字符串、数字与字面量
+typedef struct {
+    const char *p;
+} JsonParser;
+
+static void skip_json_whitespace(JsonParser *parser) {
+    while (isspace((unsigned char) *parser->p)) {
+        parser->p += 1;
+    }
+}
+
+// 检查并跳过字符c
+static bool consume_json(JsonParser *parser, const char c) {
+    skip_json_whitespace(parser);
+    if (*parser->p != c) {
+        return false;
+    }
+    parser->p += 1;
+    return true;
+}
+
+// 读取一个字符串，结果由调用者释放
+// 失败时返回nullptr
+static char *parse_json_string(JsonParser *parser) {
+    if (!consume_json(parser, '"')) {
+        return nullptr;
+    }
+    // 转义后的长度不会超过原文
+    const char *end = parser->p;
+    while ('"' != *end) {
+        if ('\0' == *end || ('\\' == *end && '\0' == *(end + 1))) {
+            return nullptr;
+        }
+        end += '\\' == *end ? 2 : 1;
+    }
+    char *text = malloc((size_t) (end - parser->p) + 1);
+    if (nullptr == text) {
+        return nullptr;
+    }
+    size_t length = 0;
+    while (parser->p < end) {
+        char c = *parser->p;
+        parser->p += 1;
+        if ('\\' == c) {
+            c = *parser->p;
+            parser->p += 1;
+            switch (c) {
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'u': {
+                    // 导出时只会对控制字符使用\u转义
+                    unsigned int code = 0;
+                    if (1 != sscanf(parser->p, "%4x", &code) || end - parser->p < 4 || code > 0x7F) {
+                        free(text);
+                        return nullptr;
+                    }
+                    parser->p += 4;
+                    c = (char) code;
+                    break;
+                }
+                default: break; // '"'、'\\'与'/'原样保留
+            }
+        }
+        text[length] = c;
+        length += 1;
+    }
+    text[length] = '\0';
+    parser->p = end + 1;
+    return text;
+}
+
+static bool parse_json_number(JsonParser *parser, double *value) {
+    skip_json_whitespace(parser);
+    char *end = nullptr;
+    *value = strtod(parser->p, &end);
+    if (end == parser->p) {
+        return false;
+    }
+    parser->p = end;
+    return true;
+}
+
+// 跳过任意一个值
+static bool skip_json_value(JsonParser *parser, const int depth) {
+    if (depth > 64) {
+        return false;
+    }
+    skip_json_whitespace(parser);
+    const char c = *parser->p;
+    if ('"' == c) {
+        char *text = parse_json_string(parser);
+        free(text);
+        return nullptr != text;
+    }
+    if ('{' == c || '[' == c) {
+        const char close = '{' == c ? '}' : ']';
+        parser->p += 1;
+        if (consume_json(parser, close)) {
+            return true;
+        }
+        do {
+            if ('{' == c) {
+                char *key = parse_json_string(parser);
+                free(key);
+                if (nullptr == key || !consume_json(parser, ':')) {
+                    return false;
+                }
+            }
+            if (!skip_json_value(parser, depth + 1)) {
+                return false;
+            }
+        } while (consume_json(parser, ','));
+        return consume_json(parser, close);
+    }
+    const char *literal = 't' == c ? "true" : 'f' == c ? "false" : 'n' == c ? "null" : nullptr;
+    if (nullptr != literal) {
+        const size_t length = strlen(literal);
+        if (0 != strncmp(parser->p, literal, length)) {
+            return false;
+        }
+        parser->p += length;
+        return true;
+    }
+    double ignored = 0.0;
+    return parse_json_number(parser, &ignored);
+}
+
+// 读取benchmarks数组中的一个条目对象
+static bool parse_json_benchmark(JsonParser *parser, Baseline *baseline) {
+    i_ezs_benchmark_summary *item = add_baseline_item(baseline);
+    if (nullptr == item || !consume_json(parser, '{')) {
+        return false;
+    }
+    if (consume_json(parser, '}')) {
+        return true;
+    }
+    do {
+        char *key = parse_json_string(parser);
+        if (nullptr == key || !consume_json(parser, ':')) {
+            free(key);
+            return false;
+        }
+        skip_json_whitespace(parser);
+        bool ok = true;
+        if (0 == strcmp("name", key)) {
+            free(item->name);
+            item->name = parse_json_string(parser);
+            ok = nullptr != item->name;
+        } else if ('-' == *parser->p || isdigit((unsigned char) *parser->p)) {
+            double value = 0.0;
+            ok = parse_json_number(parser, &value);
+            set_baseline_field(item, key, value);
+        } else {
+            ok = skip_json_value(parser, 1);
+        }
+        free(key);
+        if (!ok) {
+            return false;
+        }
+    } while (consume_json(parser, ','));
+    return consume_json(parser, '}') && nullptr != item->name;
+}
+
+static bool parse_json_baseline(const char *content, Baseline *baseline) {
+    JsonParser parser = {.p = content};
+    if (!consume_json(&parser, '{')) {
+        return false;
+    }
+    if (consume_json(&parser, '}')) {
+        return true;
+    }
+    do {
+        char *key = parse_json_string(&parser);
+        if (nullptr == key || !consume_json(&parser, ':')) {
+            free(key);
+            return false;
+        }
+        const bool is_benchmarks = 0 == strcmp("benchmarks", key);
+        free(key);
+        if (!is_benchmarks) {
+            if (!skip_json_value(&parser, 1)) {
+                return false;
+            }
+            continue;
+        }
+        if (!consume_json(&parser, '[')) {
+            return false;
+        }
+        if (consume_json(&parser, ']')) {
+            continue;
+        }
+        do {
+            if (!parse_json_benchmark(&parser, baseline)) {
+                return false;
+            }
+        } while (consume_json(&parser, ','));
+        if (!consume_json(&parser, ']')) {
+            return false;
+        }
+    } while (consume_json(&parser, ','));
+    return consume_json(&parser, '}');
+}
+
+// 读取CSV的一个单元格，p指向单元格的开头，读取后指向分隔符或行尾
+// 结果由调用者释放，失败时返回nullptr
+static char *parse_csv_cell(const char **p) {
+    const char *begin = *p;
+    const bool quoted = '"' == *begin;
+    size_t capacity = 0;
+    if (quoted) {
+        const char *end = begin + 1;
+        while ('\0' != *end && !('"' == *end && '"' != *(end + 1))) {
+            end += '"' == *end ? 2 : 1;
+        }
+        if ('"' != *end) {
+            return nullptr;
+        }
+        capacity = (size_t) (end - begin);
+    } else {
+        capacity = strcspn(begin, ",\r\n") + 1;
+    }
+    char *text = malloc(capacity);
+    if (nullptr == text) {
+        return nullptr;
+    }
+    size_t length = 0;
+    if (quoted) {
+        *p += 1;
+        while (!('"' == **p && '"' != *(*p + 1))) {
+            text[length] = **p;
+            length += 1;
+            *p += '"' == **p ? 2 : 1;
+        }
+        *p += 1;
+    } else {
+        length = capacity - 1;
+        memcpy(text, begin, length);
+        *p += length;
+    }
+    text[length] = '\0';
+    return text;
+}
+
+static bool parse_csv_baseline(const char *content, Baseline *baseline) {
+    // 读取列名
+    char **columns = nullptr;
+    size_t column_count = 0;
+    const char *p = content;
+    bool ok = true;
+    while (ok) {
+        char *column = parse_csv_cell(&p);
+        char **grown = nullptr == column ? nullptr : realloc(columns, (column_count + 1) * sizeof(*columns));
+        if (nullptr == grown) {
+            free(column);
+            ok = false;
+            break;
+        }
+        columns = grown;
+        columns[column_count] = column;
+        column_count += 1;
+        if (',' != *p) {
+            break;
+        }
+        p += 1;
+    }
+
+    // 逐行读取条目
+    while (ok) {
+        p += strspn(p, "\r\n");
+        if ('\0' == *p) {
+            break;
+        }
+        i_ezs_benchmark_summary *item = add_baseline_item(baseline);
+        ok = nullptr != item;
+        for (size_t column = 0; ok; column += 1) {
+            char *cell = parse_csv_cell(&p);
+            if (nullptr == cell) {
+                ok = false;
+                break;
+            }
+            if (column < column_count) {
+                if (0 == strcmp("name", columns[column])) {
+                    free(item->name);
+                    item->name = cell;
+                    cell = nullptr;
+                } else {
+                    char *end = nullptr;
+                    const double value = strtod(cell, &end);
+                    if (end != cell) {
+                        set_baseline_field(item, columns[column], value);
+                    }
+                }
+            }
+            free(cell);
+            if (',' != *p) {
+                break;
+            }
+            p += 1;
+        }
+        ok = ok && nullptr != item->name;
+    }
+
+    for (size_t i = 0; i < column_count; i += 1) {
+        free(columns[i]);
+    }
+    free(columns);
+    return ok;
+}
+
+// 读取基线文件，按内容识别格式：以'{'开头的视为JSON，否则视为CSV
+static bool load_baseline(const char *path, Baseline *baseline) {
+    char *content = read_file(path);
+    if (nullptr == content) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to read the benchmark baseline '%s'.\n", path);
+        return false;
+    }
+    const char *first = content + strspn(content, " \t\r\n");
+    const bool ok = '{' == *first
+                        ? parse_json_baseline(content, baseline)
+                        : parse_csv_baseline(content, baseline);
+    free(content);
+    if (!ok) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "The benchmark baseline '%s' is malformed.\n", path);
+    }
+    return ok;
+}
+
+/*---------------------------EZS_BENCHMARK_EXPORT 基线对比---------------------------*/
+
+// 参与退化判断的指标
+static const char *const COMPARED_FIELDS[] = {"mean_ns", "p50_ns", "p95_ns", "p99_ns"};
+#define COMPARED_FIELD_COUNT (sizeof(COMPARED_FIELDS) / sizeof(COMPARED_FIELDS[0]))
+
+static const i_ezs_table_column COMPARISON_COLUMNS[] = {
+    {"Benchmark Name", 20, true},
+    {"Base Mean", 10, false},
+    {"Mean", 10, false},
+    {"Mean Diff", 10, false},
+    {"P50 Diff", 10, false},
+    {"P95 Diff", 10, false},
+    {"P99 Diff", 10, false},
+    {"Status", 9, false},
+};
+#define COMPARISON_COLUMN_COUNT (sizeof(COMPARISON_COLUMNS) / sizeof(COMPARISON_COLUMNS[0]))
+
+static int compare_summary_name(const void *lhs, const void *rhs) {
+    return strcmp(((const i_ezs_benchmark_summary *) lhs)->name, ((const i_ezs_benchmark_summary *) rhs)->name);
+}
+
+// 在按名称排序的列表中查找条目，不存在时返回nullptr
+static const i_ezs_benchmark_summary *find_summary(const i_ezs_benchmark_summary *items, const size_t count,
+                                                   const char *name) {
+    if (0 == count) {
+        return nullptr;
+    }
+    const i_ezs_benchmark_summary key = {.name = (char *) name};
+    return bsearch(&key, items, count, sizeof(*items), compare_summary_name);
+}
+
+// 打印一个条目的对比结果，返回是否退化
+// current与base可以有一个为nullptr
+static bool print_comparison(const char *name, const i_ezs_benchmark_summary *base,
+                             const i_ezs_benchmark_summary *current, const double threshold) {
+    char base_mean_buf[32] = "N/A", mean_buf[32] = "N/A";
+    char diff_bufs[COMPARED_FIELD_COUNT][32] = {"N/A", "N/A", "N/A", "N/A"};
+    const char *status = nullptr == base ? "new" : nullptr == current ? "missing" : "ok";
+    bool regressed = false;
+    if (nullptr != base && isfinite(base->mean_ns)) {
+        i_ezs_table_format_nanoseconds(base->mean_ns, base_mean_buf, sizeof(base_mean_buf));
+    }
+    if (nullptr != current) {
+        i_ezs_table_format_nanoseconds(current->mean_ns, mean_buf, sizeof(mean_buf));
+    }
+    for (size_t i = 0; nullptr != base && nullptr != current && i < COMPARED_FIELD_COUNT; i += 1) {
+        const SummaryField *field = find_field(COMPARED_FIELDS[i]);
+        const double before = field_value(base, field);
+        const double after = field_value(current, field);
+        if (!isfinite(before) || before <= 0.0) {
+            continue;
+        }
+        const double change = (after - before) / before;
+        snprintf(diff_bufs[i], sizeof(diff_bufs[i]), "%+.2f%%", change * 100.0);
+        if (change > threshold) {
+            regressed = true;
+        }
+    }
+    if (regressed) {
+        status = "REGRESSED";
+    }
+    const char *const cells[COMPARISON_COLUMN_COUNT] = {
+        name, base_mean_buf, mean_buf, diff_bufs[0], diff_bufs[1], diff_bufs[2], diff_bufs[3], status
+    };
+    i_ezs_table_print_row(COMPARISON_COLUMNS, COMPARISON_COLUMN_COUNT, cells);
+    return regressed;
+}
+
+int ezs_benchmark_compare_baseline(const char *path, const double threshold) {
+    if (!(threshold >= 0.0)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "The regression threshold must be non-negative.\n");
+        return EXIT_FAILURE;
+    }
+    Baseline baseline = {};
+    if (!load_baseline(path, &baseline)) {
+        i_ezs_benchmark_summaries_drop(baseline.items, baseline.count);
+        return EXIT_FAILURE;
+    }
+    size_t count = 0;
+    i_ezs_benchmark_summary *summaries = i_ezs_benchmark_collect_summaries(&count);
+    if (nullptr == summaries) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to collect benchmark statistics for the baseline comparison.\n");
+        i_ezs_benchmark_summaries_drop(baseline.items, baseline.count);
+        return EXIT_FAILURE;
+    }
+    if (baseline.count > 0) {
+        qsort(baseline.items, baseline.count, sizeof(*baseline.items), compare_summary_name);
+    }
+    if (count > 0) {
+        qsort(summaries, count, sizeof(*summaries), compare_summary_name);
+    }
+
+    size_t regressed_count = 0;
+    i_ezs_table_print_header("Baseline Comparison", COMPARISON_COLUMNS, COMPARISON_COLUMN_COUNT);
+    for (size_t i = 0; i < count; i += 1) {
+        const i_ezs_benchmark_summary *base = find_summary(baseline.items, baseline.count, summaries[i].name);
+        if (print_comparison(summaries[i].name, base, &summaries[i], threshold)) {
+            regressed_count += 1;
+        }
+    }
+    for (size_t i = 0; i < baseline.count; i += 1) {
+        if (nullptr == find_summary(summaries, count, baseline.items[i].name)) {
+            print_comparison(baseline.items[i].name, &baseline.items[i], nullptr, threshold);
+        }
+    }
+    i_ezs_table_print_footer(COMPARISON_COLUMNS, COMPARISON_COLUMN_COUNT);
+    printf("[EZS] Compared with baseline '%s' (threshold %.2f%%): %zu regressed\n\n",
+           path, threshold * 100.0, regressed_count);
+
+    i_ezs_benchmark_summaries_drop(summaries, count);
+    i_ezs_benchmark_summaries_drop(baseline.items, baseline.count);
+    return 0 == regressed_count ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*---------------------------清理局部宏---------------------------*/
+
+#undef SUMMARY_FIELD_COUNT
+#undef COMPARED_FIELD_COUNT
+#undef COMPARISON_COLUMN_COUNT
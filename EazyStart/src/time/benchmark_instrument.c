@@ -0,0 +1,559 @@
+#if defined(__linux__)
+#define _GNU_SOURCE // NOLINT(*-reserved-identifier)
+#endif
+
+#include "EazyStart/time/benchmark_instrument.h"
+#include "benchmark_internal.h"
+#include "table.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__linux__) && defined(EZS_BENCHMARK_INSTRUMENT_FUNCTIONS)
+#include <dlfcn.h>
+#include <fnmatch.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <threads.h>
+
+/*---------------------------EZS_BENCHMARK_INSTRUMENT 记录---------------------------*/
+
+/*
+ * 每个线程拥有一张以函数地址为键的开放寻址哈希表与一个调用栈，钩子只访问本线程的数据，不加锁
+ * 函数表写满后新出现的函数不再记录，调用栈超过最大深度后更深的调用不计时，二者都计入未计时的调用数
+ * 入口钩子总是压入一帧（不计时的调用只记录函数地址），出口钩子弹出到与函数地址匹配的帧，
+ * 因此被longjmp跳过的出口不会使之后的调用栈错位
+ * 被插桩的函数在计时的父帧中计为子函数耗时，不计时的帧把其子函数的耗时转交给父帧
+ *
+ * 报告读取其他线程的函数表时不加锁，可能读到正在更新的数据，与benchmark条目的合并一致
+ * 线程退出后其函数表仍然保留在链表中，直到进程结束
+ */
+
+// 每个线程的函数表容量，必须是2的幂
+#define INSTRUMENT_TABLE_CAPACITY 4096
+// 函数表的最大装载量，超过后新出现的函数不再记录
+static constexpr size_t INSTRUMENT_TABLE_LIMIT = INSTRUMENT_TABLE_CAPACITY / 4 * 3;
+// 每个线程调用栈的最大深度
+#define INSTRUMENT_MAX_DEPTH 256
+// 报告中打印的函数数量
+static constexpr size_t INSTRUMENT_TOP_FUNCTIONS = 30;
+// 解析后的函数名的最大长度
+#define INSTRUMENT_NAME_SIZE 128
+
+typedef struct {
+    void *function; // nullptr表示空槽
+    uint_fast32_t filter_generation; // included所对应的过滤器版本，0表示尚未判断
+    bool included; // 是否通过运行期过滤器
+    uint32_t active; // 正在执行的层数，递归调用只在最外层返回时计入总耗时
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t self_ns;
+} FunctionSlot;
+
+typedef struct {
+    void *function;
+    FunctionSlot *slot; // 不计时的调用为nullptr
+    uint64_t start_ns;
+    uint64_t child_ns; // 被插桩的子函数的总耗时
+} InstrumentFrame;
+
+typedef struct InstrumentThread {
+    struct InstrumentThread *next;
+    uint64_t untracked_calls; // 函数表已满或调用栈过深而未计时的调用
+    size_t slot_count;
+    size_t depth;
+    size_t overflow_depth; // 超过INSTRUMENT_MAX_DEPTH的层数
+    InstrumentFrame frames[INSTRUMENT_MAX_DEPTH];
+    FunctionSlot slots[INSTRUMENT_TABLE_CAPACITY];
+} InstrumentThread;
+
+static once_flag g_instrument_lock_once = ONCE_FLAG_INIT;
+static mtx_t g_instrument_lock;
+// 以下由g_instrument_lock保护
+static InstrumentThread *g_instrument_threads = nullptr;
+static char **g_include_patterns = nullptr;
+static size_t g_include_count = 0;
+static char **g_exclude_patterns = nullptr;
+static size_t g_exclude_count = 0;
+// 过滤器每次改变时递增，函数表中的判断结果在版本不一致时重新计算
+static _Atomic uint_fast32_t g_filter_generation = 1;
+static _Atomic bool g_is_instrument_enabled = true;
+
+static thread_local InstrumentThread *t_instrument_thread = nullptr;
+static thread_local bool t_is_instrument_failed = false;
+// 钩子中调用的函数若也被插桩，其钩子直接返回
+static thread_local bool t_is_in_hook = false;
+
+static void init_instrument_lock(void) {
+    if (thrd_success != mtx_init(&g_instrument_lock, mtx_plain)) {
+        fprintf(stderr, "[EZS BENCHMARK][FATAL] "
+                "Failed to initialize the instrumentation lock. Benchmark cannot proceed.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void lock_instrument(void) {
+    call_once(&g_instrument_lock_once, init_instrument_lock);
+    mtx_lock(&g_instrument_lock);
+}
+
+static void unlock_instrument(void) {
+    mtx_unlock(&g_instrument_lock);
+}
+
+// 以dladdr解析function的名称，不在动态符号表中的函数以模块名加偏移表示
+static void resolve_name(void *function, char *name, const size_t size) {
+    Dl_info info;
+    if (0 == dladdr(function, &info)) {
+        snprintf(name, size, "0x%" PRIxPTR, (uintptr_t) function);
+        return;
+    }
+    if (nullptr != info.dli_sname) {
+        snprintf(name, size, "%s", info.dli_sname);
+        return;
+    }
+    const char *module = nullptr != info.dli_fname ? info.dli_fname : "?";
+    const char *slash = strrchr(module, '/');
+    snprintf(name, size, "%s+0x%" PRIxPTR,
+             nullptr != slash ? slash + 1 : module, (uintptr_t) function - (uintptr_t) info.dli_fbase);
+}
+
+static bool matches_any(char *const patterns[], const size_t count, const char *name) {
+    for (size_t i = 0; i < count; i += 1) {
+        if (0 == fnmatch(patterns[i], name, 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 以当前的过滤器判断是否记录function
+static bool evaluate_filter(void *function) {
+    lock_instrument();
+    bool included = true;
+    if (g_include_count > 0 || g_exclude_count > 0) {
+        char name[INSTRUMENT_NAME_SIZE];
+        resolve_name(function, name, sizeof(name));
+        included = (0 == g_include_count || matches_any(g_include_patterns, g_include_count, name)) &&
+                   !matches_any(g_exclude_patterns, g_exclude_count, name);
+    }
+    unlock_instrument();
+    return included;
+}
+
+static bool is_included(FunctionSlot *slot) {
+    const uint_fast32_t generation = atomic_load_explicit(&g_filter_generation, memory_order_acquire);
+    if (slot->filter_generation != generation) {
+        slot->included = evaluate_filter(slot->function);
+        slot->filter_generation = generation;
+    }
+    return slot->included;
+}
+
+// 获取当前线程的记录，首次调用时分配，失败时返回nullptr
+static InstrumentThread *current_thread(void) {
+    if (nullptr != t_instrument_thread || t_is_instrument_failed) {
+        return t_instrument_thread;
+    }
+    InstrumentThread *thread = calloc(1, sizeof(*thread));
+    if (nullptr == thread) {
+        t_is_instrument_failed = true;
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate the instrumentation table. Functions on this thread are not timed.\n");
+        return nullptr;
+    }
+    i_ezs_benchmark_register_atexit();
+    lock_instrument();
+    thread->next = g_instrument_threads;
+    g_instrument_threads = thread;
+    unlock_instrument();
+    t_instrument_thread = thread;
+    return thread;
+}
+
+// 查找function的槽，不存在时插入，函数表已满时返回nullptr
+static FunctionSlot *find_slot(InstrumentThread *thread, void *function) {
+    size_t index = (size_t) (((uintptr_t) function >> 4) * 0x9E3779B97F4A7C15ULL) & (INSTRUMENT_TABLE_CAPACITY - 1);
+    for (;;) {
+        FunctionSlot *slot = &thread->slots[index];
+        if (function == slot->function) {
+            return slot;
+        }
+        if (nullptr == slot->function) {
+            if (thread->slot_count >= INSTRUMENT_TABLE_LIMIT) {
+                return nullptr;
+            }
+            slot->function = function;
+            thread->slot_count += 1;
+            return slot;
+        }
+        index = (index + 1) & (INSTRUMENT_TABLE_CAPACITY - 1);
+    }
+}
+
+static void enter_function(void *function) {
+    InstrumentThread *thread = current_thread();
+    if (nullptr == thread) {
+        return;
+    }
+    if (thread->depth >= INSTRUMENT_MAX_DEPTH) {
+        thread->overflow_depth += 1;
+        thread->untracked_calls += 1;
+        return;
+    }
+    InstrumentFrame *frame = &thread->frames[thread->depth];
+    thread->depth += 1;
+    *frame = (InstrumentFrame){.function = function};
+    if (!atomic_load_explicit(&g_is_instrument_enabled, memory_order_relaxed)) {
+        return;
+    }
+    FunctionSlot *slot = find_slot(thread, function);
+    if (nullptr == slot) {
+        thread->untracked_calls += 1;
+        return;
+    }
+    if (!is_included(slot)) {
+        return;
+    }
+    slot->active += 1;
+    frame->slot = slot;
+    frame->start_ns = i_ezs_benchmark_now_ns();
+}
+
+// 弹出栈顶的帧，now为出口的时刻，仅在栈顶的帧计时时有效
+static void pop_frame(InstrumentThread *thread, const uint64_t now) {
+    thread->depth -= 1;
+    const InstrumentFrame *frame = &thread->frames[thread->depth];
+    InstrumentFrame *parent = thread->depth > 0 ? &thread->frames[thread->depth - 1] : nullptr;
+    if (nullptr == frame->slot) {
+        if (nullptr != parent) {
+            parent->child_ns += frame->child_ns;
+        }
+        return;
+    }
+    FunctionSlot *slot = frame->slot;
+    const uint64_t elapsed = now > frame->start_ns ? now - frame->start_ns : 0;
+    slot->active -= 1;
+    // 执行期间过滤器可能已经改变
+    if (is_included(slot)) {
+        slot->calls += 1;
+        slot->self_ns += elapsed > frame->child_ns ? elapsed - frame->child_ns : 0;
+        if (0 == slot->active) {
+            slot->total_ns += elapsed;
+        }
+    }
+    if (nullptr != parent) {
+        parent->child_ns += elapsed;
+    }
+}
+
+static void exit_function(void *function) {
+    InstrumentThread *thread = t_instrument_thread;
+    if (nullptr == thread) {
+        return;
+    }
+    if (thread->overflow_depth > 0) {
+        thread->overflow_depth -= 1;
+        return;
+    }
+    size_t match = thread->depth;
+    while (match > 0 && function != thread->frames[match - 1].function) {
+        match -= 1;
+    }
+    // 没有对应的入口，例如记录开始前已经在执行的函数
+    if (0 == match) {
+        return;
+    }
+    uint64_t now = 0;
+    while (thread->depth >= match) {
+        if (0 == now && nullptr != thread->frames[thread->depth - 1].slot) {
+            now = i_ezs_benchmark_now_ns();
+        }
+        pop_frame(thread, now);
+    }
+}
+
+__attribute__((no_instrument_function)) void __cyg_profile_func_enter(void *function, void *call_site) {
+    (void) call_site;
+    if (t_is_in_hook) {
+        return;
+    }
+    t_is_in_hook = true;
+    enter_function(function);
+    t_is_in_hook = false;
+}
+
+__attribute__((no_instrument_function)) void __cyg_profile_func_exit(void *function, void *call_site) {
+    (void) call_site;
+    if (t_is_in_hook) {
+        return;
+    }
+    t_is_in_hook = true;
+    exit_function(function);
+    t_is_in_hook = false;
+}
+
+/*---------------------------EZS_BENCHMARK_INSTRUMENT 过滤器---------------------------*/
+
+static void free_patterns(char **patterns, const size_t count) {
+    if (nullptr == patterns) {
+        return;
+    }
+    for (size_t i = 0; i < count; i += 1) {
+        free(patterns[i]);
+    }
+    free(patterns);
+}
+
+// 将以逗号分隔的模式拆分为数组，忽略空的模式
+// list为nullptr时得到空数组，失败时返回false
+static bool parse_patterns(const char *list, char ***patterns, size_t *count) {
+    *patterns = nullptr;
+    *count = 0;
+    if (nullptr == list) {
+        return true;
+    }
+    size_t capacity = 1;
+    for (const char *p = list; '\0' != *p; p += 1) {
+        capacity += ',' == *p ? 1 : 0;
+    }
+    char **result = calloc(capacity, sizeof(*result));
+    if (nullptr == result) {
+        return false;
+    }
+    size_t result_count = 0;
+    for (const char *begin = list;;) {
+        const char *end = strchr(begin, ',');
+        const size_t length = nullptr != end ? (size_t) (end - begin) : strlen(begin);
+        if (length > 0) {
+            result[result_count] = strndup(begin, length);
+            if (nullptr == result[result_count]) {
+                free_patterns(result, result_count);
+                return false;
+            }
+            result_count += 1;
+        }
+        if (nullptr == end) {
+            break;
+        }
+        begin = end + 1;
+    }
+    *patterns = result;
+    *count = result_count;
+    return true;
+}
+
+bool ezs_benchmark_instrument_filter(const char *include, const char *exclude) {
+    char **include_patterns = nullptr, **exclude_patterns = nullptr;
+    size_t include_count = 0, exclude_count = 0;
+    if (!parse_patterns(include, &include_patterns, &include_count) ||
+        !parse_patterns(exclude, &exclude_patterns, &exclude_count)) {
+        free_patterns(include_patterns, include_count);
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate memory for the instrumentation filter. The filter is not changed.\n");
+        return false;
+    }
+    lock_instrument();
+    free_patterns(g_include_patterns, g_include_count);
+    free_patterns(g_exclude_patterns, g_exclude_count);
+    g_include_patterns = include_patterns;
+    g_include_count = include_count;
+    g_exclude_patterns = exclude_patterns;
+    g_exclude_count = exclude_count;
+    atomic_fetch_add_explicit(&g_filter_generation, 1, memory_order_acq_rel);
+    unlock_instrument();
+    return true;
+}
+
+void ezs_benchmark_instrument_enable(const bool enable) {
+    atomic_store_explicit(&g_is_instrument_enabled, enable, memory_order_relaxed);
+}
+
+/*---------------------------EZS_BENCHMARK_INSTRUMENT 报告---------------------------*/
+
+typedef struct {
+    void *function;
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t self_ns;
+} InstrumentRow;
+
+static int compare_row_function(const void *a, const void *b) {
+    const uintptr_t lhs = (uintptr_t) ((const InstrumentRow *) a)->function;
+    const uintptr_t rhs = (uintptr_t) ((const InstrumentRow *) b)->function;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static int compare_row_self(const void *a, const void *b) {
+    const uint64_t lhs = ((const InstrumentRow *) a)->self_ns;
+    const uint64_t rhs = ((const InstrumentRow *) b)->self_ns;
+    return (lhs < rhs) - (lhs > rhs);
+}
+
+static const i_ezs_table_column INSTRUMENT_COLUMNS[] = {
+    {"Function", 32, true},
+    {"Calls", 10, false},
+    {"Total", 10, false},
+    {"Self", 10, false},
+    {"Self %", 8, false},
+    {"Total/Call", 10, false},
+    {"Self/Call", 10, false},
+};
+#define INSTRUMENT_COLUMN_COUNT (sizeof(INSTRUMENT_COLUMNS) / sizeof(INSTRUMENT_COLUMNS[0]))
+
+// 合并所有线程中调用过的函数，按函数地址去重
+// 调用者需持有g_instrument_lock，失败时返回nullptr
+static InstrumentRow *collect_rows(size_t *row_count, uint64_t *untracked_calls) {
+    size_t capacity = 0;
+    *untracked_calls = 0;
+    for (const InstrumentThread *thread = g_instrument_threads; nullptr != thread; thread = thread->next) {
+        capacity += thread->slot_count;
+        *untracked_calls += thread->untracked_calls;
+    }
+    InstrumentRow *rows = malloc((capacity > 0 ? capacity : 1) * sizeof(*rows));
+    if (nullptr == rows) {
+        return nullptr;
+    }
+    size_t count = 0;
+    for (const InstrumentThread *thread = g_instrument_threads; nullptr != thread; thread = thread->next) {
+        for (size_t i = 0; i < INSTRUMENT_TABLE_CAPACITY && count < capacity; i += 1) {
+            const FunctionSlot *slot = &thread->slots[i];
+            if (nullptr != slot->function && slot->calls > 0) {
+                rows[count] = (InstrumentRow){
+                    .function = slot->function, .calls = slot->calls,
+                    .total_ns = slot->total_ns, .self_ns = slot->self_ns
+                };
+                count += 1;
+            }
+        }
+    }
+    if (count > 0) {
+        qsort(rows, count, sizeof(*rows), compare_row_function);
+    }
+    size_t unique_count = 0;
+    for (size_t i = 0; i < count; i += 1) {
+        if (unique_count > 0 && rows[unique_count - 1].function == rows[i].function) {
+            rows[unique_count - 1].calls += rows[i].calls;
+            rows[unique_count - 1].total_ns += rows[i].total_ns;
+            rows[unique_count - 1].self_ns += rows[i].self_ns;
+            continue;
+        }
+        rows[unique_count] = rows[i];
+        unique_count += 1;
+    }
+    *row_count = unique_count;
+    return rows;
+}
+
+// 打印自身耗时最多的函数，only_if_recorded为true时没有记录则不打印
+static void print_instrumented(const bool only_if_recorded) {
+    lock_instrument();
+    size_t row_count = 0;
+    uint64_t untracked_calls = 0;
+    InstrumentRow *rows = collect_rows(&row_count, &untracked_calls);
+    if (nullptr == rows) {
+        unlock_instrument();
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate memory for the instrumentation report.\n");
+        return;
+    }
+    if (0 == row_count && only_if_recorded) {
+        unlock_instrument();
+        free(rows);
+        return;
+    }
+    if (untracked_calls > 0) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "%" PRIu64 " instrumented calls were not timed because a function table is full "
+                "or the call stack is too deep. Exclude more functions from instrumentation.\n", untracked_calls);
+    }
+    if (row_count > 0) {
+        qsort(rows, row_count, sizeof(*rows), compare_row_self);
+    }
+    double self_sum = 0.0;
+    for (size_t i = 0; i < row_count; i += 1) {
+        self_sum += (double) rows[i].self_ns;
+    }
+
+    i_ezs_table_print_header("Instrumented Functions", INSTRUMENT_COLUMNS, INSTRUMENT_COLUMN_COUNT);
+    for (size_t i = 0; i < row_count && i < INSTRUMENT_TOP_FUNCTIONS; i += 1) {
+        const InstrumentRow *row = &rows[i];
+        char name[INSTRUMENT_NAME_SIZE], calls_buf[32], total_buf[32], self_buf[32], share_buf[32];
+        char total_per_call_buf[32], self_per_call_buf[32];
+        resolve_name(row->function, name, sizeof(name));
+        snprintf(calls_buf, sizeof(calls_buf), "%" PRIu64, row->calls);
+        i_ezs_table_format_nanoseconds((double) row->total_ns, total_buf, sizeof(total_buf));
+        i_ezs_table_format_nanoseconds((double) row->self_ns, self_buf, sizeof(self_buf));
+        snprintf(share_buf, sizeof(share_buf), "%.2f%%",
+                 self_sum > 0.0 ? (double) row->self_ns / self_sum * 100.0 : 0.0);
+        i_ezs_table_format_nanoseconds((double) row->total_ns / (double) row->calls,
+                                       total_per_call_buf, sizeof(total_per_call_buf));
+        i_ezs_table_format_nanoseconds((double) row->self_ns / (double) row->calls,
+                                       self_per_call_buf, sizeof(self_per_call_buf));
+        const char *const cells[INSTRUMENT_COLUMN_COUNT] = {
+            name, calls_buf, total_buf, self_buf, share_buf, total_per_call_buf, self_per_call_buf
+        };
+        i_ezs_table_print_row(INSTRUMENT_COLUMNS, INSTRUMENT_COLUMN_COUNT, cells);
+    }
+    i_ezs_table_print_footer(INSTRUMENT_COLUMNS, INSTRUMENT_COLUMN_COUNT);
+    printf("[EZS] %zu instrumented functions, top %zu by self time (including instrumentation overhead)\n\n",
+           row_count, INSTRUMENT_TOP_FUNCTIONS);
+    unlock_instrument();
+    free(rows);
+}
+
+void ezs_benchmark_print_instrumented(void) {
+    print_instrumented(false);
+}
+
+void i_ezs_benchmark_instrument_print_all(void) {
+    print_instrumented(true);
+}
+
+void i_ezs_benchmark_instrument_clear(void) {
+    lock_instrument();
+    // 函数表本身属于各线程，只清除统计数据
+    for (InstrumentThread *thread = g_instrument_threads; nullptr != thread; thread = thread->next) {
+        for (size_t i = 0; i < INSTRUMENT_TABLE_CAPACITY; i += 1) {
+            thread->slots[i].calls = 0;
+            thread->slots[i].total_ns = 0;
+            thread->slots[i].self_ns = 0;
+        }
+        thread->untracked_calls = 0;
+    }
+    unlock_instrument();
+}
+
+#else
+
+bool ezs_benchmark_instrument_filter(const char *include, const char *exclude) {
+    (void) include;
+    (void) exclude;
+    fprintf(stderr, "[EZS BENCHMARK][WARN] "
+            "Function instrumentation is not enabled. "
+            "Configure with EZS_BENCHMARK_INSTRUMENT_FUNCTIONS=ON on Linux with GCC/Clang.\n");
+    return false;
+}
+
+void ezs_benchmark_instrument_enable(const bool enable) {
+    (void) enable;
+}
+
+void ezs_benchmark_print_instrumented(void) {
+}
+
+void i_ezs_benchmark_instrument_print_all(void) {
+}
+
+void i_ezs_benchmark_instrument_clear(void) {
+}
+
+#endif
+
+/*---------------------------清理局部宏---------------------------*/
+
+#undef INSTRUMENT_TABLE_CAPACITY
+#undef INSTRUMENT_MAX_DEPTH
+#undef INSTRUMENT_NAME_SIZE
+#undef INSTRUMENT_COLUMN_COUNT
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "EazyStart/time/benchmark.h"
+#include "histogram.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * benchmark模块内跨文件调用的私有函数
+ *
+ * 本头文件为EZS内部使用，不属于公开接口
+ */
+
+// 注册在程序退出时打印报告的atexit处理程序
+// 定义了EZS_BENCHMARK_NO_AUTO_EXIT时不做任何事
+void i_ezs_benchmark_register_atexit(void);
+
+// 获取当前时间的纳秒数，时钟不可用时终止程序
+uint64_t i_ezs_benchmark_now_ns(void);
+
+// 将timespec转换为纳秒数
+// 参数的合法性由调用者保证 即 ts.tv_sec >= 0
+// 在每次计时结束时调用，因此定义在头文件中以便内联
+static inline uint64_t i_ezs_benchmark_timespec_to_ns(const struct timespec ts) {
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+// 按名称保存结果的表，供run、scaling、load等在报告中单独成表的结果使用
+// 同名的结果会被覆盖，记录按首次保存的顺序排列
+// 所有表共用一把锁，names与values只能在持有锁时访问
+typedef struct {
+    size_t value_size; // 每条记录的值的字节数
+    char **names;
+    unsigned char *values;
+    size_t count;
+    size_t capacity;
+} i_ezs_benchmark_records;
+
+// 静态初始化值类型为type的表
+#define I_EZS_BENCHMARK_RECORDS_INIT(type) {.value_size = sizeof(type)}
+
+// 获取与释放所有结果表共用的锁
+void i_ezs_benchmark_records_lock(void);
+
+void i_ezs_benchmark_records_unlock(void);
+
+// 将value复制到名为name的记录中，同名的记录会被覆盖
+// 内存不足时返回false，表不变
+bool i_ezs_benchmark_records_save(i_ezs_benchmark_records *records, const char *name, const void *value) __attribute__((nonnull(1, 2, 3)));
+
+// 第index条记录的值，调用者需持有锁
+void *i_ezs_benchmark_records_value(const i_ezs_benchmark_records *records, size_t index) __attribute__((nonnull(1)));
+
+// 删除所有记录并释放内存
+void i_ezs_benchmark_records_clear(i_ezs_benchmark_records *records) __attribute__((nonnull(1)));
+
+// 打印ezs_benchmark_run记录的结果，无结果时不打印
+void i_ezs_benchmark_run_print_all(void);
+
+// 清除ezs_benchmark_run记录的结果
+void i_ezs_benchmark_run_clear(void);
+
+// 打印多线程扩展测试的结果，无结果时不打印
+void i_ezs_benchmark_scaling_print_all(void);
+
+// 清除多线程扩展测试的结果
+void i_ezs_benchmark_scaling_clear(void);
+
+// 打印开环负载测试的结果，无结果时不打印
+void i_ezs_benchmark_load_print_all(void);
+
+// 清除开环负载测试的结果
+void i_ezs_benchmark_load_clear(void);
+
+// 打印函数级插桩的结果，无记录时不打印
+void i_ezs_benchmark_instrument_print_all(void);
+
+// 清除函数级插桩记录的统计数据
+void i_ezs_benchmark_instrument_clear(void);
+
+// 打印采样分析的结果，无样本时不打印
+void i_ezs_benchmark_profile_print_all(void);
+
+// 清除采样分析记录的样本
+void i_ezs_benchmark_profile_clear(void);
+
+// 停止采样分析，并释放样本占用的内存
+void i_ezs_benchmark_profile_drop(void);
+
+// 正在采样且当前线程还没有采样定时器时，为当前线程创建
+// 在每次开始计时时调用，已经检查过时只需一次原子读取
+void i_ezs_benchmark_profile_prepare_thread(void);
+
+// 为当前线程创建分片并为句柄为id的条目分配内存，使之后的首次计时不包含这些初始化的开销
+void i_ezs_benchmark_prepare_thread(ezs_benchmark_id id);
+
+// 获取当前线程最内层的正在计时的区域，没有时返回EZS_BENCHMARK_INVALID_ID
+// 该函数是异步信号安全的，供采样分析器的信号处理函数调用
+ezs_benchmark_id i_ezs_benchmark_active_region(void);
+
+// 运行环境信息的项数
+#define I_EZS_BENCHMARK_ENVIRONMENT_FIELDS 12
+
+// 运行环境的一项信息
+typedef struct {
+    const char *key;
+    char value[256];
+} i_ezs_benchmark_environment_field;
+
+// 采集运行环境信息存入fields，无法获取的项为"unknown"
+void i_ezs_benchmark_collect_environment(i_ezs_benchmark_environment_field fields[I_EZS_BENCHMARK_ENVIRONMENT_FIELDS]);
+
+// 打印运行环境表格
+void i_ezs_benchmark_environment_print(void);
+
+// 一个条目合并所有线程后的统计摘要，耗时单位均为纳秒
+typedef struct {
+    char *name;
+    uint64_t count;
+    double mean_ns;
+    double min_ns;
+    double max_ns;
+    double std_dev_ns;
+    double rsd_percent; // 相对标准差，单位为%
+    double p50_ns;
+    double p95_ns;
+    double p99_ns;
+    double p999_ns;
+    double mad_ns; // 中位数绝对偏差
+    double iqr_ns; // 四分位距
+    double outliers; // Tukey栅栏以外的样本数
+    double items_per_second; // 吞吐量，没有记录工作量时为0
+    double bytes_per_second;
+} i_ezs_benchmark_summary;
+
+// 汇总所有已注册且有数据的条目，按名称排序
+// 返回的数组由i_ezs_benchmark_summaries_drop释放，失败时返回nullptr且count为0
+i_ezs_benchmark_summary *i_ezs_benchmark_collect_summaries(size_t *count) __attribute__((nonnull(1)));
+
+// 释放i_ezs_benchmark_collect_summaries返回的数组
+void i_ezs_benchmark_summaries_drop(i_ezs_benchmark_summary *summaries, size_t count);
+
+// 获取名为name的条目合并所有线程后的耗时直方图与平均耗时（纳秒）
+// histogram应为空的直方图，使用完毕后由调用者调用i_ezs_histogram_drop释放
+// 条目不存在或尚无数据时返回false
+bool i_ezs_benchmark_merged_histogram(const char *name, i_ezs_histogram *histogram, double *mean_ns) __attribute__((nonnull(1, 2, 3)));
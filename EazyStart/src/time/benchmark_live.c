@@ -0,0 +1,530 @@
+#if defined(__linux__)
+#define _GNU_SOURCE // NOLINT(*-reserved-identifier)
+#endif
+
+#include "EazyStart/time/benchmark_live.h"
+#include "benchmark_internal.h"
+#include "table.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <threads.h>
+#include <unistd.h>
+
+/*---------------------------EZS_BENCHMARK_LIVE 共享内存布局---------------------------*/
+
+/*
+ * 共享内存由头部与条目数组组成，条目数组的容量在创建时确定
+ * magic在其余字段初始化完毕后最后写入，读者据此判断共享内存是否可用
+ * sequence之后的字段与条目数组由顺序锁保护：sequence为奇数时发布线程正在写入
+ */
+
+// "EZSL"
+static constexpr uint32_t LIVE_MAGIC = 0x4C535A45;
+// 读取一致快照的最大尝试次数，发布者在写入途中退出时序号会停留在奇数
+static constexpr int LIVE_READ_ATTEMPTS = 10000;
+
+typedef struct {
+    _Atomic uint32_t magic;
+    uint32_t version;
+    uint32_t entry_size;
+    uint32_t reserved;
+    uint64_t capacity; // 条目数组的容量
+    int64_t pid;
+    _Atomic uint64_t sequence;
+    // 以下由顺序锁保护
+    uint64_t snapshot;
+    int64_t updated_sec;
+    int64_t updated_nsec;
+    uint64_t entry_count;
+    uint64_t stopped;
+} LiveHeader;
+
+typedef struct {
+    LiveHeader header;
+    ezs_benchmark_live_entry entries[];
+} LiveRegion;
+
+/*---------------------------EZS_BENCHMARK_LIVE 发布---------------------------*/
+
+typedef struct {
+    char *name;
+    LiveRegion *region;
+    size_t size; // 映射的字节数
+    unsigned interval_ms;
+    bool is_truncation_reported;
+    mtx_t lock;
+    cnd_t wake;
+    bool stopping; // 由lock保护
+    thrd_t thread;
+} LivePublisher;
+
+static once_flag g_live_lock_once = ONCE_FLAG_INIT;
+static mtx_t g_live_lock;
+static LivePublisher *g_publisher = nullptr;
+
+static void init_live_lock(void) {
+    if (thrd_success != mtx_init(&g_live_lock, mtx_plain)) {
+        fprintf(stderr, "[EZS BENCHMARK][FATAL] "
+                "Failed to initialize the live statistics lock. Benchmark cannot proceed.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void lock_live(void) {
+    call_once(&g_live_lock_once, init_live_lock);
+    mtx_lock(&g_live_lock);
+}
+
+static void unlock_live(void) {
+    mtx_unlock(&g_live_lock);
+}
+
+// 将一个统计摘要转换为共享内存中的条目
+static ezs_benchmark_live_entry to_live_entry(const i_ezs_benchmark_summary *summary) {
+    ezs_benchmark_live_entry entry = {
+        .count = summary->count,
+        .mean_ns = summary->mean_ns,
+        .min_ns = summary->min_ns,
+        .max_ns = summary->max_ns,
+        .std_dev_ns = summary->std_dev_ns,
+        .p50_ns = summary->p50_ns,
+        .p95_ns = summary->p95_ns,
+        .p99_ns = summary->p99_ns,
+        .p999_ns = summary->p999_ns,
+    };
+    snprintf(entry.name, sizeof(entry.name), "%s", summary->name);
+    return entry;
+}
+
+// 汇总所有条目并写入共享内存，stopped为true时同时标记发布者已停止
+// 只有发布线程（或停止发布时已经结束发布线程的调用者）写入，因此不存在写者之间的竞争
+// 被测线程此时仍在计时，汇总读取的是各分片条目的快照，见benchmark.c中的多线程设计
+static void publish_snapshot(LivePublisher *publisher, const bool stopped) {
+    size_t count = 0;
+    i_ezs_benchmark_summary *summaries = i_ezs_benchmark_collect_summaries(&count);
+    LiveRegion *region = publisher->region;
+    const size_t capacity = (size_t) region->header.capacity;
+    if (count > capacity && !publisher->is_truncation_reported) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "%zu benchmark items exceed the live statistics capacity of %zu. "
+                "Only the first %zu items are published.\n", count, capacity, capacity);
+        publisher->is_truncation_reported = true;
+    }
+    const size_t published = count < capacity ? count : capacity;
+    struct timespec now = {};
+    timespec_get(&now, TIME_UTC);
+
+    const uint64_t sequence = atomic_load_explicit(&region->header.sequence, memory_order_relaxed);
+    atomic_store_explicit(&region->header.sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for (size_t i = 0; i < published; i += 1) {
+        region->entries[i] = to_live_entry(&summaries[i]);
+    }
+    region->header.snapshot += 1;
+    region->header.updated_sec = (int64_t) now.tv_sec;
+    region->header.updated_nsec = (int64_t) now.tv_nsec;
+    region->header.entry_count = published;
+    region->header.stopped = stopped ? 1 : 0;
+    atomic_store_explicit(&region->header.sequence, sequence + 2, memory_order_release);
+
+    i_ezs_benchmark_summaries_drop(summaries, count);
+}
+
+static int run_publisher(void *argument) {
+    LivePublisher *publisher = argument;
+    mtx_lock(&publisher->lock);
+    while (!publisher->stopping) {
+        mtx_unlock(&publisher->lock);
+        publish_snapshot(publisher, false);
+        mtx_lock(&publisher->lock);
+        struct timespec deadline = {};
+        timespec_get(&deadline, TIME_UTC);
+        const long long nanoseconds = (long long) deadline.tv_nsec + (long long) publisher->interval_ms * 1000000LL;
+        deadline.tv_sec += (time_t) (nanoseconds / 1000000000LL);
+        deadline.tv_nsec = (long) (nanoseconds % 1000000000LL);
+        // 被唤醒（包括虚假唤醒）时重新检查是否需要停止，超时后发布下一次快照
+        while (!publisher->stopping) {
+            if (thrd_success != cnd_timedwait(&publisher->wake, &publisher->lock, &deadline)) {
+                break;
+            }
+        }
+    }
+    mtx_unlock(&publisher->lock);
+    return 0;
+}
+
+// 释放发布者的资源，shm_unlink使名称不再可见，但已附加的读者仍可读取
+static void drop_publisher(LivePublisher *publisher) {
+    if (nullptr != publisher->region) {
+        munmap(publisher->region, publisher->size);
+    }
+    if (nullptr != publisher->name) {
+        shm_unlink(publisher->name);
+        free(publisher->name);
+    }
+    free(publisher);
+}
+
+// 创建并初始化名为name的共享内存，失败时返回false
+// 名为name的共享内存已存在时，仅在记录的发布者进程已经退出时删除它
+// 仍在初始化、版本不一致或无法确认发布者已退出时保守地认为仍在使用，返回false
+static bool reclaim_stale_region(const char *name) {
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return ENOENT == errno; // 已被删除，可以重试
+    }
+    struct stat status = {};
+    void *address = MAP_FAILED;
+    if (0 == fstat(fd, &status) && (uintmax_t) status.st_size >= sizeof(LiveHeader)) {
+        address = mmap(nullptr, sizeof(LiveHeader), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    int64_t pid = 0;
+    if (MAP_FAILED != address) {
+        const LiveHeader *header = address;
+        if (LIVE_MAGIC == atomic_load_explicit(&header->magic, memory_order_acquire) &&
+            EZS_BENCHMARK_LIVE_VERSION == header->version) {
+            pid = header->pid;
+        }
+        munmap(address, sizeof(LiveHeader));
+    }
+    if (pid <= 0 || (pid_t) pid != pid) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "The shared memory '%s' already exists and is being initialized, "
+                "has another version or is not a live statistics segment.\n", name);
+        return false;
+    }
+    if (0 == kill((pid_t) pid, 0) || ESRCH != errno) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "The live statistics '%s' are already published by the running process %" PRId64 ".\n",
+                name, pid);
+        return false;
+    }
+    // 删除前确认名称仍指向刚才检查的共享内存，避免删除其他进程刚回收并重新创建的共享内存
+    struct stat current = {};
+    const int check = shm_open(name, O_RDONLY, 0);
+    if (check < 0) {
+        return ENOENT == errno;
+    }
+    const bool same = 0 == fstat(check, &current) && current.st_dev == status.st_dev && current.st_ino == status.st_ino;
+    close(check);
+    if (!same) {
+        return false;
+    }
+    fprintf(stderr, "[EZS BENCHMARK][WARN] "
+            "Reclaiming the live statistics '%s' left behind by the exited process %" PRId64 ".\n", name, pid);
+    return 0 == shm_unlink(name) || ENOENT == errno;
+}
+
+static bool create_region(LivePublisher *publisher, const char *name, const size_t max_entries) {
+    publisher->size = sizeof(LiveRegion) + max_entries * sizeof(ezs_benchmark_live_entry);
+    // 独占创建，不能截断其他进程仍在写入的共享内存
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && EEXIST == errno && reclaim_stale_region(name)) {
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0) {
+        return false;
+    }
+    publisher->name = strdup(name);
+    void *address = MAP_FAILED;
+    if (nullptr != publisher->name && 0 == ftruncate(fd, (off_t) publisher->size)) {
+        address = mmap(nullptr, publisher->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (MAP_FAILED == address) {
+        if (nullptr == publisher->name) {
+            shm_unlink(name);
+        }
+        return false;
+    }
+    publisher->region = address;
+    LiveHeader *header = &publisher->region->header;
+    header->version = EZS_BENCHMARK_LIVE_VERSION;
+    header->entry_size = sizeof(ezs_benchmark_live_entry);
+    header->capacity = max_entries;
+    header->pid = (int64_t) getpid();
+    atomic_store_explicit(&header->sequence, 0, memory_order_relaxed);
+    atomic_store_explicit(&header->magic, LIVE_MAGIC, memory_order_release);
+    return true;
+}
+
+bool ezs_benchmark_live_publish(const char *name, const unsigned interval_ms, const size_t max_entries) {
+    if ('/' != name[0] || '\0' == name[1] || nullptr != strchr(name + 1, '/') || 0 == interval_ms ||
+        0 == max_entries) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Invalid live statistics options. The name must look like '/name', "
+                "and the interval and the capacity must be positive.\n");
+        return false;
+    }
+    ezs_benchmark_live_stop();
+    i_ezs_benchmark_register_atexit();
+
+    LivePublisher *publisher = calloc(1, sizeof(*publisher));
+    if (nullptr == publisher) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate memory for the live statistics.\n");
+        return false;
+    }
+    publisher->interval_ms = interval_ms;
+    if (!create_region(publisher, name, max_entries)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to create the shared memory '%s' for the live statistics.\n", name);
+        drop_publisher(publisher);
+        return false;
+    }
+    if (thrd_success != mtx_init(&publisher->lock, mtx_plain)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to initialize the live statistics lock.\n");
+        drop_publisher(publisher);
+        return false;
+    }
+    if (thrd_success != cnd_init(&publisher->wake)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to initialize the live statistics condition variable.\n");
+        mtx_destroy(&publisher->lock);
+        drop_publisher(publisher);
+        return false;
+    }
+    if (thrd_success != thrd_create(&publisher->thread, run_publisher, publisher)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to create the live statistics thread.\n");
+        cnd_destroy(&publisher->wake);
+        mtx_destroy(&publisher->lock);
+        drop_publisher(publisher);
+        return false;
+    }
+    lock_live();
+    g_publisher = publisher;
+    unlock_live();
+    return true;
+}
+
+void ezs_benchmark_live_stop(void) {
+    lock_live();
+    LivePublisher *publisher = g_publisher;
+    g_publisher = nullptr;
+    unlock_live();
+    if (nullptr == publisher) {
+        return;
+    }
+    mtx_lock(&publisher->lock);
+    publisher->stopping = true;
+    cnd_signal(&publisher->wake);
+    mtx_unlock(&publisher->lock);
+    thrd_join(publisher->thread, nullptr);
+
+    publish_snapshot(publisher, true);
+    cnd_destroy(&publisher->wake);
+    mtx_destroy(&publisher->lock);
+    drop_publisher(publisher);
+}
+
+/*---------------------------EZS_BENCHMARK_LIVE 读取---------------------------*/
+
+struct ezs_benchmark_live_reader {
+    const LiveRegion *region;
+    size_t size; // 映射的字节数
+    size_t capacity; // 共享内存中条目数组的容量
+    ezs_benchmark_live_entry *buffer; // 供ezs_benchmark_live_print使用
+};
+
+ezs_benchmark_live_reader *ezs_benchmark_live_attach(const char *name) {
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "No live statistics named '%s' were found.\n", name);
+        return nullptr;
+    }
+    struct stat status = {};
+    void *address = MAP_FAILED;
+    if (0 == fstat(fd, &status) && (size_t) status.st_size >= sizeof(LiveRegion)) {
+        address = mmap(nullptr, (size_t) status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (MAP_FAILED == address) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to map the live statistics '%s'. The publisher may still be initializing it.\n", name);
+        return nullptr;
+    }
+    const size_t size = (size_t) status.st_size;
+    const LiveRegion *region = address;
+    const LiveHeader *header = &region->header;
+    if (LIVE_MAGIC != atomic_load_explicit(&header->magic, memory_order_acquire) ||
+        EZS_BENCHMARK_LIVE_VERSION != header->version ||
+        sizeof(ezs_benchmark_live_entry) != header->entry_size ||
+        header->capacity > (size - sizeof(LiveRegion)) / sizeof(ezs_benchmark_live_entry)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "The live statistics '%s' are not initialized or have an incompatible version "
+                "(expected version %d).\n", name, EZS_BENCHMARK_LIVE_VERSION);
+        munmap(address, size);
+        return nullptr;
+    }
+
+    ezs_benchmark_live_reader *reader = calloc(1, sizeof(*reader));
+    const size_t capacity = (size_t) header->capacity;
+    ezs_benchmark_live_entry *buffer = calloc(capacity > 0 ? capacity : 1, sizeof(*buffer));
+    if (nullptr == reader || nullptr == buffer) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate memory for the live statistics reader.\n");
+        free(reader);
+        free(buffer);
+        munmap(address, size);
+        return nullptr;
+    }
+    *reader = (ezs_benchmark_live_reader){
+        .region = region,
+        .size = size,
+        .capacity = capacity,
+        .buffer = buffer,
+    };
+    return reader;
+}
+
+size_t ezs_benchmark_live_read(ezs_benchmark_live_reader *reader, ezs_benchmark_live_info *info,
+                               ezs_benchmark_live_entry entries[], const size_t capacity) {
+    const LiveRegion *region = reader->region;
+    for (int attempt = 0; attempt < LIVE_READ_ATTEMPTS; attempt += 1) {
+        const uint64_t begin = atomic_load_explicit(&region->header.sequence, memory_order_acquire);
+        if (0 != (begin & 1)) {
+            thrd_yield();
+            continue;
+        }
+        const uint64_t entry_count = region->header.entry_count;
+        const size_t available = entry_count < reader->capacity ? (size_t) entry_count : reader->capacity;
+        const size_t copied = nullptr != entries ? (available < capacity ? available : capacity) : 0;
+        ezs_benchmark_live_info snapshot = {
+            .pid = region->header.pid,
+            .snapshot = region->header.snapshot,
+            .updated = {
+                .tv_sec = (time_t) region->header.updated_sec,
+                .tv_nsec = (long) region->header.updated_nsec
+            },
+            .entry_count = available,
+            .stopped = 0 != region->header.stopped,
+        };
+        for (size_t i = 0; i < copied; i += 1) {
+            entries[i] = region->entries[i];
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (begin == atomic_load_explicit(&region->header.sequence, memory_order_relaxed)) {
+            *info = snapshot;
+            return copied;
+        }
+    }
+    fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+            "Failed to read a consistent snapshot of the live statistics. "
+            "The publisher may have exited while writing.\n");
+    *info = (ezs_benchmark_live_info){};
+    return 0;
+}
+
+static const i_ezs_table_column LIVE_COLUMNS[] = {
+    {"Benchmark Name", 20, true},
+    {"Count", 10, false},
+    {"Mean", 9, false},
+    {"Min", 9, false},
+    {"Max", 9, false},
+    {"P50", 9, false},
+    {"P95", 9, false},
+    {"P99", 9, false},
+    {"P99.9", 9, false},
+    {"Std Dev", 9, false},
+};
+#define LIVE_COLUMN_COUNT (sizeof(LIVE_COLUMNS) / sizeof(LIVE_COLUMNS[0]))
+
+void ezs_benchmark_live_print(ezs_benchmark_live_reader *reader) {
+    ezs_benchmark_live_info info = {};
+    const size_t count = ezs_benchmark_live_read(reader, &info, reader->buffer, reader->capacity);
+    i_ezs_table_print_header("Live Benchmark Table", LIVE_COLUMNS, LIVE_COLUMN_COUNT);
+    for (size_t i = 0; i < count; i += 1) {
+        const ezs_benchmark_live_entry *entry = &reader->buffer[i];
+        char count_buf[32], mean_buf[32], min_buf[32], max_buf[32];
+        char p50_buf[32], p95_buf[32], p99_buf[32], p999_buf[32], std_dev_buf[32];
+        snprintf(count_buf, sizeof(count_buf), "%" PRIu64, entry->count);
+        i_ezs_table_format_nanoseconds(entry->mean_ns, mean_buf, sizeof(mean_buf));
+        i_ezs_table_format_nanoseconds(entry->min_ns, min_buf, sizeof(min_buf));
+        i_ezs_table_format_nanoseconds(entry->max_ns, max_buf, sizeof(max_buf));
+        i_ezs_table_format_nanoseconds(entry->p50_ns, p50_buf, sizeof(p50_buf));
+        i_ezs_table_format_nanoseconds(entry->p95_ns, p95_buf, sizeof(p95_buf));
+        i_ezs_table_format_nanoseconds(entry->p99_ns, p99_buf, sizeof(p99_buf));
+        i_ezs_table_format_nanoseconds(entry->p999_ns, p999_buf, sizeof(p999_buf));
+        i_ezs_table_format_nanoseconds(entry->std_dev_ns, std_dev_buf, sizeof(std_dev_buf));
+        const char *const cells[LIVE_COLUMN_COUNT] = {
+            entry->name, count_buf, mean_buf, min_buf, max_buf, p50_buf, p95_buf, p99_buf, p999_buf, std_dev_buf
+        };
+        i_ezs_table_print_row(LIVE_COLUMNS, LIVE_COLUMN_COUNT, cells);
+    }
+    i_ezs_table_print_footer(LIVE_COLUMNS, LIVE_COLUMN_COUNT);
+
+    struct timespec now = {};
+    timespec_get(&now, TIME_UTC);
+    const double age = (double) (now.tv_sec - info.updated.tv_sec) +
+                       (double) (now.tv_nsec - info.updated.tv_nsec) / 1e9;
+    printf("[EZS] Process %" PRId64 ", snapshot %" PRIu64 ", updated %.1fs ago%s\n\n",
+           info.pid, info.snapshot, 0 != info.snapshot ? age : 0.0,
+           info.stopped ? ", the publisher has stopped" : "");
+}
+
+void ezs_benchmark_live_detach(ezs_benchmark_live_reader *reader) {
+    if (nullptr == reader) {
+        return;
+    }
+    munmap((void *) reader->region, reader->size);
+    free(reader->buffer);
+    free(reader);
+}
+
+/*---------------------------清理局部宏---------------------------*/
+
+#undef LIVE_COLUMN_COUNT
+
+#else
+
+bool ezs_benchmark_live_publish(const char *name, const unsigned interval_ms, const size_t max_entries) {
+    (void) name;
+    (void) interval_ms;
+    (void) max_entries;
+    fprintf(stderr, "[EZS BENCHMARK][WARN] "
+            "Live statistics are only supported on POSIX systems.\n");
+    return false;
+}
+
+void ezs_benchmark_live_stop(void) {
+}
+
+ezs_benchmark_live_reader *ezs_benchmark_live_attach(const char *name) {
+    (void) name;
+    fprintf(stderr, "[EZS BENCHMARK][WARN] "
+            "Live statistics are only supported on POSIX systems.\n");
+    return nullptr;
+}
+
+size_t ezs_benchmark_live_read(ezs_benchmark_live_reader *reader, ezs_benchmark_live_info *info,
+                               ezs_benchmark_live_entry entries[], const size_t capacity) {
+    (void) reader;
+    (void) entries;
+    (void) capacity;
+    *info = (ezs_benchmark_live_info){};
+    return 0;
+}
+
+void ezs_benchmark_live_print(ezs_benchmark_live_reader *reader) {
+    (void) reader;
+}
+
+void ezs_benchmark_live_detach(ezs_benchmark_live_reader *reader) {
+    (void) reader;
+}
+
+#endif
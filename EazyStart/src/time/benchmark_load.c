@@ -0,0 +1,203 @@
+#include "EazyStart/time/benchmark_load.h"
+#include "benchmark_internal.h"
+#include "histogram.h"
+#include "table.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+// 距离计划时间超过该值时先睡眠，其余时间自旋等待，以兼顾CPU占用与发起时间的精度
+static constexpr uint64_t LOAD_SPIN_THRESHOLD_NS = 200 * 1000;
+// 实际速率低于目标速率的该比例时打印警告
+static constexpr double LOAD_RATE_TOLERANCE = 0.95;
+// 测试最多持续计划时长的该倍数，被测函数跟不上目标速率时剩余的调用不再发起
+static constexpr uint64_t LOAD_DEADLINE_FACTOR = 2;
+
+/*---------------------------EZS_BENCHMARK_LOAD 计时工具---------------------------*/
+
+// 等待到target（纳秒），返回等待结束时的时间
+static uint64_t wait_until(const uint64_t target) {
+    uint64_t now = i_ezs_benchmark_now_ns();
+    if (now + LOAD_SPIN_THRESHOLD_NS < target) {
+        const uint64_t sleep_ns = target - now - LOAD_SPIN_THRESHOLD_NS;
+        const struct timespec duration = {
+            .tv_sec = (time_t) (sleep_ns / 1000000000ULL),
+            .tv_nsec = (long) (sleep_ns % 1000000000ULL)
+        };
+        thrd_sleep(&duration, nullptr);
+        now = i_ezs_benchmark_now_ns();
+    }
+    while (now < target) {
+        now = i_ezs_benchmark_now_ns();
+    }
+    return now;
+}
+
+/*---------------------------EZS_BENCHMARK_LOAD 结果记录---------------------------*/
+
+static i_ezs_benchmark_records g_records = I_EZS_BENCHMARK_RECORDS_INIT(ezs_benchmark_load_result);
+
+static const i_ezs_table_column LOAD_COLUMNS[] = {
+    {"Benchmark Name", 20, true},
+    {"Target/s", 9, false},
+    {"Achieved/s", 10, false},
+    {"Calls", 10, false},
+    {"Unissued", 10, false},
+    {"Latency", 11, false},
+    {"P50", 9, false},
+    {"P90", 9, false},
+    {"P99", 9, false},
+    {"P99.9", 9, false},
+    {"Max", 9, false},
+};
+#define LOAD_COLUMN_COUNT (sizeof(LOAD_COLUMNS) / sizeof(LOAD_COLUMNS[0]))
+
+// 打印一组分位数，首行带有名称与速率
+static void print_load_row(const char *name, const ezs_benchmark_load_result *result, const bool corrected) {
+    char target_buf[32] = "", achieved_buf[32] = "", calls_buf[32] = "", unissued_buf[32] = "";
+    char p50_buf[32], p90_buf[32], p99_buf[32], p999_buf[32], max_buf[32];
+    if (corrected) {
+        i_ezs_table_format_count(result->target_rate, target_buf, sizeof(target_buf));
+        i_ezs_table_format_count(result->achieved_rate, achieved_buf, sizeof(achieved_buf));
+        snprintf(calls_buf, sizeof(calls_buf), "%" PRIu64, result->calls);
+        snprintf(unissued_buf, sizeof(unissued_buf), "%" PRIu64, result->unissued_calls);
+    }
+    i_ezs_table_format_nanoseconds(corrected ? result->p50_ns : result->uncorrected_p50_ns, p50_buf, sizeof(p50_buf));
+    i_ezs_table_format_nanoseconds(corrected ? result->p90_ns : result->uncorrected_p90_ns, p90_buf, sizeof(p90_buf));
+    i_ezs_table_format_nanoseconds(corrected ? result->p99_ns : result->uncorrected_p99_ns, p99_buf, sizeof(p99_buf));
+    i_ezs_table_format_nanoseconds(corrected ? result->p999_ns : result->uncorrected_p999_ns,
+                                   p999_buf, sizeof(p999_buf));
+    i_ezs_table_format_nanoseconds(corrected ? result->max_ns : result->uncorrected_max_ns, max_buf, sizeof(max_buf));
+    const char *const cells[LOAD_COLUMN_COUNT] = {
+        corrected ? name : "", target_buf, achieved_buf, calls_buf, unissued_buf,
+        corrected ? "corrected" : "uncorrected",
+        p50_buf, p90_buf, p99_buf, p999_buf, max_buf
+    };
+    i_ezs_table_print_row(LOAD_COLUMNS, LOAD_COLUMN_COUNT, cells);
+}
+
+void i_ezs_benchmark_load_print_all(void) {
+    i_ezs_benchmark_records_lock();
+    if (0 == g_records.count) {
+        i_ezs_benchmark_records_unlock();
+        return;
+    }
+    i_ezs_table_print_header("Load Test Table", LOAD_COLUMNS, LOAD_COLUMN_COUNT);
+    for (size_t i = 0; i < g_records.count; i += 1) {
+        const ezs_benchmark_load_result *result = i_ezs_benchmark_records_value(&g_records, i);
+        print_load_row(g_records.names[i], result, true);
+        print_load_row(g_records.names[i], result, false);
+    }
+    i_ezs_table_print_footer(LOAD_COLUMNS, LOAD_COLUMN_COUNT);
+    printf("[EZS] Corrected latency is measured from the scheduled start, uncorrected from the actual start\n\n");
+    i_ezs_benchmark_records_unlock();
+}
+
+void i_ezs_benchmark_load_clear(void) {
+    i_ezs_benchmark_records_clear(&g_records);
+}
+
+/*---------------------------EZS_BENCHMARK_LOAD 运行器---------------------------*/
+
+// 查询直方图的分位数，直方图给出的是桶内的最大等价值，这里将其限制在实际的最大值之内
+static double load_percentile(const i_ezs_histogram *histogram, const double quantile, const uint64_t max) {
+    const uint64_t value = i_ezs_histogram_value_at_quantile(histogram, quantile);
+    return (double) (value < max ? value : max);
+}
+
+ezs_benchmark_load_result ezs_benchmark_load(const char *name, const ezs_benchmark_function function, void *context,
+                                             const ezs_benchmark_load_options *options) {
+    ezs_benchmark_load_result result = {.target_rate = options->target_rate};
+    if (!(options->target_rate > 0.0) || options->duration.tv_sec < 0 ||
+        options->duration.tv_nsec < 0 || options->duration.tv_nsec >= 1000000000L ||
+        (0 == options->duration.tv_sec && 0 == options->duration.tv_nsec)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Invalid options of the load test '%s'. Ignoring this call.\n", name);
+        return (ezs_benchmark_load_result){};
+    }
+    const uint64_t duration_ns = (uint64_t) options->duration.tv_sec * 1000000000ULL +
+                                 (uint64_t) options->duration.tv_nsec;
+    const double interval_ns = 1e9 / options->target_rate;
+    // 计划发起的调用次数，即计划时间落在[0, duration)内的序号个数
+    const double planned_calls = ceil((double) duration_ns / interval_ns);
+    if (!(planned_calls < (double) UINT64_MAX)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Invalid options of the load test '%s'. Ignoring this call.\n", name);
+        return (ezs_benchmark_load_result){};
+    }
+    const uint64_t planned = (uint64_t) planned_calls;
+    i_ezs_benchmark_register_atexit();
+    i_ezs_histogram corrected = {};
+    i_ezs_histogram uncorrected = {};
+    uint64_t corrected_max = 0, uncorrected_max = 0;
+
+    // 计划时间由序号直接算出，不随实际发起时间累积误差
+    const uint64_t origin = i_ezs_benchmark_now_ns();
+    const uint64_t deadline = origin + duration_ns * LOAD_DEADLINE_FACTOR;
+    uint64_t end = origin;
+    for (uint64_t i = 0; i < planned; i += 1) {
+        const uint64_t scheduled = origin + (uint64_t) ((double) i * interval_ns);
+        const uint64_t start = wait_until(scheduled);
+        // 计划时间都在截止时间之前，只有落后于计划时才会在这里停止
+        if (start >= deadline) {
+            result.unissued_calls = planned - i;
+            break;
+        }
+        function(context);
+        end = i_ezs_benchmark_now_ns();
+        const uint64_t corrected_ns = end - scheduled;
+        const uint64_t uncorrected_ns = end - start;
+        if (!i_ezs_histogram_record(&corrected, corrected_ns) ||
+            !i_ezs_histogram_record(&uncorrected, uncorrected_ns)) {
+            fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                    "Failed to allocate the histograms of the load test '%s'. Stopping here.\n", name);
+            break;
+        }
+        corrected_max = corrected_ns > corrected_max ? corrected_ns : corrected_max;
+        uncorrected_max = uncorrected_ns > uncorrected_max ? uncorrected_ns : uncorrected_max;
+        result.calls += 1;
+    }
+
+    if (result.calls > 0) {
+        // 最后一次调用之后到计划结束之间没有调用，这段时间同样计入，否则速率会被高估
+        const uint64_t elapsed = end > origin + duration_ns ? end - origin : duration_ns;
+        result.achieved_rate = (double) result.calls * 1e9 / (double) elapsed;
+        result.p50_ns = load_percentile(&corrected, 0.5, corrected_max);
+        result.p90_ns = load_percentile(&corrected, 0.9, corrected_max);
+        result.p99_ns = load_percentile(&corrected, 0.99, corrected_max);
+        result.p999_ns = load_percentile(&corrected, 0.999, corrected_max);
+        result.max_ns = (double) corrected_max;
+        result.uncorrected_p50_ns = load_percentile(&uncorrected, 0.5, uncorrected_max);
+        result.uncorrected_p90_ns = load_percentile(&uncorrected, 0.9, uncorrected_max);
+        result.uncorrected_p99_ns = load_percentile(&uncorrected, 0.99, uncorrected_max);
+        result.uncorrected_p999_ns = load_percentile(&uncorrected, 0.999, uncorrected_max);
+        result.uncorrected_max_ns = (double) uncorrected_max;
+    }
+    i_ezs_histogram_drop(&corrected);
+    i_ezs_histogram_drop(&uncorrected);
+
+    if (result.achieved_rate < result.target_rate * LOAD_RATE_TOLERANCE) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Load test '%s' achieved %.0f calls/s, below the target of %.0f calls/s. "
+                "The function cannot keep up and the corrected latency keeps growing.\n",
+                name, result.achieved_rate, result.target_rate);
+    }
+    if (result.unissued_calls > 0) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Load test '%s' reached its deadline of %" PRIu64 " times the planned duration "
+                "with %" PRIu64 " scheduled calls not issued.\n",
+                name, LOAD_DEADLINE_FACTOR, result.unissued_calls);
+    }
+    if (!i_ezs_benchmark_records_save(&g_records, name, &result)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to record the load test result of '%s'.\n", name);
+    }
+    return result;
+}
+
+/*---------------------------清理局部宏---------------------------*/
+
+#undef LOAD_COLUMN_COUNT
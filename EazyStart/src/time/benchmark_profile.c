@@ -0,0 +1,774 @@
+#if defined(__linux__)
+#define _GNU_SOURCE // NOLINT(*-reserved-identifier)
+#endif
+
+#include "EazyStart/time/benchmark_profile.h"
+#include "EazyStart/time/benchmark.h"
+#include "benchmark_internal.h"
+#include "table.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <threads.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#ifndef sigev_notify_thread_id
+// glibc 2.35之前没有为SIGEV_THREAD_ID的目标线程定义字段名
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+/*---------------------------EZS_BENCHMARK_PROFILE 采样---------------------------*/
+
+/*
+ * 信号处理函数只做三件事：从预先分配的缓冲区中原子地取得一个位置、调用backtrace、读取本线程的区域
+ * backtrace的开头是信号处理函数自身与内核返回的跳板（Sanitizer等拦截层还可能插入更多的帧），
+ * 因此以信号上下文中的指令地址定位被中断的帧，无法定位时跳过固定的帧数
+ * backtrace在首次调用时会加载libgcc_s并分配内存，因此在启用时先调用一次，之后的调用是异步信号安全的
+ * 样本的帧数最后写入，读取时帧数为0的样本视为尚未写完
+ *
+ * timer_delete不会等待正在执行的信号处理函数，已经产生的信号也可能在之后才送达
+ * 因此处理函数在进入与退出时增减g_profile_running_handlers，释放或清空缓冲区前先将容量置0，
+ * 再等待该计数归零：此后进入的处理函数读到的容量为0，不会再访问缓冲区
+ * 两处都使用顺序一致的原子操作，保证二者至少有一方看到对方的写入
+ *
+ * 每个线程使用自己的定时器（CLOCK_THREAD_CPUTIME_ID + SIGEV_THREAD_ID），信号总是发给消耗了CPU时间的线程
+ * 进程级的定时器在Linux 6.3之前总是把信号发给主线程，其他线程的热点会被记到主线程上
+ * 定时器在线程开始计时时按需创建，与硬件计数器相同；停止采样时统一删除，并递增g_profile_generation，
+ * 各线程在下一次开始计时时发现代数变化，按当时的状态重新创建
+ */
+
+// 每个样本保留的最大帧数
+#define PROFILE_MAX_DEPTH 64
+// backtrace中位于被中断位置之前的帧：信号处理函数本身与内核返回的跳板
+#define PROFILE_SKIPPED_FRAMES 2
+// 在backtrace的前若干帧中查找被中断的位置
+#define PROFILE_SEARCHED_FRAMES 8
+// 每个区域打印的函数数量
+static constexpr int PROFILE_TOP_FUNCTIONS = 10;
+// 解析后的函数名的最大长度
+#define PROFILE_NAME_SIZE 128
+// 允许的最高采样频率
+static constexpr unsigned PROFILE_MAX_FREQUENCY = 100000;
+
+typedef struct {
+    _Atomic uint32_t depth; // 帧数，0表示尚未写完
+    ezs_benchmark_id region; // 采样时最内层的正在计时的区域
+    void *frames[PROFILE_MAX_DEPTH]; // 由内向外，frames[0]为被中断的位置
+} ProfileSample;
+
+static once_flag g_profile_lock_once = ONCE_FLAG_INIT;
+static mtx_t g_profile_lock;
+// 以下由g_profile_lock保护，信号处理函数只读取g_profile_samples与g_profile_capacity
+static ProfileSample *g_profile_samples = nullptr;
+static _Atomic size_t g_profile_capacity = 0;
+static _Atomic size_t g_profile_next = 0;
+// 正在执行的信号处理函数的数量
+static _Atomic unsigned g_profile_running_handlers = 0;
+static unsigned g_profile_frequency = 0;
+// 是否正在采样，为true时各线程在开始计时时创建自己的定时器
+static bool g_is_profiling = false;
+// 所有线程的采样定时器
+static timer_t *g_profile_timers = nullptr;
+static size_t g_profile_timer_count = 0;
+static size_t g_profile_timer_capacity = 0;
+// 每次启用或停止采样时递增
+static _Atomic uint64_t g_profile_generation = 1;
+// 本线程最近一次检查定时器时的代数
+static thread_local uint64_t t_profile_generation = 0;
+static bool g_is_handler_installed = false;
+static struct sigaction g_previous_action;
+
+static void init_profile_lock(void) {
+    if (thrd_success != mtx_init(&g_profile_lock, mtx_plain)) {
+        fprintf(stderr, "[EZS BENCHMARK][FATAL] "
+                "Failed to initialize the profiler lock. Benchmark cannot proceed.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void lock_profile(void) {
+    call_once(&g_profile_lock_once, init_profile_lock);
+    mtx_lock(&g_profile_lock);
+}
+
+static void unlock_profile(void) {
+    mtx_unlock(&g_profile_lock);
+}
+
+// 信号上下文中被中断位置的指令地址，不支持的架构返回nullptr
+static void *interrupted_address(const void *context) {
+    const ucontext_t *ucontext = context;
+#if defined(__x86_64__)
+    return (void *) ucontext->uc_mcontext.gregs[REG_RIP];
+#elif defined(__i386__)
+    return (void *) ucontext->uc_mcontext.gregs[REG_EIP];
+#elif defined(__aarch64__)
+    return (void *) ucontext->uc_mcontext.pc;
+#else
+    (void) ucontext;
+    return nullptr;
+#endif
+}
+
+// SIGPROF的处理函数，必须是异步信号安全的
+__attribute__((noinline)) static void profile_signal_handler(const int signal, siginfo_t *info, void *context) {
+    (void) signal;
+    (void) info;
+    const int saved_errno = errno;
+    atomic_fetch_add_explicit(&g_profile_running_handlers, 1, memory_order_seq_cst);
+    const size_t index = atomic_fetch_add_explicit(&g_profile_next, 1, memory_order_relaxed);
+    if (index < atomic_load_explicit(&g_profile_capacity, memory_order_seq_cst)) {
+        ProfileSample *sample = &g_profile_samples[index];
+        void *frames[PROFILE_SEARCHED_FRAMES + PROFILE_MAX_DEPTH];
+        const int count = backtrace(frames, PROFILE_SEARCHED_FRAMES + PROFILE_MAX_DEPTH);
+        void *address = interrupted_address(context);
+        int skipped = PROFILE_SKIPPED_FRAMES;
+        for (int i = 0; i < count && i < PROFILE_SEARCHED_FRAMES; i += 1) {
+            if (frames[i] == address) {
+                skipped = i;
+                break;
+            }
+        }
+        int depth = count > skipped ? count - skipped : 0;
+        depth = depth < PROFILE_MAX_DEPTH ? depth : PROFILE_MAX_DEPTH;
+        for (int i = 0; i < depth; i += 1) {
+            sample->frames[i] = frames[skipped + i];
+        }
+        sample->region = i_ezs_benchmark_active_region();
+        atomic_store_explicit(&sample->depth, (uint32_t) depth, memory_order_release);
+    }
+    atomic_fetch_sub_explicit(&g_profile_running_handlers, 1, memory_order_release);
+    errno = saved_errno;
+}
+
+// 阻止信号处理函数访问样本缓冲区，并等待已经在访问的处理函数结束，返回原来的容量
+// 调用者需持有g_profile_lock
+static size_t block_samples(void) {
+    const size_t capacity = atomic_exchange_explicit(&g_profile_capacity, 0, memory_order_seq_cst);
+    while (0 != atomic_load_explicit(&g_profile_running_handlers, memory_order_seq_cst)) {
+        thrd_yield();
+    }
+    return capacity;
+}
+
+// 停止所有线程的采样定时器
+// 调用者需持有g_profile_lock
+static void stop_timers(void) {
+    for (size_t i = 0; i < g_profile_timer_count; i += 1) {
+        timer_delete(g_profile_timers[i]);
+    }
+    g_profile_timer_count = 0;
+    g_is_profiling = false;
+    atomic_fetch_add_explicit(&g_profile_generation, 1, memory_order_release);
+}
+
+// 释放样本缓冲区，仍在途中的信号不会再访问它
+// 调用者需持有g_profile_lock
+static void free_samples(void) {
+    block_samples();
+    free(g_profile_samples);
+    g_profile_samples = nullptr;
+    atomic_store_explicit(&g_profile_next, 0, memory_order_relaxed);
+}
+
+// 安装SIGPROF的处理函数
+// 调用者需持有g_profile_lock
+static bool install_handler(void) {
+    if (g_is_handler_installed) {
+        return true;
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = profile_signal_handler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (0 != sigaction(SIGPROF, &action, &g_previous_action)) {
+        return false;
+    }
+    g_is_handler_installed = true;
+    return true;
+}
+
+// 卸载SIGPROF的处理函数，定时器必须已经停止
+// 之前没有处理函数时改为忽略，以免仍在途中的信号按默认行为终止进程
+// 调用者需持有g_profile_lock
+static void uninstall_handler(void) {
+    if (!g_is_handler_installed) {
+        return;
+    }
+    if (SIG_DFL == g_previous_action.sa_handler) {
+        g_previous_action.sa_handler = SIG_IGN;
+    }
+    sigaction(SIGPROF, &g_previous_action, nullptr);
+    g_is_handler_installed = false;
+}
+
+// 为当前线程创建并启动采样定时器，以本线程消耗的CPU时间计时
+// 调用者需持有g_profile_lock
+static bool start_thread_timer(const unsigned frequency_hz) {
+    if (g_profile_timer_count == g_profile_timer_capacity) {
+        const size_t capacity = g_profile_timer_capacity > 0 ? g_profile_timer_capacity * 2 : 16;
+        timer_t *timers = realloc(g_profile_timers, capacity * sizeof(*timers));
+        if (nullptr == timers) {
+            return false;
+        }
+        g_profile_timers = timers;
+        g_profile_timer_capacity = capacity;
+    }
+    struct sigevent event;
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = (pid_t) syscall(SYS_gettid);
+    timer_t timer;
+    if (0 != timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer)) {
+        return false;
+    }
+    const long interval_ns = 1000000000L / (long) frequency_hz;
+    const struct itimerspec spec = {
+        .it_interval = {.tv_sec = interval_ns / 1000000000L, .tv_nsec = interval_ns % 1000000000L},
+        .it_value = {.tv_sec = interval_ns / 1000000000L, .tv_nsec = interval_ns % 1000000000L},
+    };
+    if (0 != timer_settime(timer, 0, &spec, nullptr)) {
+        timer_delete(timer);
+        return false;
+    }
+    g_profile_timers[g_profile_timer_count] = timer;
+    g_profile_timer_count += 1;
+    return true;
+}
+
+bool ezs_benchmark_enable_profiler(const unsigned frequency_hz, const size_t max_samples) {
+    if (0 == frequency_hz || frequency_hz > PROFILE_MAX_FREQUENCY || 0 == max_samples ||
+        max_samples > SIZE_MAX / sizeof(ProfileSample)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Invalid profiler settings (%u Hz, %zu samples). The profiler is not enabled.\n",
+                frequency_hz, max_samples);
+        return false;
+    }
+    i_ezs_benchmark_register_atexit();
+    // 预先加载backtrace依赖的库，使信号处理函数中的调用不再分配内存
+    void *warmup[1];
+    backtrace(warmup, 1);
+
+    lock_profile();
+    stop_timers();
+    free_samples();
+    g_profile_samples = calloc(max_samples, sizeof(*g_profile_samples));
+    if (nullptr == g_profile_samples) {
+        unlock_profile();
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate the profile buffer. The profiler is not enabled.\n");
+        return false;
+    }
+    atomic_store_explicit(&g_profile_capacity, max_samples, memory_order_release);
+    if (!install_handler() || !start_thread_timer(frequency_hz)) {
+        stop_timers();
+        free_samples();
+        unlock_profile();
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to start the profiling timer. The profiler is not enabled.\n");
+        return false;
+    }
+    // 本线程的定时器已经创建，其他线程在开始计时时创建
+    g_profile_frequency = frequency_hz;
+    g_is_profiling = true;
+    t_profile_generation = atomic_load_explicit(&g_profile_generation, memory_order_relaxed);
+    unlock_profile();
+    return true;
+}
+
+void ezs_benchmark_disable_profiler(void) {
+    lock_profile();
+    stop_timers();
+    unlock_profile();
+}
+
+/*---------------------------EZS_BENCHMARK_PROFILE 符号解析---------------------------*/
+
+typedef struct {
+    uintptr_t address; // 查询的地址
+    uintptr_t function; // 所在函数的起始地址，无法确定时等于address
+    char name[PROFILE_NAME_SIZE];
+} Symbol;
+
+// 样本中第index帧用于解析的地址
+// 除被中断的位置外，其余各帧为返回地址，减1后才落在调用指令所在的函数中
+static uintptr_t frame_address(const ProfileSample *sample, const uint32_t index) {
+    const uintptr_t address = (uintptr_t) sample->frames[index];
+    return 0 == index || 0 == address ? address : address - 1;
+}
+
+static void resolve_symbol(Symbol *symbol) {
+    symbol->function = symbol->address;
+    Dl_info info;
+    if (0 == dladdr((void *) symbol->address, &info)) {
+        snprintf(symbol->name, sizeof(symbol->name), "0x%" PRIxPTR, symbol->address);
+        return;
+    }
+    if (nullptr != info.dli_sname && nullptr != info.dli_saddr) {
+        symbol->function = (uintptr_t) info.dli_saddr;
+        snprintf(symbol->name, sizeof(symbol->name), "%s", info.dli_sname);
+        return;
+    }
+    // 不在动态符号表中的函数，以模块名加偏移表示
+    const char *module = nullptr != info.dli_fname ? info.dli_fname : "?";
+    const char *slash = strrchr(module, '/');
+    snprintf(symbol->name, sizeof(symbol->name), "%s+0x%" PRIxPTR,
+             nullptr != slash ? slash + 1 : module, symbol->address - (uintptr_t) info.dli_fbase);
+}
+
+static int compare_address(const void *a, const void *b) {
+    const uintptr_t lhs = *(const uintptr_t *) a;
+    const uintptr_t rhs = *(const uintptr_t *) b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static int compare_symbol_address(const void *key, const void *element) {
+    const uintptr_t address = *(const uintptr_t *) key;
+    const uintptr_t symbol = ((const Symbol *) element)->address;
+    return (address > symbol) - (address < symbol);
+}
+
+// 对addresses排序去重后逐一解析，结果按地址升序排列
+// 失败时返回nullptr
+static Symbol *resolve_symbols(uintptr_t *addresses, const size_t count, size_t *symbol_count) {
+    *symbol_count = 0;
+    if (count > 0) {
+        qsort(addresses, count, sizeof(*addresses), compare_address);
+    }
+    Symbol *symbols = malloc((count > 0 ? count : 1) * sizeof(*symbols));
+    if (nullptr == symbols) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < count; i += 1) {
+        if (i > 0 && addresses[i] == addresses[i - 1]) {
+            continue;
+        }
+        symbols[*symbol_count].address = addresses[i];
+        resolve_symbol(&symbols[*symbol_count]);
+        *symbol_count += 1;
+    }
+    return symbols;
+}
+
+static const Symbol *find_symbol(const Symbol *symbols, const size_t count, const uintptr_t address) {
+    return bsearch(&address, symbols, count, sizeof(*symbols), compare_symbol_address);
+}
+
+// 已写完的样本数，调用者需持有g_profile_lock
+static size_t recorded_sample_count(void) {
+    const size_t next = atomic_load_explicit(&g_profile_next, memory_order_relaxed);
+    const size_t capacity = atomic_load_explicit(&g_profile_capacity, memory_order_acquire);
+    return next < capacity ? next : capacity;
+}
+
+static uint32_t sample_depth(const ProfileSample *sample) {
+    return atomic_load_explicit(&sample->depth, memory_order_acquire);
+}
+
+// 收集前count个样本中已写完的样本
+// 采样可能仍在进行，此后写完的样本不会出现在结果中
+// 调用者需持有g_profile_lock，失败时返回nullptr
+static const ProfileSample **collect_ready_samples(const size_t count, size_t *ready_count) {
+    *ready_count = 0;
+    const ProfileSample **samples = malloc((count > 0 ? count : 1) * sizeof(*samples));
+    if (nullptr == samples) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < count; i += 1) {
+        if (sample_depth(&g_profile_samples[i]) > 0) {
+            samples[*ready_count] = &g_profile_samples[i];
+            *ready_count += 1;
+        }
+    }
+    return samples;
+}
+
+// 区域的名称，不在任何区域中时为"[no region]"
+static const char *region_name(const ezs_benchmark_id region) {
+    const char *name = EZS_BENCHMARK_INVALID_ID != region ? ezs_benchmark_name(region) : nullptr;
+    return nullptr != name ? name : "[no region]";
+}
+
+/*---------------------------EZS_BENCHMARK_PROFILE 平面报告---------------------------*/
+
+// 区域中的一个函数
+typedef struct {
+    ezs_benchmark_id region;
+    uintptr_t function;
+    const Symbol *symbol;
+    uint64_t samples;
+    uint64_t region_samples; // 所在区域的样本总数
+} ProfileRow;
+
+static int compare_row_key(const void *a, const void *b) {
+    const ProfileRow *lhs = a;
+    const ProfileRow *rhs = b;
+    if (lhs->region != rhs->region) {
+        return (lhs->region > rhs->region) - (lhs->region < rhs->region);
+    }
+    return (lhs->function > rhs->function) - (lhs->function < rhs->function);
+}
+
+// 区域样本多的在前，同一区域内函数样本多的在前
+static int compare_row_rank(const void *a, const void *b) {
+    const ProfileRow *lhs = a;
+    const ProfileRow *rhs = b;
+    if (lhs->region_samples != rhs->region_samples) {
+        return (lhs->region_samples < rhs->region_samples) - (lhs->region_samples > rhs->region_samples);
+    }
+    if (lhs->region != rhs->region) {
+        return (lhs->region > rhs->region) - (lhs->region < rhs->region);
+    }
+    return (lhs->samples < rhs->samples) - (lhs->samples > rhs->samples);
+}
+
+static const i_ezs_table_column PROFILE_COLUMNS[] = {
+    {"Region", 20, true},
+    {"Function", 32, true},
+    {"Samples", 10, false},
+    {"Region %", 9, false},
+    {"Total %", 8, false},
+};
+#define PROFILE_COLUMN_COUNT (sizeof(PROFILE_COLUMNS) / sizeof(PROFILE_COLUMNS[0]))
+
+// 按区域聚合最内层的函数并打印
+// 调用者需持有g_profile_lock
+static void print_flat_profile(const size_t count) {
+    size_t row_count = 0;
+    const ProfileSample **samples = collect_ready_samples(count, &row_count);
+    uintptr_t *addresses = malloc((row_count > 0 ? row_count : 1) * sizeof(*addresses));
+    ProfileRow *rows = malloc((row_count > 0 ? row_count : 1) * sizeof(*rows));
+    Symbol *symbols = nullptr;
+    size_t symbol_count = 0;
+    if (nullptr != samples && nullptr != addresses && nullptr != rows) {
+        for (size_t i = 0; i < row_count; i += 1) {
+            addresses[i] = frame_address(samples[i], 0);
+        }
+        symbols = resolve_symbols(addresses, row_count, &symbol_count);
+    }
+    free(addresses);
+    if (nullptr == symbols) {
+        free(samples);
+        free(rows);
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate memory for the profile report.\n");
+        return;
+    }
+
+    // 以(区域, 函数)为键聚合
+    for (size_t i = 0; i < row_count; i += 1) {
+        const Symbol *symbol = find_symbol(symbols, symbol_count, frame_address(samples[i], 0));
+        rows[i] = (ProfileRow){.region = samples[i]->region, .function = symbol->function, .symbol = symbol};
+    }
+    free(samples);
+    if (row_count > 0) {
+        qsort(rows, row_count, sizeof(*rows), compare_row_key);
+    }
+    size_t unique_count = 0;
+    for (size_t i = 0; i < row_count; i += 1) {
+        if (unique_count > 0 && 0 == compare_row_key(&rows[unique_count - 1], &rows[i])) {
+            rows[unique_count - 1].samples += 1;
+            continue;
+        }
+        rows[unique_count] = rows[i];
+        rows[unique_count].samples = 1;
+        unique_count += 1;
+    }
+    // 计算每个区域的样本总数
+    for (size_t begin = 0; begin < unique_count;) {
+        size_t end = begin;
+        uint64_t region_samples = 0;
+        while (end < unique_count && rows[end].region == rows[begin].region) {
+            region_samples += rows[end].samples;
+            end += 1;
+        }
+        for (size_t i = begin; i < end; i += 1) {
+            rows[i].region_samples = region_samples;
+        }
+        begin = end;
+    }
+    if (unique_count > 0) {
+        qsort(rows, unique_count, sizeof(*rows), compare_row_rank);
+    }
+
+    i_ezs_table_print_header("Sampling Profile", PROFILE_COLUMNS, PROFILE_COLUMN_COUNT);
+    int printed_in_region = 0;
+    for (size_t i = 0; i < unique_count; i += 1) {
+        printed_in_region = i > 0 && rows[i].region == rows[i - 1].region ? printed_in_region + 1 : 0;
+        if (printed_in_region >= PROFILE_TOP_FUNCTIONS) {
+            continue;
+        }
+        char samples_buf[32], region_share_buf[32], total_share_buf[32];
+        snprintf(samples_buf, sizeof(samples_buf), "%" PRIu64, rows[i].samples);
+        snprintf(region_share_buf, sizeof(region_share_buf), "%.2f%%",
+                 (double) rows[i].samples / (double) rows[i].region_samples * 100.0);
+        snprintf(total_share_buf, sizeof(total_share_buf), "%.2f%%",
+                 (double) rows[i].samples / (double) row_count * 100.0);
+        const char *const cells[PROFILE_COLUMN_COUNT] = {
+            0 == printed_in_region ? region_name(rows[i].region) : "",
+            rows[i].symbol->name, samples_buf, region_share_buf, total_share_buf
+        };
+        i_ezs_table_print_row(PROFILE_COLUMNS, PROFILE_COLUMN_COUNT, cells);
+    }
+    i_ezs_table_print_footer(PROFILE_COLUMNS, PROFILE_COLUMN_COUNT);
+    printf("[EZS] %zu samples at %u Hz of CPU time, top %d functions per region by innermost frame\n\n",
+           row_count, g_profile_frequency, PROFILE_TOP_FUNCTIONS);
+    free(symbols);
+    free(rows);
+}
+
+// 打印采样分析的结果，only_if_sampled为true时没有样本则不打印
+static void print_profile(const bool only_if_sampled) {
+    lock_profile();
+    const size_t count = recorded_sample_count();
+    if (0 == count && only_if_sampled) {
+        unlock_profile();
+        return;
+    }
+    const size_t next = atomic_load_explicit(&g_profile_next, memory_order_relaxed);
+    if (next > count && count > 0) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "%zu profile samples were dropped because the profile buffer is full. "
+                "Use a larger buffer or a lower frequency.\n", next - count);
+    }
+    print_flat_profile(count);
+    unlock_profile();
+}
+
+void ezs_benchmark_print_profile(void) {
+    print_profile(false);
+}
+
+/*---------------------------EZS_BENCHMARK_PROFILE 折叠栈---------------------------*/
+
+// 折叠栈中一行的最大长度（不含样本数）
+#define COLLAPSED_LINE_SIZE ((PROFILE_MAX_DEPTH + 1) * PROFILE_NAME_SIZE)
+
+// 以折叠栈格式追加一个帧名，分号与换行是格式中的分隔符，替换为下划线
+static size_t append_collapsed_frame(char *line, size_t length, const char *name) {
+    if (length > 0 && length + 1 < COLLAPSED_LINE_SIZE) {
+        line[length] = ';';
+        length += 1;
+    }
+    for (const char *p = name; '\0' != *p && length + 1 < COLLAPSED_LINE_SIZE; p += 1) {
+        line[length] = ';' == *p || '\n' == *p ? '_' : *p;
+        length += 1;
+    }
+    line[length] = '\0';
+    return length;
+}
+
+// 生成一个样本的栈：区域;最外层函数;...;最内层函数
+// 不同的地址可能属于同一个函数，因此以解析后的名称而不是地址区分栈
+// 失败时返回nullptr
+static char *format_collapsed_stack(const ProfileSample *sample, const Symbol *symbols, const size_t symbol_count) {
+    char line[COLLAPSED_LINE_SIZE];
+    size_t length = append_collapsed_frame(line, 0, region_name(sample->region));
+    for (uint32_t i = sample_depth(sample); i > 0; i -= 1) {
+        length = append_collapsed_frame(line, length,
+                                        find_symbol(symbols, symbol_count, frame_address(sample, i - 1))->name);
+    }
+    return strdup(line);
+}
+
+static int compare_string(const void *a, const void *b) {
+    return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+static void free_strings(char **strings, const size_t count) {
+    if (nullptr == strings) {
+        return;
+    }
+    for (size_t i = 0; i < count; i += 1) {
+        free(strings[i]);
+    }
+    free(strings);
+}
+
+// 生成所有已写完的样本的栈，失败时返回nullptr
+// 调用者需持有g_profile_lock
+static char **collect_collapsed_stacks(size_t *stack_count) {
+    *stack_count = 0;
+    size_t sample_count = 0;
+    const ProfileSample **samples = collect_ready_samples(recorded_sample_count(), &sample_count);
+    if (nullptr == samples) {
+        return nullptr;
+    }
+    size_t address_count = 0;
+    for (size_t i = 0; i < sample_count; i += 1) {
+        address_count += sample_depth(samples[i]);
+    }
+    uintptr_t *addresses = malloc((address_count > 0 ? address_count : 1) * sizeof(*addresses));
+    char **stacks = calloc(sample_count > 0 ? sample_count : 1, sizeof(*stacks));
+    Symbol *symbols = nullptr;
+    size_t symbol_count = 0;
+    if (nullptr != addresses && nullptr != stacks) {
+        size_t filled = 0;
+        for (size_t i = 0; i < sample_count; i += 1) {
+            for (uint32_t j = 0; j < sample_depth(samples[i]); j += 1) {
+                addresses[filled] = frame_address(samples[i], j);
+                filled += 1;
+            }
+        }
+        symbols = resolve_symbols(addresses, address_count, &symbol_count);
+    }
+    free(addresses);
+    bool is_complete = nullptr != symbols;
+    for (size_t i = 0; is_complete && i < sample_count; i += 1) {
+        stacks[i] = format_collapsed_stack(samples[i], symbols, symbol_count);
+        is_complete = nullptr != stacks[i];
+    }
+    free(symbols);
+    free(samples);
+    if (!is_complete) {
+        free_strings(stacks, sample_count);
+        return nullptr;
+    }
+    *stack_count = sample_count;
+    return stacks;
+}
+
+bool ezs_benchmark_export_collapsed(const char *path) {
+    lock_profile();
+    size_t stack_count = 0;
+    char **stacks = collect_collapsed_stacks(&stack_count);
+    unlock_profile();
+    if (nullptr == stacks) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate memory for the collapsed stacks.\n");
+        return false;
+    }
+    FILE *file = fopen(path, "w");
+    if (nullptr == file) {
+        free_strings(stacks, stack_count);
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to open '%s' for the collapsed stack export.\n", path);
+        return false;
+    }
+
+    // 排序后相同的栈相邻，合并为一行
+    if (stack_count > 0) {
+        qsort(stacks, stack_count, sizeof(*stacks), compare_string);
+    }
+    for (size_t begin = 0; begin < stack_count;) {
+        size_t end = begin + 1;
+        while (end < stack_count && 0 == strcmp(stacks[begin], stacks[end])) {
+            end += 1;
+        }
+        fprintf(file, "%s %zu\n", stacks[begin], end - begin);
+        begin = end;
+    }
+    free_strings(stacks, stack_count);
+    const bool is_written = !ferror(file);
+    if (0 != fclose(file) || !is_written) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to write the collapsed stack export '%s'.\n", path);
+        return false;
+    }
+    return true;
+}
+
+/*---------------------------EZS_BENCHMARK_PROFILE 内部接口---------------------------*/
+
+void i_ezs_benchmark_profile_print_all(void) {
+    print_profile(true);
+}
+
+void i_ezs_benchmark_profile_clear(void) {
+    lock_profile();
+    if (nullptr != g_profile_samples) {
+        // 先阻止新样本写入，清空后再恢复
+        const size_t capacity = block_samples();
+        for (size_t i = 0; i < capacity; i += 1) {
+            atomic_store_explicit(&g_profile_samples[i].depth, 0, memory_order_relaxed);
+        }
+        atomic_store_explicit(&g_profile_next, 0, memory_order_relaxed);
+        atomic_store_explicit(&g_profile_capacity, capacity, memory_order_release);
+    }
+    unlock_profile();
+}
+
+void i_ezs_benchmark_profile_drop(void) {
+    lock_profile();
+    stop_timers();
+    uninstall_handler();
+    free_samples();
+    free(g_profile_timers);
+    g_profile_timers = nullptr;
+    g_profile_timer_capacity = 0;
+    g_profile_frequency = 0;
+    unlock_profile();
+}
+
+void i_ezs_benchmark_profile_prepare_thread(void) {
+    if (t_profile_generation == atomic_load_explicit(&g_profile_generation, memory_order_acquire)) {
+        return;
+    }
+    lock_profile();
+    t_profile_generation = atomic_load_explicit(&g_profile_generation, memory_order_relaxed);
+    const bool is_started = !g_is_profiling || start_thread_timer(g_profile_frequency);
+    unlock_profile();
+    if (!is_started) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Failed to start the profiling timer of this thread. This thread is not sampled.\n");
+    }
+}
+
+#else
+
+bool ezs_benchmark_enable_profiler(const unsigned frequency_hz, const size_t max_samples) {
+    (void) frequency_hz;
+    (void) max_samples;
+    fprintf(stderr, "[EZS BENCHMARK][WARN] "
+            "The sampling profiler is only supported on Linux. The profiler is not enabled.\n");
+    return false;
+}
+
+void ezs_benchmark_disable_profiler(void) {
+}
+
+void ezs_benchmark_print_profile(void) {
+}
+
+bool ezs_benchmark_export_collapsed(const char *path) {
+    fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+            "The sampling profiler is only supported on Linux. '%s' is not written.\n", path);
+    return false;
+}
+
+void i_ezs_benchmark_profile_print_all(void) {
+}
+
+void i_ezs_benchmark_profile_clear(void) {
+}
+
+void i_ezs_benchmark_profile_drop(void) {
+}
+
+void i_ezs_benchmark_profile_prepare_thread(void) {
+}
+
+#endif
+
+/*---------------------------清理局部宏---------------------------*/
+
+#undef PROFILE_MAX_DEPTH
+#undef PROFILE_SKIPPED_FRAMES
+#undef PROFILE_SEARCHED_FRAMES
+#undef PROFILE_NAME_SIZE
+#undef PROFILE_COLUMN_COUNT
+#undef COLLAPSED_LINE_SIZE
@@ -0,0 +1,91 @@
+#include "EazyStart/time/clock.h"
+#include "benchmark_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+/*---------------------------EZS_BENCHMARK 计时工具---------------------------*/
+
+uint64_t i_ezs_benchmark_now_ns(void) {
+    struct timespec ts = {};
+    if (!ezs_clock_get_performance_counter(&ts, nullptr, 0)) {
+        fprintf(stderr, "[EZS BENCHMARK][FATAL] "
+                "Failed to get high-resolution time. Benchmark cannot proceed.\n");
+        exit(EXIT_FAILURE);
+    }
+    return i_ezs_benchmark_timespec_to_ns(ts);
+}
+
+/*---------------------------EZS_BENCHMARK 命名结果表---------------------------*/
+
+static once_flag g_records_lock_once = ONCE_FLAG_INIT;
+static mtx_t g_records_lock;
+
+static void init_records_lock(void) {
+    if (thrd_success != mtx_init(&g_records_lock, mtx_plain)) {
+        fprintf(stderr, "[EZS BENCHMARK][FATAL] "
+                "Failed to initialize the benchmark lock. Benchmark cannot proceed.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void i_ezs_benchmark_records_lock(void) {
+    call_once(&g_records_lock_once, init_records_lock);
+    mtx_lock(&g_records_lock);
+}
+
+void i_ezs_benchmark_records_unlock(void) {
+    mtx_unlock(&g_records_lock);
+}
+
+void *i_ezs_benchmark_records_value(const i_ezs_benchmark_records *records, const size_t index) {
+    return records->values + index * records->value_size;
+}
+
+// 将表的容量扩大一倍，调用者需持有锁
+static bool grow_records(i_ezs_benchmark_records *records) {
+    const size_t capacity = records->capacity > 0 ? records->capacity * 2 : 4;
+    char **names = realloc(records->names, capacity * sizeof(*names));
+    if (nullptr == names) {
+        return false;
+    }
+    records->names = names;
+    unsigned char *values = realloc(records->values, capacity * records->value_size);
+    if (nullptr == values) {
+        return false;
+    }
+    records->values = values;
+    records->capacity = capacity;
+    return true;
+}
+
+bool i_ezs_benchmark_records_save(i_ezs_benchmark_records *records, const char *name, const void *value) {
+    i_ezs_benchmark_records_lock();
+    for (size_t i = 0; i < records->count; i += 1) {
+        if (0 == strcmp(records->names[i], name)) {
+            memcpy(i_ezs_benchmark_records_value(records, i), value, records->value_size);
+            i_ezs_benchmark_records_unlock();
+            return true;
+        }
+    }
+    char *name_copy = nullptr;
+    if ((records->count < records->capacity || grow_records(records)) && nullptr != (name_copy = strdup(name))) {
+        records->names[records->count] = name_copy;
+        memcpy(i_ezs_benchmark_records_value(records, records->count), value, records->value_size);
+        records->count += 1;
+    }
+    i_ezs_benchmark_records_unlock();
+    return nullptr != name_copy;
+}
+
+void i_ezs_benchmark_records_clear(i_ezs_benchmark_records *records) {
+    i_ezs_benchmark_records_lock();
+    for (size_t i = 0; i < records->count; i += 1) {
+        free(records->names[i]);
+    }
+    free(records->names);
+    free(records->values);
+    *records = (i_ezs_benchmark_records){.value_size = records->value_size};
+    i_ezs_benchmark_records_unlock();
+}
@@ -0,0 +1,372 @@
+#include "EazyStart/time/benchmark_run.h"
+#include "EazyStart/time/benchmark.h"
+#include "benchmark_internal.h"
+#include "table.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+/*---------------------------EZS_BENCHMARK_RUN 防优化原语---------------------------*/
+
+void i_ezs_clobber_memory(void) {
+    static volatile int sink = 0;
+    sink = sink;
+}
+
+/*---------------------------EZS_BENCHMARK_RUN 计时工具---------------------------*/
+
+// 测量时钟的有效精度：连续两次读取时钟得到的最小非零间隔
+// 它同时包含了时钟的分辨率与一次读取的开销
+static uint64_t measure_timer_granularity(void) {
+    uint64_t granularity = UINT64_MAX;
+    for (int i = 0; i < 1000; i += 1) {
+        const uint64_t start = i_ezs_benchmark_now_ns();
+        uint64_t end = i_ezs_benchmark_now_ns();
+        while (end == start) {
+            end = i_ezs_benchmark_now_ns();
+        }
+        if (end - start < granularity) {
+            granularity = end - start;
+        }
+    }
+    return granularity;
+}
+
+static once_flag g_granularity_once = ONCE_FLAG_INIT;
+static uint64_t g_timer_granularity = 0;
+
+static void init_timer_granularity(void) {
+    g_timer_granularity = measure_timer_granularity();
+}
+
+// 调用function共batch_size次，返回总耗时（纳秒）
+static uint64_t run_batch(const ezs_benchmark_function function, void *context, const uint64_t batch_size) {
+    const uint64_t start = i_ezs_benchmark_now_ns();
+    for (uint64_t i = 0; i < batch_size; i += 1) {
+        function(context);
+    }
+    return i_ezs_benchmark_now_ns() - start;
+}
+
+/*---------------------------EZS_BENCHMARK_RUN 结果记录---------------------------*/
+
+static i_ezs_benchmark_records g_records = I_EZS_BENCHMARK_RECORDS_INIT(ezs_benchmark_run_result);
+
+// 规模扫描的结果
+typedef struct {
+    uint64_t min_n;
+    uint64_t max_n; // 实际测量的最大规模
+    ezs_benchmark_sweep_result result;
+} SweepRecord;
+
+static i_ezs_benchmark_records g_sweeps = I_EZS_BENCHMARK_RECORDS_INIT(SweepRecord);
+
+static const i_ezs_table_column RUN_COLUMNS[] = {
+    {"Benchmark Name", 20, true},
+    {"Time/Op", 10, false},
+    {"Min/Op", 10, false},
+    {"Std Dev/Op", 10, false},
+    {"RSE", 8, false},
+    {"Batch", 12, false},
+    {"Samples", 10, false},
+    {"Converged", 9, false},
+};
+#define RUN_COLUMN_COUNT (sizeof(RUN_COLUMNS) / sizeof(RUN_COLUMNS[0]))
+
+static const i_ezs_table_column SWEEP_COLUMNS[] = {
+    {"Sweep Name", 20, true},
+    {"Points", 6, false},
+    {"Range", 15, false},
+    {"Complexity", 12, false},
+    {"Coefficient", 11, false},
+    {"RMS", 8, false},
+};
+#define SWEEP_COLUMN_COUNT (sizeof(SWEEP_COLUMNS) / sizeof(SWEEP_COLUMNS[0]))
+
+// 调用者需持有结果表的锁
+static void print_sweep_table(void) {
+    if (0 == g_sweeps.count) {
+        return;
+    }
+    i_ezs_table_print_header("Complexity Table", SWEEP_COLUMNS, SWEEP_COLUMN_COUNT);
+    for (size_t i = 0; i < g_sweeps.count; i += 1) {
+        const SweepRecord *record = i_ezs_benchmark_records_value(&g_sweeps, i);
+        char points_buf[32], min_buf[16], max_buf[16], range_buf[40], coefficient_buf[32], rms_buf[32];
+        snprintf(points_buf, sizeof(points_buf), "%zu", record->result.point_count);
+        i_ezs_table_format_count((double) record->min_n, min_buf, sizeof(min_buf));
+        i_ezs_table_format_count((double) record->max_n, max_buf, sizeof(max_buf));
+        snprintf(range_buf, sizeof(range_buf), "%s..%s", min_buf, max_buf);
+        i_ezs_table_format_nanoseconds(record->result.coefficient_ns, coefficient_buf, sizeof(coefficient_buf));
+        snprintf(rms_buf, sizeof(rms_buf), "%.2f%%", record->result.rms * 100.0);
+        const char *const cells[SWEEP_COLUMN_COUNT] = {
+            g_sweeps.names[i], points_buf, range_buf, ezs_benchmark_complexity_name(record->result.complexity),
+            coefficient_buf, rms_buf
+        };
+        i_ezs_table_print_row(SWEEP_COLUMNS, SWEEP_COLUMN_COUNT, cells);
+    }
+    i_ezs_table_print_footer(SWEEP_COLUMNS, SWEEP_COLUMN_COUNT);
+    printf("[EZS] Time per call ~ Coefficient x f(n), RMS is relative to the mean time over all sizes\n\n");
+}
+
+void i_ezs_benchmark_run_print_all(void) {
+    i_ezs_benchmark_records_lock();
+    if (0 == g_records.count) {
+        i_ezs_benchmark_records_unlock();
+        return;
+    }
+    i_ezs_table_print_header("Micro-Benchmark Result Table", RUN_COLUMNS, RUN_COLUMN_COUNT);
+    for (size_t i = 0; i < g_records.count; i += 1) {
+        const ezs_benchmark_run_result *result = i_ezs_benchmark_records_value(&g_records, i);
+        char mean_buf[32], min_buf[32], std_dev_buf[32], rse_buf[32], batch_buf[32], samples_buf[32];
+        i_ezs_table_format_nanoseconds(result->mean_ns, mean_buf, sizeof(mean_buf));
+        i_ezs_table_format_nanoseconds(result->min_ns, min_buf, sizeof(min_buf));
+        i_ezs_table_format_nanoseconds(result->std_dev_ns, std_dev_buf, sizeof(std_dev_buf));
+        snprintf(rse_buf, sizeof(rse_buf), "%.2f%%", result->relative_standard_error * 100.0);
+        snprintf(batch_buf, sizeof(batch_buf), "%" PRIu64, result->batch_size);
+        snprintf(samples_buf, sizeof(samples_buf), "%" PRIu64, result->sample_count);
+        const char *const cells[RUN_COLUMN_COUNT] = {
+            g_records.names[i], mean_buf, min_buf, std_dev_buf, rse_buf, batch_buf, samples_buf,
+            result->converged ? "yes" : "no"
+        };
+        i_ezs_table_print_row(RUN_COLUMNS, RUN_COLUMN_COUNT, cells);
+    }
+    i_ezs_table_print_footer(RUN_COLUMNS, RUN_COLUMN_COUNT);
+    print_sweep_table();
+    i_ezs_benchmark_records_unlock();
+}
+
+void i_ezs_benchmark_run_clear(void) {
+    i_ezs_benchmark_records_clear(&g_records);
+    i_ezs_benchmark_records_clear(&g_sweeps);
+}
+
+/*---------------------------EZS_BENCHMARK_RUN 运行器---------------------------*/
+
+ezs_benchmark_run_options ezs_benchmark_run_default_options(void) {
+    return (ezs_benchmark_run_options){
+        .warmup_time = {.tv_sec = 0, .tv_nsec = 100 * 1000 * 1000},
+        .time_budget = {.tv_sec = 1, .tv_nsec = 0},
+        .min_sample_time = {.tv_sec = 0, .tv_nsec = 10 * 1000},
+        .target_relative_error = 0.01,
+        .min_samples = 10,
+        .max_samples = 100 * 1000,
+    };
+}
+
+ezs_benchmark_run_result ezs_benchmark_run(const char *name, const ezs_benchmark_function function, void *context,
+                                           const ezs_benchmark_run_options *options) {
+    const ezs_benchmark_run_options opts = nullptr != options ? *options : ezs_benchmark_run_default_options();
+    i_ezs_benchmark_register_atexit();
+    call_once(&g_granularity_once, init_timer_granularity);
+
+    // 预热：批量逐步翻倍，避免每次调用都读取时钟
+    const uint64_t warmup_ns = i_ezs_benchmark_timespec_to_ns(opts.warmup_time);
+    for (uint64_t elapsed = 0, batch = 1; elapsed < warmup_ns; batch *= 2) {
+        elapsed += run_batch(function, context, batch);
+    }
+
+    // 校准：增大批量直到一个样本的耗时不小于目标
+    const uint64_t budget_start = i_ezs_benchmark_now_ns();
+    const uint64_t budget_ns = i_ezs_benchmark_timespec_to_ns(opts.time_budget);
+    uint64_t target_sample_ns = i_ezs_benchmark_timespec_to_ns(opts.min_sample_time);
+    if (target_sample_ns < g_timer_granularity * 1000) {
+        target_sample_ns = g_timer_granularity * 1000;
+    }
+    uint64_t batch_size = 1;
+    while (true) {
+        const uint64_t elapsed = run_batch(function, context, batch_size);
+        if (elapsed >= target_sample_ns || i_ezs_benchmark_now_ns() - budget_start >= budget_ns || batch_size >= UINT64_MAX / 16) {
+            break;
+        }
+        // 按比例估算所需的批量，并限制单次增长在[2, 10]倍之间
+        const double ratio = elapsed > 0 ? (double) target_sample_ns / (double) elapsed * 1.2 : 10.0;
+        const double growth = ratio < 2.0 ? 2.0 : ratio > 10.0 ? 10.0 : ratio;
+        batch_size = (uint64_t) ((double) batch_size * growth);
+    }
+
+    // 采样：对每次调用的耗时维护Welford方差
+    ezs_benchmark_run_result result = {.batch_size = batch_size, .min_ns = INFINITY};
+    double mean = 0.0, corrected_sum_squares = 0.0;
+    while (result.sample_count < opts.max_samples) {
+        const double per_op = (double) run_batch(function, context, batch_size) / (double) batch_size;
+        result.sample_count += 1;
+        result.total_iterations += batch_size;
+        const double delta = per_op - mean;
+        mean += delta / (double) result.sample_count;
+        corrected_sum_squares += delta * (per_op - mean);
+        if (per_op < result.min_ns) {
+            result.min_ns = per_op;
+        }
+
+        if (result.sample_count >= opts.min_samples && result.sample_count > 1) {
+            const double std_dev = sqrt(corrected_sum_squares / (double) (result.sample_count - 1));
+            const double standard_error = std_dev / sqrt((double) result.sample_count);
+            result.relative_standard_error = mean > 0.0 ? standard_error / mean : 0.0;
+            if (result.relative_standard_error <= opts.target_relative_error) {
+                result.converged = true;
+                break;
+            }
+        }
+        if (i_ezs_benchmark_now_ns() - budget_start >= budget_ns && result.sample_count >= 2) {
+            break;
+        }
+    }
+    result.mean_ns = mean;
+    result.std_dev_ns = result.sample_count > 1
+                            ? sqrt(corrected_sum_squares / (double) (result.sample_count - 1))
+                            : 0.0;
+    if (!result.converged && result.sample_count > 1) {
+        result.relative_standard_error = mean > 0.0
+                                             ? result.std_dev_ns / sqrt((double) result.sample_count) / mean
+                                             : 0.0;
+    }
+    if (!result.converged) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Micro-benchmark '%s' did not reach the target relative error (%.2f%% > %.2f%%) "
+                "within the budget.\n",
+                name, result.relative_standard_error * 100.0, opts.target_relative_error * 100.0);
+    }
+    if (!i_ezs_benchmark_records_save(&g_records, name, &result)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to record the result of '%s'.\n", name);
+    }
+    return result;
+}
+
+/*---------------------------EZS_BENCHMARK_RUN 规模扫描---------------------------*/
+
+// 一次扫描最多测量的规模个数
+static constexpr size_t SWEEP_MAX_POINTS = 64;
+
+static const char *const COMPLEXITY_NAMES[] = {
+    [EZS_BENCHMARK_O_1] = "O(1)",
+    [EZS_BENCHMARK_O_LOG_N] = "O(log n)",
+    [EZS_BENCHMARK_O_N] = "O(n)",
+    [EZS_BENCHMARK_O_N_LOG_N] = "O(n log n)",
+    [EZS_BENCHMARK_O_N_SQUARED] = "O(n^2)",
+};
+#define COMPLEXITY_COUNT (sizeof(COMPLEXITY_NAMES) / sizeof(COMPLEXITY_NAMES[0]))
+
+const char *ezs_benchmark_complexity_name(const ezs_benchmark_complexity complexity) {
+    return (size_t) complexity < COMPLEXITY_COUNT ? COMPLEXITY_NAMES[complexity] : "O(?)";
+}
+
+// 复杂度模型f(n)
+static double complexity_function(const ezs_benchmark_complexity complexity, const double n) {
+    switch (complexity) {
+        case EZS_BENCHMARK_O_1:
+            return 1.0;
+        case EZS_BENCHMARK_O_LOG_N:
+            return log2(n);
+        case EZS_BENCHMARK_O_N:
+            return n;
+        case EZS_BENCHMARK_O_N_LOG_N:
+            return n * log2(n);
+        case EZS_BENCHMARK_O_N_SQUARED:
+            return n * n;
+    }
+    return 1.0;
+}
+
+// 以最小二乘法把times拟合为c·f(n)，返回系数c，rms存入归一化均方根误差
+static double fit_complexity(const ezs_benchmark_complexity complexity, const double sizes[], const double times[],
+                             const size_t count, double *rms) {
+    double sum_ft = 0.0, sum_ff = 0.0, sum_t = 0.0;
+    for (size_t i = 0; i < count; i += 1) {
+        const double f = complexity_function(complexity, sizes[i]);
+        sum_ft += f * times[i];
+        sum_ff += f * f;
+        sum_t += times[i];
+    }
+    const double coefficient = sum_ff > 0.0 ? sum_ft / sum_ff : 0.0;
+    double sum_squared_error = 0.0;
+    for (size_t i = 0; i < count; i += 1) {
+        const double error = times[i] - coefficient * complexity_function(complexity, sizes[i]);
+        sum_squared_error += error * error;
+    }
+    const double mean = sum_t / (double) count;
+    *rms = mean > 0.0 ? sqrt(sum_squared_error / (double) count) / mean : 0.0;
+    return coefficient;
+}
+
+// 调用ezs_benchmark_sweep_function的参数
+typedef struct {
+    ezs_benchmark_sweep_function function;
+    void *context;
+    uint64_t n;
+} SweepCall;
+
+static void call_sweep_function(void *context) {
+    const SweepCall *call = context;
+    call->function(call->context, call->n);
+}
+
+ezs_benchmark_sweep_result ezs_benchmark_sweep(const char *name, const ezs_benchmark_sweep_function function,
+                                               void *context, const ezs_benchmark_sweep_range *range,
+                                               const ezs_benchmark_run_options *options) {
+    ezs_benchmark_sweep_result result = {};
+    if (0 == range->min_n || range->max_n < range->min_n || !(range->multiplier > 1.0)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Invalid sweep range of '%s'. Ignoring this call.\n", name);
+        return result;
+    }
+    const size_t point_name_size = strlen(name) + 24;
+    char *point_name = malloc(point_name_size);
+    if (nullptr == point_name) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate memory for the sweep of '%s'. Ignoring this call.\n", name);
+        return result;
+    }
+
+    double sizes[SWEEP_MAX_POINTS], times[SWEEP_MAX_POINTS];
+    uint64_t max_n = range->min_n;
+    for (uint64_t n = range->min_n; n <= range->max_n && result.point_count < SWEEP_MAX_POINTS;) {
+        if (nullptr != range->setup) {
+            range->setup(context, n);
+        }
+        SweepCall call = {.function = function, .context = context, .n = n};
+        snprintf(point_name, point_name_size, "%s/%" PRIu64, name, n);
+        const ezs_benchmark_run_result point = ezs_benchmark_run(point_name, call_sweep_function, &call, options);
+        sizes[result.point_count] = (double) n;
+        times[result.point_count] = point.mean_ns;
+        result.point_count += 1;
+        max_n = n;
+        // 倍数较小时保证规模至少增长1
+        const double next = ceil((double) n * range->multiplier);
+        if (next >= (double) UINT64_MAX) {
+            break;
+        }
+        n = (uint64_t) next > n ? (uint64_t) next : n + 1;
+    }
+    free(point_name);
+
+    result.rms = INFINITY;
+    for (size_t i = 0; i < COMPLEXITY_COUNT; i += 1) {
+        double rms = 0.0;
+        const double coefficient = fit_complexity((ezs_benchmark_complexity) i, sizes, times, result.point_count, &rms);
+        if (rms < result.rms) {
+            result.complexity = (ezs_benchmark_complexity) i;
+            result.coefficient_ns = coefficient;
+            result.rms = rms;
+        }
+    }
+    if (result.point_count < 3) {
+        fprintf(stderr, "[EZS BENCHMARK][WARN] "
+                "Sweep '%s' has only %zu sizes. The fitted complexity is unreliable.\n", name, result.point_count);
+    }
+    const SweepRecord record = {.min_n = range->min_n, .max_n = max_n, .result = result};
+    if (!i_ezs_benchmark_records_save(&g_sweeps, name, &record)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to record the sweep of '%s'.\n", name);
+    }
+    return result;
+}
+
+/*---------------------------清理局部宏---------------------------*/
+
+#undef RUN_COLUMN_COUNT
+#undef SWEEP_COLUMN_COUNT
+#undef COMPLEXITY_COUNT
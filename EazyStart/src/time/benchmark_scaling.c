@@ -0,0 +1,228 @@
+#include "EazyStart/time/benchmark_scaling.h"
+#include "EazyStart/time/benchmark.h"
+#include "benchmark_internal.h"
+#include "table.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// 线程数依次为1、2、4……2^31，最后加上不是2的幂的最大线程数
+#define SCALING_MAX_POINTS 33
+
+/*---------------------------EZS_BENCHMARK_SCALING 计时工具---------------------------*/
+
+// 获取硬件线程数，获取失败时返回1
+static unsigned hardware_threads(void) {
+#if defined(_WIN32) || defined(_WIN64)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (unsigned) info.dwNumberOfProcessors : 1;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned) count : 1;
+#endif
+}
+
+/*---------------------------EZS_BENCHMARK_SCALING 结果记录---------------------------*/
+
+typedef struct {
+    size_t point_count;
+    ezs_benchmark_scaling_point points[SCALING_MAX_POINTS];
+} ScalingRecord;
+
+static i_ezs_benchmark_records g_records = I_EZS_BENCHMARK_RECORDS_INIT(ScalingRecord);
+
+static const i_ezs_table_column SCALING_COLUMNS[] = {
+    {"Benchmark Name", 20, true},
+    {"Threads", 7, false},
+    {"Wall Time", 10, false},
+    {"Calls/s", 10, false},
+    {"Speedup", 8, false},
+    {"Efficiency", 10, false},
+};
+#define SCALING_COLUMN_COUNT (sizeof(SCALING_COLUMNS) / sizeof(SCALING_COLUMNS[0]))
+
+void i_ezs_benchmark_scaling_print_all(void) {
+    i_ezs_benchmark_records_lock();
+    if (0 == g_records.count) {
+        i_ezs_benchmark_records_unlock();
+        return;
+    }
+    i_ezs_table_print_header("Scaling Table", SCALING_COLUMNS, SCALING_COLUMN_COUNT);
+    for (size_t i = 0; i < g_records.count; i += 1) {
+        const ScalingRecord *record = i_ezs_benchmark_records_value(&g_records, i);
+        for (size_t j = 0; j < record->point_count; j += 1) {
+            const ezs_benchmark_scaling_point *point = &record->points[j];
+            char threads_buf[16], wall_buf[32], throughput_buf[32], speedup_buf[32], efficiency_buf[32];
+            snprintf(threads_buf, sizeof(threads_buf), "%u", point->threads);
+            i_ezs_table_format_nanoseconds(point->wall_ns, wall_buf, sizeof(wall_buf));
+            i_ezs_table_format_count(point->calls_per_second, throughput_buf, sizeof(throughput_buf));
+            snprintf(speedup_buf, sizeof(speedup_buf), "%.2fx", point->speedup);
+            snprintf(efficiency_buf, sizeof(efficiency_buf), "%.1f%%", point->efficiency * 100.0);
+            const char *const cells[SCALING_COLUMN_COUNT] = {
+                0 == j ? g_records.names[i] : "", threads_buf, wall_buf, throughput_buf, speedup_buf, efficiency_buf
+            };
+            i_ezs_table_print_row(SCALING_COLUMNS, SCALING_COLUMN_COUNT, cells);
+        }
+    }
+    i_ezs_table_print_footer(SCALING_COLUMNS, SCALING_COLUMN_COUNT);
+    printf("[EZS] Speedup = Calls/s / Calls/s of 1 thread, Efficiency = Speedup / Threads\n\n");
+    i_ezs_benchmark_records_unlock();
+}
+
+void i_ezs_benchmark_scaling_clear(void) {
+    i_ezs_benchmark_records_clear(&g_records);
+}
+
+/*---------------------------EZS_BENCHMARK_SCALING 运行器---------------------------*/
+
+/*
+ * 起跑屏障：工作线程就绪后自旋等待起跑信号，主线程等到所有线程就绪后记下开始时间并发出信号
+ * 自旋而不是阻塞在条件变量上，是为了让所有线程在起跑信号发出后几乎同时开始，
+ * 自旋时让出CPU，避免线程数等于核心数时尚未就绪的线程得不到调度
+ * 工作线程在就绪前创建好自己的计时分片，首次计时的初始化开销不计入墙钟时间
+ */
+
+// 一轮测试中所有线程共享的状态
+typedef struct {
+    ezs_benchmark_scaling_function function;
+    void *context;
+    uint64_t iterations;
+    unsigned thread_count;
+    ezs_benchmark_id id;
+    atomic_uint ready; // 已就绪的线程数
+    atomic_bool go; // 起跑信号
+} ScalingRound;
+
+typedef struct {
+    ScalingRound *round;
+    unsigned thread;
+    uint64_t end_ns; // 本线程完成的时间
+} ScalingWorker;
+
+static int run_scaling_worker(void *argument) {
+    ScalingWorker *worker = argument;
+    ScalingRound *round = worker->round;
+    i_ezs_benchmark_prepare_thread(round->id);
+    atomic_fetch_add_explicit(&round->ready, 1, memory_order_release);
+    while (!atomic_load_explicit(&round->go, memory_order_acquire)) {
+        thrd_yield();
+    }
+    ezs_benchmark_start_id(round->id);
+    for (uint64_t i = 0; i < round->iterations; i += 1) {
+        round->function(round->context, worker->thread, round->thread_count);
+    }
+    worker->end_ns = i_ezs_benchmark_now_ns();
+    ezs_benchmark_end_id(round->id);
+    return 0;
+}
+
+// 以thread_count个线程运行一轮，返回墙钟时间（纳秒）
+// 创建线程失败时返回0
+static uint64_t run_scaling_round(ScalingRound *round, ScalingWorker workers[], thrd_t threads[]) {
+    unsigned created = 0;
+    for (; created < round->thread_count; created += 1) {
+        workers[created] = (ScalingWorker){.round = round, .thread = created};
+        if (thrd_success != thrd_create(&threads[created], run_scaling_worker, &workers[created])) {
+            break;
+        }
+    }
+    while (atomic_load_explicit(&round->ready, memory_order_acquire) < created) {
+        thrd_yield();
+    }
+    const uint64_t start_ns = i_ezs_benchmark_now_ns();
+    atomic_store_explicit(&round->go, true, memory_order_release);
+    uint64_t end_ns = start_ns;
+    for (unsigned i = 0; i < created; i += 1) {
+        thrd_join(threads[i], nullptr);
+        end_ns = workers[i].end_ns > end_ns ? workers[i].end_ns : end_ns;
+    }
+    return created == round->thread_count ? end_ns - start_ns : 0;
+}
+
+ezs_benchmark_scaling_options ezs_benchmark_scaling_default_options(void) {
+    return (ezs_benchmark_scaling_options){
+        .max_threads = 0,
+        .iterations = 10000,
+    };
+}
+
+size_t ezs_benchmark_scaling(const char *name, const ezs_benchmark_scaling_function function, void *context,
+                             const ezs_benchmark_scaling_options *options,
+                             ezs_benchmark_scaling_point points[], const size_t capacity) {
+    const ezs_benchmark_scaling_options opts = nullptr != options ? *options : ezs_benchmark_scaling_default_options();
+    const unsigned max_threads = 0 != opts.max_threads ? opts.max_threads : hardware_threads();
+    ScalingWorker *workers = malloc(max_threads * sizeof(*workers));
+    thrd_t *threads = malloc(max_threads * sizeof(*threads));
+    const size_t entry_name_size = strlen(name) + 24;
+    char *entry_name = malloc(entry_name_size);
+    if (nullptr == workers || nullptr == threads || nullptr == entry_name) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate memory for the scaling benchmark '%s'. Ignoring this call.\n", name);
+        free(workers);
+        free(threads);
+        free(entry_name);
+        return 0;
+    }
+
+    ezs_benchmark_scaling_point results[SCALING_MAX_POINTS];
+    size_t count = 0;
+    for (unsigned thread_count = 1; thread_count <= max_threads;) {
+        snprintf(entry_name, entry_name_size, "%s/%u threads", name, thread_count);
+        ScalingRound round = {
+            .function = function,
+            .context = context,
+            .iterations = opts.iterations,
+            .thread_count = thread_count,
+            .id = ezs_benchmark_register(entry_name),
+        };
+        const uint64_t wall_ns = run_scaling_round(&round, workers, threads);
+        if (0 == wall_ns) {
+            fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                    "Failed to create %u threads for the scaling benchmark '%s'. Stopping here.\n",
+                    thread_count, name);
+            break;
+        }
+        ezs_benchmark_scaling_point *point = &results[count];
+        point->threads = thread_count;
+        point->wall_ns = (double) wall_ns;
+        point->calls_per_second = (double) opts.iterations * thread_count * 1e9 / (double) wall_ns;
+        point->speedup = results[0].calls_per_second > 0.0
+                             ? point->calls_per_second / results[0].calls_per_second
+                             : 0.0;
+        point->efficiency = point->speedup / thread_count;
+        count += 1;
+        // 翻倍，最后一轮使用最大线程数
+        if (thread_count == max_threads) {
+            break;
+        }
+        thread_count = thread_count > max_threads / 2 ? max_threads : thread_count * 2;
+    }
+    free(workers);
+    free(threads);
+    free(entry_name);
+
+    ScalingRecord record = {.point_count = count};
+    memcpy(record.points, results, count * sizeof(*results));
+    if (!i_ezs_benchmark_records_save(&g_records, name, &record)) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to record the scaling result of '%s'.\n", name);
+    }
+    if (nullptr != points) {
+        memcpy(points, results, (count < capacity ? count : capacity) * sizeof(*points));
+    }
+    return count;
+}
+
+/*---------------------------清理局部宏---------------------------*/
+
+#undef SCALING_MAX_POINTS
+#undef SCALING_COLUMN_COUNT
@@ -0,0 +1,220 @@
+#include "call_tree.h"
+#include "table.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void i_ezs_call_tree_init(i_ezs_call_tree *tree) {
+    *tree = (i_ezs_call_tree){.first_root = I_EZS_CALL_TREE_NONE};
+}
+
+// 获取parent的第一个子节点，parent为I_EZS_CALL_TREE_NONE时获取第一个顶层节点
+static uint32_t first_child(const i_ezs_call_tree *tree, const uint32_t parent) {
+    return I_EZS_CALL_TREE_NONE == parent ? tree->first_root : tree->nodes[parent].first_child;
+}
+
+uint32_t i_ezs_call_tree_find_child(const i_ezs_call_tree *tree, const uint32_t parent, const ezs_benchmark_id id) {
+    for (uint32_t node = first_child(tree, parent); I_EZS_CALL_TREE_NONE != node; node = tree->nodes[node].next_sibling) {
+        if (tree->nodes[node].id == id) {
+            return node;
+        }
+    }
+    return I_EZS_CALL_TREE_NONE;
+}
+
+uint32_t i_ezs_call_tree_add_child(i_ezs_call_tree *tree, const uint32_t parent, const ezs_benchmark_id id) {
+    const uint32_t existing = i_ezs_call_tree_find_child(tree, parent, id);
+    if (I_EZS_CALL_TREE_NONE != existing) {
+        return existing;
+    }
+    if (tree->count == tree->capacity) {
+        if (I_EZS_CALL_TREE_NONE / 2 <= tree->capacity) {
+            return I_EZS_CALL_TREE_NONE;
+        }
+        const uint32_t new_capacity = tree->capacity > 0 ? tree->capacity * 2 : 16;
+        i_ezs_call_node *nodes = realloc(tree->nodes, new_capacity * sizeof(*nodes));
+        if (nullptr == nodes) {
+            return I_EZS_CALL_TREE_NONE;
+        }
+        tree->nodes = nodes;
+        tree->capacity = new_capacity;
+    }
+    // 新节点插在兄弟链表的头部
+    const uint32_t node = tree->count;
+    tree->nodes[node] = (i_ezs_call_node){
+        .id = id,
+        .parent = parent,
+        .first_child = I_EZS_CALL_TREE_NONE,
+        .next_sibling = first_child(tree, parent),
+    };
+    if (I_EZS_CALL_TREE_NONE == parent) {
+        tree->first_root = node;
+    } else {
+        tree->nodes[parent].first_child = node;
+    }
+    tree->count += 1;
+    return node;
+}
+
+void i_ezs_call_tree_record(i_ezs_call_tree *tree, const uint32_t node, const uint64_t duration_ns) {
+    tree->nodes[node].count += 1;
+    tree->nodes[node].inclusive_ns += duration_ns;
+    const uint32_t parent = tree->nodes[node].parent;
+    if (I_EZS_CALL_TREE_NONE != parent) {
+        tree->nodes[parent].children_ns += duration_ns;
+    }
+}
+
+bool i_ezs_call_tree_merge(i_ezs_call_tree *dst, const i_ezs_call_tree *src) {
+    if (0 == src->count) {
+        return true;
+    }
+    // src中每个节点在dst中对应的节点
+    uint32_t *mapping = malloc(src->count * sizeof(*mapping));
+    if (nullptr == mapping) {
+        return false;
+    }
+    bool ok = true;
+    // 父节点总是先于子节点加入，因此按下标顺序处理时父节点的映射已经确定
+    for (uint32_t i = 0; i < src->count; i += 1) {
+        const i_ezs_call_node *node = &src->nodes[i];
+        const uint32_t parent = I_EZS_CALL_TREE_NONE == node->parent ? I_EZS_CALL_TREE_NONE : mapping[node->parent];
+        if (I_EZS_CALL_TREE_NONE != node->parent && I_EZS_CALL_TREE_NONE == parent) {
+            mapping[i] = I_EZS_CALL_TREE_NONE;
+            continue;
+        }
+        mapping[i] = i_ezs_call_tree_add_child(dst, parent, node->id);
+        if (I_EZS_CALL_TREE_NONE == mapping[i]) {
+            ok = false;
+            continue;
+        }
+        dst->nodes[mapping[i]].count += node->count;
+        dst->nodes[mapping[i]].inclusive_ns += node->inclusive_ns;
+        dst->nodes[mapping[i]].children_ns += node->children_ns;
+    }
+    free(mapping);
+    return ok;
+}
+
+// 节点及其所有祖先是否都应出现在报告中
+static bool is_visible(const i_ezs_call_tree *tree, uint32_t node, const i_ezs_call_tree_name_function name_of) {
+    for (; I_EZS_CALL_TREE_NONE != node; node = tree->nodes[node].parent) {
+        if (nullptr == name_of(tree->nodes[node].id)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool i_ezs_call_tree_has_nesting(const i_ezs_call_tree *tree, const i_ezs_call_tree_name_function name_of) {
+    for (uint32_t node = 0; node < tree->count; node += 1) {
+        if (I_EZS_CALL_TREE_NONE != tree->nodes[node].parent &&
+            tree->nodes[node].count > 0 && is_visible(tree, node, name_of)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static const i_ezs_table_column CALL_TREE_COLUMNS[] = {
+    {"Call Path", 32, true},
+    {"Count", 10, false},
+    {"Total", 10, false},
+    {"Self", 10, false},
+    {"Mean", 10, false},
+    {"Self Mean", 10, false},
+    {"Self %", 8, false},
+};
+#define CALL_TREE_COLUMN_COUNT (sizeof(CALL_TREE_COLUMNS) / sizeof(CALL_TREE_COLUMNS[0]))
+
+// 每一层缩进的空格数
+static constexpr int INDENT_WIDTH = 2;
+
+// qsort的比较函数无法携带上下文，排序前将当前的树存入此变量
+// 打印由调用者加锁，不会并发进行
+static const i_ezs_call_tree *g_sorting_tree = nullptr;
+
+// 按总耗时从大到小排序节点下标
+static int compare_inclusive_desc(const void *lhs, const void *rhs) {
+    const uint64_t a = g_sorting_tree->nodes[*(const uint32_t *) lhs].inclusive_ns;
+    const uint64_t b = g_sorting_tree->nodes[*(const uint32_t *) rhs].inclusive_ns;
+    return a < b ? 1 : a > b ? -1 : 0;
+}
+
+static void print_node(const i_ezs_call_tree *tree, const uint32_t node, const char *name, const int depth) {
+    const i_ezs_call_node *data = &tree->nodes[node];
+    const uint64_t self_ns = data->inclusive_ns > data->children_ns ? data->inclusive_ns - data->children_ns : 0;
+    char path_buf[256], count_buf[32], total_buf[32], self_buf[32], mean_buf[32], self_mean_buf[32],
+            self_percent_buf[32] = "N/A";
+    snprintf(path_buf, sizeof(path_buf), "%*s%s", depth * INDENT_WIDTH, "", name);
+    snprintf(count_buf, sizeof(count_buf), "%" PRIu64, data->count);
+    i_ezs_table_format_nanoseconds((double) data->inclusive_ns, total_buf, sizeof(total_buf));
+    i_ezs_table_format_nanoseconds((double) self_ns, self_buf, sizeof(self_buf));
+    const double count = data->count > 0 ? (double) data->count : 1.0;
+    i_ezs_table_format_nanoseconds((double) data->inclusive_ns / count, mean_buf, sizeof(mean_buf));
+    i_ezs_table_format_nanoseconds((double) self_ns / count, self_mean_buf, sizeof(self_mean_buf));
+    if (data->inclusive_ns > 0) {
+        snprintf(self_percent_buf, sizeof(self_percent_buf), "%.2f%%",
+                 (double) self_ns / (double) data->inclusive_ns * 100.0);
+    }
+    const char *const cells[CALL_TREE_COLUMN_COUNT] = {
+        path_buf, count_buf, total_buf, self_buf, mean_buf, self_mean_buf, self_percent_buf
+    };
+    i_ezs_table_print_row(CALL_TREE_COLUMNS, CALL_TREE_COLUMN_COUNT, cells);
+}
+
+// 打印parent的所有可见子树
+static void print_children(const i_ezs_call_tree *tree, const uint32_t parent, const int depth,
+                           const i_ezs_call_tree_name_function name_of) {
+    uint32_t child_count = 0;
+    for (uint32_t node = first_child(tree, parent); I_EZS_CALL_TREE_NONE != node; node = tree->nodes[node].next_sibling) {
+        child_count += 1;
+    }
+    if (0 == child_count) {
+        return;
+    }
+    uint32_t *children = malloc(child_count * sizeof(*children));
+    if (nullptr == children) {
+        fprintf(stderr, "[EZS BENCHMARK][ERROR] "
+                "Failed to allocate memory for printing the call tree.\n");
+        return;
+    }
+    uint32_t index = 0;
+    for (uint32_t node = first_child(tree, parent); I_EZS_CALL_TREE_NONE != node; node = tree->nodes[node].next_sibling) {
+        children[index] = node;
+        index += 1;
+    }
+    g_sorting_tree = tree;
+    qsort(children, child_count, sizeof(*children), compare_inclusive_desc);
+    for (uint32_t i = 0; i < child_count; i += 1) {
+        const char *name = name_of(tree->nodes[children[i]].id);
+        if (nullptr == name || 0 == tree->nodes[children[i]].count) {
+            continue;
+        }
+        print_node(tree, children[i], name, depth);
+        print_children(tree, children[i], depth + 1, name_of);
+    }
+    free(children);
+}
+
+void i_ezs_call_tree_print(const i_ezs_call_tree *tree, const i_ezs_call_tree_name_function name_of) {
+    i_ezs_table_print_header("Benchmark Call Tree", CALL_TREE_COLUMNS, CALL_TREE_COLUMN_COUNT);
+    print_children(tree, I_EZS_CALL_TREE_NONE, 0, name_of);
+    i_ezs_table_print_footer(CALL_TREE_COLUMNS, CALL_TREE_COLUMN_COUNT);
+    printf("[EZS] Self = Total - time spent in nested regions, Mean and Self Mean are per call\n\n");
+}
+
+void i_ezs_call_tree_reset(i_ezs_call_tree *tree) {
+    tree->count = 0;
+    tree->first_root = I_EZS_CALL_TREE_NONE;
+}
+
+void i_ezs_call_tree_drop(i_ezs_call_tree *tree) {
+    free(tree->nodes);
+    i_ezs_call_tree_init(tree);
+}
+
+/*---------------------------清理局部宏---------------------------*/
+
+#undef CALL_TREE_COLUMN_COUNT
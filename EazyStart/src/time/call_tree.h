@@ -0,0 +1,70 @@
+#pragma once
+
+#include "EazyStart/time/benchmark.h"
+#include <stdint.h>
+
+/*
+ * EZS内部使用的调用树，用于记录嵌套的benchmark区域
+ * 树中的每个节点对应一条调用路径（从顶层区域到该区域的句柄序列）
+ * 同一区域出现在不同的父区域下时，对应不同的节点
+ *
+ * 节点保存在数组中，以下标互相引用，父节点总是先于子节点加入
+ * 因此按下标顺序遍历时，父节点总是先于子节点被访问
+ *
+ * 本头文件为EZS内部使用，不属于公开接口
+ */
+
+// 表示不存在的节点，也用作顶层节点的父节点
+#define I_EZS_CALL_TREE_NONE UINT32_MAX
+
+typedef struct {
+    ezs_benchmark_id id;
+    uint32_t parent;
+    uint32_t first_child;
+    uint32_t next_sibling;
+    uint64_t count;
+    uint64_t inclusive_ns; // 包含子区域的总耗时
+    uint64_t children_ns; // 直接子区域的总耗时，self = inclusive - children
+} i_ezs_call_node;
+
+typedef struct {
+    i_ezs_call_node *nodes;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t first_root; // 第一个顶层节点
+} i_ezs_call_tree;
+
+// 获取名称的回调，返回nullptr表示该句柄不应出现在报告中
+typedef const char *(*i_ezs_call_tree_name_function)(ezs_benchmark_id id);
+
+// 初始化一棵空的调用树
+void i_ezs_call_tree_init(i_ezs_call_tree *tree) __attribute__((nonnull(1)));
+
+// 查找parent下句柄为id的子节点，不存在时返回I_EZS_CALL_TREE_NONE
+// parent为I_EZS_CALL_TREE_NONE时查找顶层节点
+uint32_t i_ezs_call_tree_find_child(const i_ezs_call_tree *tree, uint32_t parent, ezs_benchmark_id id) __attribute__((nonnull(1)));
+
+// 查找parent下句柄为id的子节点，不存在时创建
+// 分配失败时返回I_EZS_CALL_TREE_NONE
+uint32_t i_ezs_call_tree_add_child(i_ezs_call_tree *tree, uint32_t parent, ezs_benchmark_id id) __attribute__((nonnull(1)));
+
+// 记录节点node的一次耗时，并计入其父节点的子区域耗时
+void i_ezs_call_tree_record(i_ezs_call_tree *tree, uint32_t node, uint64_t duration_ns) __attribute__((nonnull(1)));
+
+// 按调用路径将src的数据累加到dst
+// 返回false表示分配失败，dst可能只合并了一部分
+bool i_ezs_call_tree_merge(i_ezs_call_tree *dst, const i_ezs_call_tree *src) __attribute__((nonnull(1, 2)));
+
+// 是否存在嵌套的区域，即是否有节点拥有父节点
+// name_of返回nullptr的节点及其子树不计入
+bool i_ezs_call_tree_has_nesting(const i_ezs_call_tree *tree, i_ezs_call_tree_name_function name_of) __attribute__((nonnull(1, 2)));
+
+// 以表格形式打印调用树，同级节点按总耗时从大到小排列
+// name_of返回nullptr的节点及其子树不打印
+void i_ezs_call_tree_print(const i_ezs_call_tree *tree, i_ezs_call_tree_name_function name_of) __attribute__((nonnull(1, 2)));
+
+// 清空所有节点，保留已分配的内存
+void i_ezs_call_tree_reset(i_ezs_call_tree *tree) __attribute__((nonnull(1)));
+
+// 释放调用树占用的内存
+void i_ezs_call_tree_drop(i_ezs_call_tree *tree) __attribute__((nonnull(1)));
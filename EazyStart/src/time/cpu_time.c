@@ -0,0 +1,50 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L // NOLINT(*-reserved-identifier)
+#endif
+
+#include "cpu_time.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>
+
+// FILETIME的单位为100ns
+static uint64_t filetime_to_nanoseconds(const FILETIME ft) {
+    return (((uint64_t) ft.dwHighDateTime << 32) | ft.dwLowDateTime) * 100ULL;
+}
+
+bool i_ezs_cpu_time_read(i_ezs_cpu_time *time) {
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+        return false;
+    }
+    time->thread_ns = filetime_to_nanoseconds(kernel) + filetime_to_nanoseconds(user);
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return false;
+    }
+    time->process_ns = filetime_to_nanoseconds(kernel) + filetime_to_nanoseconds(user);
+    return true;
+}
+
+#elif defined(__unix__) || defined(__APPLE__)
+#include "benchmark_internal.h"
+#include <time.h>
+
+bool i_ezs_cpu_time_read(i_ezs_cpu_time *time) {
+    struct timespec thread_ts, process_ts;
+    if (0 != clock_gettime(CLOCK_THREAD_CPUTIME_ID, &thread_ts) ||
+        0 != clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &process_ts)) {
+        return false;
+    }
+    time->thread_ns = i_ezs_benchmark_timespec_to_ns(thread_ts);
+    time->process_ns = i_ezs_benchmark_timespec_to_ns(process_ts);
+    return true;
+}
+
+#else
+
+bool i_ezs_cpu_time_read(i_ezs_cpu_time *time) {
+    (void) time;
+    return false;
+}
+
+#endif
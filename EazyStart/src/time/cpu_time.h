@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * EZS内部使用的CPU时间读数
+ *
+ * 线程CPU时间只统计调用线程，进程CPU时间统计进程中的所有线程，两者都包含用户态与内核态
+ * POSIX上使用CLOCK_THREAD_CPUTIME_ID与CLOCK_PROCESS_CPUTIME_ID，Windows上使用GetThreadTimes与GetProcessTimes（精度为100ns）
+ * 在其他平台上，读取总是失败
+ *
+ * 本头文件为EZS内部使用，不属于公开接口
+ */
+
+typedef struct {
+    uint64_t thread_ns; // 本线程的CPU时间
+    uint64_t process_ns; // 本进程的CPU时间
+} i_ezs_cpu_time;
+
+// 读取当前线程与进程的CPU时间
+// 返回false表示读取失败或当前平台不支持
+bool i_ezs_cpu_time_read(i_ezs_cpu_time *time) __attribute__((nonnull(1)));
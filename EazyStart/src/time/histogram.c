@@ -0,0 +1,163 @@
+#include "histogram.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*---------------------------直方图的分桶参数---------------------------*/
+
+// 可记录的最大值为2^HIGHEST_MAGNITUDE - 1
+static constexpr int HIGHEST_MAGNITUDE = 40;
+
+// 每个桶的子桶数为2^SUB_BUCKET_COUNT_MAGNITUDE，即 >= 2 * 10^digits 的最小的2的幂
+static constexpr int SUB_BUCKET_COUNT_MAGNITUDE =
+        I_EZS_HISTOGRAM_SIGNIFICANT_DIGITS == 1 ? 5 : I_EZS_HISTOGRAM_SIGNIFICANT_DIGITS == 2 ? 8 : 11;
+static constexpr int SUB_BUCKET_HALF_COUNT_MAGNITUDE = SUB_BUCKET_COUNT_MAGNITUDE - 1;
+static constexpr uint64_t SUB_BUCKET_COUNT = UINT64_C(1) << SUB_BUCKET_COUNT_MAGNITUDE;
+static constexpr uint64_t SUB_BUCKET_HALF_COUNT = SUB_BUCKET_COUNT / 2;
+static constexpr uint64_t SUB_BUCKET_MASK = SUB_BUCKET_COUNT - 1;
+
+// 第0个桶覆盖[0, SUB_BUCKET_COUNT)，之后每个桶的范围翻倍
+static constexpr int BUCKET_COUNT = HIGHEST_MAGNITUDE - SUB_BUCKET_COUNT_MAGNITUDE + 1;
+static constexpr size_t COUNTS_LENGTH = (size_t) (BUCKET_COUNT + 1) * SUB_BUCKET_HALF_COUNT;
+static constexpr uint64_t HIGHEST_TRACKABLE_VALUE = (UINT64_C(1) << HIGHEST_MAGNITUDE) - 1;
+
+/*---------------------------直方图的下标计算---------------------------*/
+
+static int bucket_index_of(const uint64_t value) {
+    const int pow2ceiling = 64 - __builtin_clzll(value | SUB_BUCKET_MASK);
+    return pow2ceiling - (SUB_BUCKET_HALF_COUNT_MAGNITUDE + 1);
+}
+
+static size_t counts_index_of(const uint64_t value) {
+    const int bucket_index = bucket_index_of(value);
+    const uint64_t sub_bucket_index = value >> bucket_index;
+    return ((size_t) (bucket_index + 1) << SUB_BUCKET_HALF_COUNT_MAGNITUDE) +
+           (size_t) (sub_bucket_index - SUB_BUCKET_HALF_COUNT);
+}
+
+// 下标对应的桶内的最大等价值
+static uint64_t highest_equivalent_value_of(const size_t index) {
+    int bucket_index = (int) (index >> SUB_BUCKET_HALF_COUNT_MAGNITUDE) - 1;
+    uint64_t sub_bucket_index = (index & (SUB_BUCKET_HALF_COUNT - 1)) + SUB_BUCKET_HALF_COUNT;
+    if (bucket_index < 0) {
+        sub_bucket_index -= SUB_BUCKET_HALF_COUNT;
+        bucket_index = 0;
+    }
+    return (sub_bucket_index << bucket_index) + (UINT64_C(1) << bucket_index) - 1;
+}
+
+// 下标对应的桶的宽度
+static uint64_t bucket_size_of(const size_t index) {
+    const int bucket_index = (int) (index >> SUB_BUCKET_HALF_COUNT_MAGNITUDE) - 1;
+    return UINT64_C(1) << (bucket_index < 0 ? 0 : bucket_index);
+}
+
+static bool ensure_counts(i_ezs_histogram *histogram) {
+    if (nullptr == histogram->counts) {
+        histogram->counts = calloc(COUNTS_LENGTH, sizeof(*histogram->counts));
+    }
+    return nullptr != histogram->counts;
+}
+
+/*---------------------------直方图的操作---------------------------*/
+
+bool i_ezs_histogram_record(i_ezs_histogram *histogram, const uint64_t value) {
+    if (!ensure_counts(histogram)) {
+        return false;
+    }
+    const uint64_t clamped = value < HIGHEST_TRACKABLE_VALUE ? value : HIGHEST_TRACKABLE_VALUE;
+    histogram->counts[counts_index_of(clamped)] += 1;
+    histogram->total += 1;
+    return true;
+}
+
+bool i_ezs_histogram_merge(i_ezs_histogram *dst, const i_ezs_histogram *src) {
+    if (0 == src->total) {
+        return true;
+    }
+    if (!ensure_counts(dst)) {
+        return false;
+    }
+    for (size_t i = 0; i < COUNTS_LENGTH; i += 1) {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->total += src->total;
+    return true;
+}
+
+bool i_ezs_histogram_merge_snapshot(i_ezs_histogram *dst, const i_ezs_histogram *src) {
+    if (nullptr == src->counts || 0 == src->total) {
+        return true;
+    }
+    if (!ensure_counts(dst)) {
+        return false;
+    }
+    // 以volatile读取，保证每个计数只读取一次
+    const volatile uint64_t *counts = src->counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < COUNTS_LENGTH; i += 1) {
+        const uint64_t count = counts[i];
+        dst->counts[i] += count;
+        total += count;
+    }
+    dst->total += total;
+    return true;
+}
+
+uint64_t i_ezs_histogram_value_at_quantile(const i_ezs_histogram *histogram, const double quantile) {
+    if (0 == histogram->total) {
+        return 0;
+    }
+    const double clamped = quantile < 0.0 ? 0.0 : quantile > 1.0 ? 1.0 : quantile;
+    uint64_t target = (uint64_t) ceil(clamped * (double) histogram->total);
+    if (target < 1) {
+        target = 1;
+    }
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < COUNTS_LENGTH; i += 1) {
+        cumulative += histogram->counts[i];
+        if (cumulative >= target) {
+            return highest_equivalent_value_of(i);
+        }
+    }
+    return HIGHEST_TRACKABLE_VALUE;
+}
+
+i_ezs_histogram_bucket *i_ezs_histogram_buckets(const i_ezs_histogram *histogram, size_t *count) {
+    *count = 0;
+    if (0 == histogram->total) {
+        return nullptr;
+    }
+    size_t non_empty = 0;
+    for (size_t i = 0; i < COUNTS_LENGTH; i += 1) {
+        non_empty += 0 != histogram->counts[i] ? 1 : 0;
+    }
+    i_ezs_histogram_bucket *buckets = malloc(non_empty * sizeof(*buckets));
+    if (nullptr == buckets) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < COUNTS_LENGTH; i += 1) {
+        if (0 != histogram->counts[i]) {
+            const uint64_t highest = highest_equivalent_value_of(i);
+            buckets[*count] = (i_ezs_histogram_bucket){
+                .value = highest - (bucket_size_of(i) - 1) / 2,
+                .count = histogram->counts[i],
+            };
+            *count += 1;
+        }
+    }
+    return buckets;
+}
+
+void i_ezs_histogram_reset(i_ezs_histogram *histogram) {
+    if (nullptr != histogram->counts) {
+        memset(histogram->counts, 0, COUNTS_LENGTH * sizeof(*histogram->counts));
+    }
+    histogram->total = 0;
+}
+
+void i_ezs_histogram_drop(i_ezs_histogram *histogram) {
+    free(histogram->counts);
+    histogram->counts = nullptr;
+    histogram->total = 0;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * EZS内部使用的对数-线性分桶直方图（HDR Histogram风格）
+ * 用于在固定内存下记录耗时分布并查询分位数
+ *
+ * 数值单位为纳秒，可记录的范围为[0, 2^40)纳秒（约18分钟），超出范围的值计入最高的桶
+ * 每个桶内的相对误差由I_EZS_HISTOGRAM_SIGNIFICANT_DIGITS决定
+ * 记录操作为O(1)，分桶数组在首次记录时分配
+ *
+ * 本头文件为EZS内部使用，不属于公开接口
+ */
+
+// 直方图的有效数字位数，取值范围[1, 3]
+// 位数越多，分位数越精确，但每个直方图占用的内存也越多（2位约34KB，3位约248KB）
+#ifndef EZS_BENCHMARK_HISTOGRAM_SIGNIFICANT_DIGITS
+#define EZS_BENCHMARK_HISTOGRAM_SIGNIFICANT_DIGITS 2
+#endif
+#if EZS_BENCHMARK_HISTOGRAM_SIGNIFICANT_DIGITS < 1 || EZS_BENCHMARK_HISTOGRAM_SIGNIFICANT_DIGITS > 3
+#error "EZS_BENCHMARK_HISTOGRAM_SIGNIFICANT_DIGITS must be in range [1, 3]."
+#endif
+#define I_EZS_HISTOGRAM_SIGNIFICANT_DIGITS EZS_BENCHMARK_HISTOGRAM_SIGNIFICANT_DIGITS
+
+typedef struct {
+    uint64_t *counts; // 惰性分配，nullptr表示尚未记录任何值
+    uint64_t total;
+} i_ezs_histogram;
+
+// 记录一个值
+// 返回false表示分桶数组分配失败，该值未被记录
+bool i_ezs_histogram_record(i_ezs_histogram *histogram, uint64_t value) __attribute__((nonnull(1)));
+
+// 将src的计数累加到dst
+// 返回false表示分桶数组分配失败
+bool i_ezs_histogram_merge(i_ezs_histogram *dst, const i_ezs_histogram *src) __attribute__((nonnull(1, 2)));
+
+// 将src的计数累加到dst，src的分桶数组可能正在被其他线程记录
+// 每个计数只读取一次，dst的总数按实际累加的计数计算，因此结果本身是一致的
+// 返回false表示分桶数组分配失败
+bool i_ezs_histogram_merge_snapshot(i_ezs_histogram *dst, const i_ezs_histogram *src) __attribute__((nonnull(1, 2)));
+
+// 查询分位数，quantile取值范围[0, 1]
+// 返回的是该分位数所在桶的最大等价值，直方图为空时返回0
+uint64_t i_ezs_histogram_value_at_quantile(const i_ezs_histogram *histogram, double quantile) __attribute__((nonnull(1)));
+
+// 一个非空的桶
+typedef struct {
+    uint64_t value; // 桶的中间值
+    uint64_t count;
+} i_ezs_histogram_bucket;
+
+// 取出所有非空的桶，按值从小到大排列，数量存入count
+// 返回的数组由调用者free，直方图为空或分配失败时返回nullptr
+i_ezs_histogram_bucket *i_ezs_histogram_buckets(const i_ezs_histogram *histogram, size_t *count) __attribute__((nonnull(1, 2)));
+
+// 清空计数，保留已分配的内存
+void i_ezs_histogram_reset(i_ezs_histogram *histogram) __attribute__((nonnull(1)));
+
+// 释放直方图占用的内存
+void i_ezs_histogram_drop(i_ezs_histogram *histogram) __attribute__((nonnull(1)));
@@ -0,0 +1,102 @@
+#include "perf_counter.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// 各种类对应的perf事件
+static const uint64_t PERF_CONFIGS[I_EZS_PERF_COUNTER_KINDS] = {
+    [I_EZS_PERF_CYCLES] = PERF_COUNT_HW_CPU_CYCLES,
+    [I_EZS_PERF_INSTRUCTIONS] = PERF_COUNT_HW_INSTRUCTIONS,
+    [I_EZS_PERF_CACHE_REFERENCES] = PERF_COUNT_HW_CACHE_REFERENCES,
+    [I_EZS_PERF_CACHE_MISSES] = PERF_COUNT_HW_CACHE_MISSES,
+    [I_EZS_PERF_BRANCH_MISSES] = PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+// 打开一个计数器，group_fd为-1时作为组长
+static int open_counter(const int kind, const int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_CONFIGS[kind];
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // 只统计用户态，这样在perf_event_paranoid为2时也能打开
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0UL);
+}
+
+bool i_ezs_perf_group_open(i_ezs_perf_group *group, const unsigned events) {
+    *group = (i_ezs_perf_group){};
+    for (int kind = 0; kind < I_EZS_PERF_COUNTER_KINDS; kind += 1) {
+        if (0 == (events & (1u << kind))) {
+            continue;
+        }
+        const int fd = open_counter(kind, 0 == group->count ? -1 : group->fds[0]);
+        if (fd < 0) {
+            continue;
+        }
+        group->fds[group->count] = fd;
+        group->kinds[group->count] = kind;
+        group->count += 1;
+        group->events |= 1u << kind;
+    }
+    return group->count > 0;
+}
+
+bool i_ezs_perf_group_read(const i_ezs_perf_group *group, uint64_t values[I_EZS_PERF_COUNTER_KINDS]) {
+    // PERF_FORMAT_GROUP的布局：nr, time_enabled, time_running, value[nr]
+    uint64_t buffer[3 + I_EZS_PERF_COUNTER_KINDS];
+    memset(values, 0, I_EZS_PERF_COUNTER_KINDS * sizeof(values[0]));
+    if (0 == group->count) {
+        return false;
+    }
+    const ssize_t size = read(group->fds[0], buffer, sizeof(buffer));
+    if (size < (ssize_t) (3 * sizeof(uint64_t)) || buffer[0] != (uint64_t) group->count) {
+        return false;
+    }
+    const uint64_t enabled = buffer[1];
+    const uint64_t running = buffer[2];
+    for (int i = 0; i < group->count; i += 1) {
+        uint64_t value = buffer[3 + i];
+        // 计数器被分时复用时，按启用时间与实际运行时间之比估算
+        if (running > 0 && running < enabled) {
+            value = (uint64_t) ((double) value * (double) enabled / (double) running);
+        }
+        values[group->kinds[i]] = value;
+    }
+    return true;
+}
+
+void i_ezs_perf_group_close(i_ezs_perf_group *group) {
+    // 先关闭组员，最后关闭组长
+    for (int i = group->count - 1; i >= 0; i -= 1) {
+        close(group->fds[i]);
+    }
+    *group = (i_ezs_perf_group){};
+}
+
+#else
+
+bool i_ezs_perf_group_open(i_ezs_perf_group *group, const unsigned events) {
+    (void) events;
+    *group = (i_ezs_perf_group){};
+    return false;
+}
+
+bool i_ezs_perf_group_read(const i_ezs_perf_group *group, uint64_t values[I_EZS_PERF_COUNTER_KINDS]) {
+    (void) group;
+    for (int i = 0; i < I_EZS_PERF_COUNTER_KINDS; i += 1) {
+        values[i] = 0;
+    }
+    return false;
+}
+
+void i_ezs_perf_group_close(i_ezs_perf_group *group) {
+    *group = (i_ezs_perf_group){};
+}
+
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * EZS内部使用的硬件性能计数器（Linux perf_event_open）
+ *
+ * 一组计数器只统计打开它的线程，因此每个线程需要各自打开一组
+ * 组内的计数器通过一次read读取，计数器被内核分时复用时按实际运行时间比例缩放
+ * 在非Linux平台上，打开总是失败
+ *
+ * 本头文件为EZS内部使用，不属于公开接口
+ */
+
+// 计数器的种类，与ezs_benchmark_perf_event的位一一对应
+enum {
+    I_EZS_PERF_CYCLES,
+    I_EZS_PERF_INSTRUCTIONS,
+    I_EZS_PERF_CACHE_REFERENCES,
+    I_EZS_PERF_CACHE_MISSES,
+    I_EZS_PERF_BRANCH_MISSES,
+    I_EZS_PERF_COUNTER_KINDS,
+};
+
+typedef struct {
+    int fds[I_EZS_PERF_COUNTER_KINDS]; // 组内各计数器的文件描述符，按打开顺序排列
+    int kinds[I_EZS_PERF_COUNTER_KINDS]; // 组内各计数器的种类
+    int count; // 成功打开的计数器数量，0表示未打开
+    unsigned events; // 成功打开的计数器种类的位掩码
+} i_ezs_perf_group;
+
+// 在当前线程打开events中的计数器，不支持的计数器会被跳过
+// group的events为实际打开的种类，全部失败时返回false
+bool i_ezs_perf_group_open(i_ezs_perf_group *group, unsigned events) __attribute__((nonnull(1)));
+
+// 读取组内所有计数器的当前值，以种类为下标存入values，未打开的种类置0
+// 返回false表示读取失败
+bool i_ezs_perf_group_read(const i_ezs_perf_group *group, uint64_t values[I_EZS_PERF_COUNTER_KINDS]) __attribute__((nonnull(1, 2)));
+
+// 关闭组内所有计数器
+void i_ezs_perf_group_close(i_ezs_perf_group *group) __attribute__((nonnull(1)));
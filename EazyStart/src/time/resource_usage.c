@@ -0,0 +1,54 @@
+#if defined(__linux__)
+#define _GNU_SOURCE // NOLINT(*-reserved-identifier)
+#endif
+
+#include "resource_usage.h"
+
+#if defined(__linux__)
+#include <sys/resource.h>
+
+static uint64_t timeval_to_nanoseconds(const struct timeval tv) {
+    return (uint64_t) tv.tv_sec * 1000000000ULL + (uint64_t) tv.tv_usec * 1000ULL;
+}
+
+bool i_ezs_resource_usage_read(i_ezs_resource_usage *usage) {
+    struct rusage rusage;
+    if (0 != getrusage(RUSAGE_THREAD, &rusage)) {
+        return false;
+    }
+    *usage = (i_ezs_resource_usage){
+        .minor_faults = (uint64_t) rusage.ru_minflt,
+        .major_faults = (uint64_t) rusage.ru_majflt,
+        .voluntary_switches = (uint64_t) rusage.ru_nvcsw,
+        .involuntary_switches = (uint64_t) rusage.ru_nivcsw,
+        .user_ns = timeval_to_nanoseconds(rusage.ru_utime),
+        .system_ns = timeval_to_nanoseconds(rusage.ru_stime),
+    };
+    return true;
+}
+
+#else
+
+bool i_ezs_resource_usage_read(i_ezs_resource_usage *usage) {
+    (void) usage;
+    return false;
+}
+
+#endif
+
+bool i_ezs_resource_usage_accumulate(i_ezs_resource_usage *sum, const i_ezs_resource_usage *start,
+                                     const i_ezs_resource_usage *end) {
+    if (end->minor_faults < start->minor_faults || end->major_faults < start->major_faults ||
+        end->voluntary_switches < start->voluntary_switches ||
+        end->involuntary_switches < start->involuntary_switches ||
+        end->user_ns < start->user_ns || end->system_ns < start->system_ns) {
+        return false;
+    }
+    sum->minor_faults += end->minor_faults - start->minor_faults;
+    sum->major_faults += end->major_faults - start->major_faults;
+    sum->voluntary_switches += end->voluntary_switches - start->voluntary_switches;
+    sum->involuntary_switches += end->involuntary_switches - start->involuntary_switches;
+    sum->user_ns += end->user_ns - start->user_ns;
+    sum->system_ns += end->system_ns - start->system_ns;
+    return true;
+}
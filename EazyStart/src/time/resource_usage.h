@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * EZS内部使用的线程资源使用量（Linux getrusage(RUSAGE_THREAD)）
+ *
+ * 读数只统计调用线程，缺页与上下文切换为累计次数，CPU时间的精度为微秒
+ * 在非Linux平台上，读取总是失败
+ *
+ * 本头文件为EZS内部使用，不属于公开接口
+ */
+
+typedef struct {
+    uint64_t minor_faults; // 不需要读取磁盘的缺页
+    uint64_t major_faults; // 需要读取磁盘的缺页
+    uint64_t voluntary_switches; // 主动让出CPU（如等待I/O或锁）
+    uint64_t involuntary_switches; // 被调度器抢占
+    uint64_t user_ns; // 用户态CPU时间
+    uint64_t system_ns; // 内核态CPU时间
+} i_ezs_resource_usage;
+
+// 读取当前线程的资源使用量
+// 返回false表示读取失败或当前平台不支持
+bool i_ezs_resource_usage_read(i_ezs_resource_usage *usage) __attribute__((nonnull(1)));
+
+// 将end - start累加到sum
+// 任一读数小于start时视为读数无效，不做累加并返回false
+bool i_ezs_resource_usage_accumulate(i_ezs_resource_usage *sum, const i_ezs_resource_usage *start,
+                                     const i_ezs_resource_usage *end) __attribute__((nonnull(1, 2, 3)));
@@ -0,0 +1,124 @@
+#include "table.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// 第index列在横线中占用的宽度
+static int cell_width(const i_ezs_table_column columns[], const size_t column_count, const size_t index) {
+    // 首列左侧与末列右侧没有空格
+    return columns[index].width + (0 == index || column_count - 1 == index ? 1 : 2);
+}
+
+// 打印一条横线，left/middle/right为横线两端与列分隔处的字符
+static void print_rule(const i_ezs_table_column columns[], const size_t column_count,
+                       const char *left, const char *middle, const char *right) {
+    fputs(left, stdout);
+    for (size_t i = 0; i < column_count; i += 1) {
+        for (int j = 0; j < cell_width(columns, column_count, i); j += 1) {
+            fputs("─", stdout);
+        }
+        fputs(column_count - 1 == i ? right : middle, stdout);
+    }
+    fputs("\n", stdout);
+}
+
+// 打印第index列的单元格，首列之前的"│"与行末的换行符由调用者负责
+static void print_cell(const i_ezs_table_column columns[], const size_t column_count,
+                       const size_t index, const char *text) {
+    if (0 != index) {
+        fputs(" ", stdout);
+    }
+    if (columns[index].left_aligned) {
+        printf("%-*s", columns[index].width, text);
+    } else {
+        printf("%*s", columns[index].width, text);
+    }
+    fputs(column_count - 1 == index ? "│" : " │", stdout);
+}
+
+void i_ezs_table_print_header(const char *title, const i_ezs_table_column columns[], const size_t column_count) {
+    int inner_width = (int) column_count - 1;
+    for (size_t i = 0; i < column_count; i += 1) {
+        inner_width += cell_width(columns, column_count, i);
+    }
+    const int title_width = (int) strlen(title);
+    const int left_padding = (inner_width - title_width) / 2;
+    const int right_padding = inner_width - title_width - left_padding;
+
+    printf("\n");
+    printf("┌");
+    for (int i = 0; i < inner_width; i += 1) {
+        fputs("─", stdout);
+    }
+    printf("┐\n");
+    printf("│%*s%s%*s│\n", left_padding, "", title, right_padding, "");
+    print_rule(columns, column_count, "├", "┬", "┤");
+    fputs("│", stdout);
+    for (size_t i = 0; i < column_count; i += 1) {
+        print_cell(columns, column_count, i, columns[i].title);
+    }
+    fputs("\n", stdout);
+    print_rule(columns, column_count, "├", "┼", "┤");
+}
+
+void i_ezs_table_print_row(const i_ezs_table_column columns[], const size_t column_count,
+                           const char *const cells[]) {
+    fputs("│", stdout);
+    for (size_t i = 0; i < column_count; i += 1) {
+        print_cell(columns, column_count, i, cells[i]);
+    }
+    fputs("\n", stdout);
+}
+
+void i_ezs_table_print_footer(const i_ezs_table_column columns[], const size_t column_count) {
+    print_rule(columns, column_count, "└", "┴", "┘");
+    printf("\n");
+}
+
+void i_ezs_table_format_nanoseconds(const double nanoseconds, char *buf, const size_t size) {
+    if (nanoseconds < 1e3) {
+        snprintf(buf, size, nanoseconds == floor(nanoseconds) ? "%.0fns" : "%.2fns", nanoseconds);
+    } else if (nanoseconds < 1e6) {
+        snprintf(buf, size, "%.2fus", nanoseconds / 1e3);
+    } else if (nanoseconds < 1e9) {
+        snprintf(buf, size, "%.2fms", nanoseconds / 1e6);
+    } else {
+        snprintf(buf, size, "%.2fs", nanoseconds / 1e9);
+    }
+}
+
+void i_ezs_table_format_count(const double count, char *buf, const size_t size) {
+    if (count < 1e3) {
+        snprintf(buf, size, "%.1f", count);
+    } else if (count < 1e6) {
+        snprintf(buf, size, "%.2fk", count / 1e3);
+    } else if (count < 1e9) {
+        snprintf(buf, size, "%.2fM", count / 1e6);
+    } else {
+        snprintf(buf, size, "%.2fG", count / 1e9);
+    }
+}
+
+void i_ezs_table_format_bytes(const double bytes, char *buf, const size_t size) {
+    if (bytes < 1e3) {
+        snprintf(buf, size, "%.0fB", bytes);
+    } else if (bytes < 1e6) {
+        snprintf(buf, size, "%.2fKB", bytes / 1e3);
+    } else if (bytes < 1e9) {
+        snprintf(buf, size, "%.2fMB", bytes / 1e6);
+    } else {
+        snprintf(buf, size, "%.2fGB", bytes / 1e9);
+    }
+}
+
+void i_ezs_table_format_bandwidth(const double bytes_per_second, char *buf, const size_t size) {
+    if (bytes_per_second < 1e3) {
+        snprintf(buf, size, "%.2fB/s", bytes_per_second);
+    } else if (bytes_per_second < 1e6) {
+        snprintf(buf, size, "%.2fKB/s", bytes_per_second / 1e3);
+    } else if (bytes_per_second < 1e9) {
+        snprintf(buf, size, "%.2fMB/s", bytes_per_second / 1e6);
+    } else {
+        snprintf(buf, size, "%.2fGB/s", bytes_per_second / 1e9);
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+
+/*
+ * EZS内部使用的报告表格绘制工具
+ * 表格的布局由列定义决定，首列左侧与末列右侧不留空格
+ *
+ * 本头文件为EZS内部使用，不属于公开接口
+ */
+
+typedef struct {
+    const char *title;
+    int width; // 单元格内容的宽度，不含两侧空格
+    bool left_aligned;
+} i_ezs_table_column;
+
+// 打印表头：标题行与列名行
+void i_ezs_table_print_header(const char *title, const i_ezs_table_column columns[], size_t column_count);
+
+// 打印一行数据，cells的数量与columns一致
+void i_ezs_table_print_row(const i_ezs_table_column columns[], size_t column_count, const char *const cells[]);
+
+// 打印表尾
+void i_ezs_table_print_footer(const i_ezs_table_column columns[], size_t column_count);
+
+// 以紧凑形式格式化纳秒数，保留两位小数，例如"1.25us"
+// 小于1us的整数纳秒数不保留小数，例如"107ns"
+void i_ezs_table_format_nanoseconds(double nanoseconds, char *buf, size_t size);
+
+// 以紧凑形式格式化计数，保留两位小数，例如"1.25k"、"3.40M"
+// 小于1000的数保留一位小数，例如"12.5"
+void i_ezs_table_format_count(double count, char *buf, size_t size);
+
+// 以紧凑形式格式化字节数，例如"512B"、"1.25MB"
+// 单位按10的幂递进，即1KB = 1000B
+void i_ezs_table_format_bytes(double bytes, char *buf, size_t size);
+
+// 以紧凑形式格式化每秒字节数，保留两位小数，例如"512.00B/s"、"1.25GB/s"
+// 单位按10的幂递进，即1KB = 1000B
+void i_ezs_table_format_bandwidth(double bytes_per_second, char *buf, size_t size);
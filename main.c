@@ -122,6 +122,13 @@ void demo_random(void) {
     printf("本次随机序列使用的种子是: 0x%016" PRIx64 "\n", current_seed);
 }
 
+// 微基准测试的被测函数：生成一个随机布尔值
+// ezs_do_not_optimize阻止编译器把未使用的结果连同调用一起优化掉
+static void random_bool_op(void *context) {
+    (void) context;
+    ezs_do_not_optimize(ezs_random_bool());
+}
+
 /**
  * @brief 演示代码性能基准测试工具
  */
@@ -142,14 +149,32 @@ void demo_benchmark(void) {
     }
 
     // 演示2：测试一个高频、短耗时的任务
-    puts("正在执行一百万次随机布尔值生成...");
-    ezs_benchmark_start("1M Random Bools");
-    volatile bool temp = false; // 使用volatile防止编译器优化掉调用
-    for (int i = 0; i < 1000 * 1000; ++i) {
-        temp = ezs_random_bool();
+    // 单次耗时只有几纳秒，一次start/end的开销就会淹没它，因此交给微基准测试运行器
+    // 运行器会自动预热、调整批量，并在结果足够稳定时停止
+    puts("正在对随机布尔值生成进行微基准测试...");
+    const ezs_benchmark_run_result result = ezs_benchmark_run("Random Bool", random_bool_op, nullptr, nullptr);
+    printf("每次生成随机布尔值约耗时 %.2f ns\n", result.mean_ns);
+
+    // 演示3：在热点循环中使用句柄，避免每次调用都按名称查找条目
+    puts("正在使用句柄对一千次短任务分别计时...");
+    const ezs_benchmark_id dice_id = ezs_benchmark_register("Dice Roll (by id)");
+    for (int i = 0; i < 1000; ++i) {
+        ezs_benchmark_start_id(dice_id);
+        ezs_do_not_optimize(ezs_random_int_inclusive(1, 6));
+        ezs_benchmark_end_id(dice_id);
+    }
+
+    // 演示4：嵌套的区域，报告中会额外打印调用树，给出每一层的总耗时与扣除子区域后的耗时
+    puts("正在对一个包含子步骤的任务计时...");
+    for (int i = 0; i < 100; ++i) {
+        ezs_benchmark_start("Roll Dice x100");
+        for (int j = 0; j < 100; ++j) {
+            ezs_benchmark_start("Single Roll");
+            ezs_do_not_optimize(ezs_random_int_inclusive(1, 6));
+            ezs_benchmark_end("Single Roll");
+        }
+        ezs_benchmark_end("Roll Dice x100");
     }
-    ezs_benchmark_end("1M Random Bools");
-    printf("最后生成的随机布尔值是: %s\n", temp ? "true" : "false");
     puts("Benchmark数据已记录。");
 }
 